@@ -0,0 +1,126 @@
+#include "PluginLoader.h"
+
+//==============================================================================
+PluginLoader::PluginLoader(juce::AudioPluginFormatManager& manager, PluginScanCache* cache)
+    : formatManager(manager),
+      scanCache(cache)
+{
+}
+
+juce::File PluginLoader::resolvePluginFile(const juce::String& path)
+{
+    auto cleanPath = path.trim();
+
+    // Remove quotes if they exist
+    if (cleanPath.startsWith("\"") && cleanPath.endsWith("\"") && cleanPath.length() > 1)
+        cleanPath = cleanPath.substring(1, cleanPath.length() - 1);
+
+   #if JUCE_WINDOWS
+    cleanPath = cleanPath.replace("/", "\\");
+   #endif
+
+    juce::File pluginFile(cleanPath);
+    if (pluginFile.exists())
+        return pluginFile;
+
+    // Fall back to the raw path, forward slashes, and the path with every quote removed
+    for (const auto& alternative : { path, path.replace("\\", "/"), path.replace("\"", "") })
+    {
+        juce::File alternativeFile(alternative);
+        if (alternativeFile.exists())
+        {
+            std::cout << "Using plugin path: " << alternativeFile.getFullPathName() << std::endl;
+            return alternativeFile;
+        }
+    }
+
+    return pluginFile;
+}
+
+//==============================================================================
+bool PluginLoader::findDescriptions(const juce::File& pluginFile, juce::OwnedArray<juce::PluginDescription>& descriptions,
+                                    bool& usedCache)
+{
+    descriptions.clear();
+    usedCache = scanCache != nullptr && scanCache->findTypesForFile(pluginFile, descriptions);
+
+    if (usedCache)
+    {
+        std::cout << "Using cached scan results (" << descriptions.size() << " plugins)" << std::endl;
+        return true;
+    }
+
+    std::cout << "Scanning plugin file for available plugins..." << std::endl;
+
+    for (auto* format : formatManager.getFormats())
+    {
+        descriptions.clear();
+
+        try
+        {
+            format->findAllTypesForFile(descriptions, pluginFile.getFullPathName());
+        }
+        catch (...)
+        {
+            // Continue with next format
+            continue;
+        }
+
+        if (descriptions.size() > 0)
+        {
+            std::cout << "  Found " << descriptions.size() << " plugins with " << format->getName() << std::endl;
+            for (int i = 0; i < descriptions.size(); ++i)
+            {
+                auto& desc = *descriptions[i];
+                std::cout << "    [" << i << "] " << desc.name << " (" << desc.manufacturerName << ")" << std::endl;
+                std::cout << "        Is Instrument: " << (desc.isInstrument ? "YES" : "NO") << std::endl;
+            }
+
+            if (scanCache != nullptr)
+                scanCache->store(pluginFile, descriptions);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+juce::PluginDescription* PluginLoader::selectDescription(const juce::OwnedArray<juce::PluginDescription>& descriptions,
+                                                         const juce::String& pluginName, bool preferInstrument)
+{
+    if (pluginName.isNotEmpty())
+    {
+        for (auto* desc : descriptions)
+        {
+            if (desc->name.containsIgnoreCase(pluginName))
+                return desc;
+        }
+
+        return nullptr;
+    }
+
+    if (preferInstrument)
+    {
+        for (auto* desc : descriptions)
+        {
+            if (desc->isInstrument)
+                return desc;
+        }
+    }
+
+    return descriptions.getFirst();
+}
+
+std::unique_ptr<juce::AudioPluginInstance> PluginLoader::createInstance(const juce::PluginDescription& description,
+                                                                        double sampleRate, int blockSize,
+                                                                        juce::String& errorMessage)
+{
+    return formatManager.createPluginInstance(description, sampleRate, blockSize, errorMessage);
+}
+
+void PluginLoader::saveScanCache()
+{
+    if (scanCache != nullptr)
+        scanCache->save();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "PluginScanCache.h"
+
+//==============================================================================
+/**
+ * Finds and instantiates plugins the same way in every tool: path cleanup,
+ * a scan that goes through the shared PluginScanCache when one is given, and
+ * description selection by name or instrument flag.
+ */
+class PluginLoader
+{
+public:
+    /** The format manager's formats have to be added before the first scan. */
+    PluginLoader(juce::AudioPluginFormatManager& formatManager, PluginScanCache* scanCache);
+
+    /**
+     * The plugin file a command-line or config path refers to. Surrounding
+     * quotes and whitespace are dropped and slash variants tried; returns the
+     * cleaned path (which may not exist) when nothing matches.
+     */
+    static juce::File resolvePluginFile(const juce::String& path);
+
+    /**
+     * The plugins in a file, from the scan cache while its entry is still
+     * valid. Fresh scan results are stored in the cache; usedCache reports
+     * which happened.
+     */
+    bool findDescriptions(const juce::File& pluginFile, juce::OwnedArray<juce::PluginDescription>& descriptions,
+                          bool& usedCache);
+
+    /**
+     * The description whose name contains pluginName, or without a name the
+     * first instrument (when preferInstrument) or the first description.
+     */
+    static juce::PluginDescription* selectDescription(const juce::OwnedArray<juce::PluginDescription>& descriptions,
+                                                      const juce::String& pluginName, bool preferInstrument);
+
+    std::unique_ptr<juce::AudioPluginInstance> createInstance(const juce::PluginDescription& description,
+                                                              double sampleRate, int blockSize,
+                                                              juce::String& errorMessage);
+
+    /** Write the scan cache back if it changed. */
+    void saveScanCache();
+
+private:
+    juce::AudioPluginFormatManager& formatManager;
+    PluginScanCache* scanCache = nullptr;
+};
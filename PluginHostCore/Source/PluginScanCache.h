@@ -0,0 +1,202 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include <map>
+
+//==============================================================================
+/**
+ * Persistent cache of plugin scan results.
+ * Descriptions live in a juce::KnownPluginList that is saved as XML next to a
+ * small index mapping each scanned plugin path to its modification time and
+ * size. While both still match, findAllTypesForFile() is skipped entirely.
+ */
+class PluginScanCache
+{
+public:
+    explicit PluginScanCache(const juce::File& file)
+        : cacheFile(file)
+    {
+        load();
+    }
+
+    static juce::File getDefaultCacheFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("VSTPluginHost")
+                   .getChildFile("plugin_scan_cache.xml");
+    }
+
+    /** Ignore cached entries for this run; fresh scan results replace them. */
+    void setForceRescan(bool shouldRescan)      { forceRescan = shouldRescan; }
+
+    /**
+     * Fill results with the cached descriptions for a plugin file.
+     * Returns false on a miss: unknown path, changed file, or a forced rescan.
+     */
+    bool findTypesForFile(const juce::File& pluginFile, juce::OwnedArray<juce::PluginDescription>& results)
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (forceRescan)
+            return false;
+
+        auto entry = entries.find(pluginFile.getFullPathName());
+        if (entry == entries.end() || !(entry->second.fingerprint == computeFingerprint(pluginFile)))
+            return false;
+
+        juce::OwnedArray<juce::PluginDescription> cached;
+        for (const auto& identifier : entry->second.identifiers)
+        {
+            auto description = knownPlugins.getTypeForIdentifierString(identifier);
+            if (!description)
+                return false;
+
+            cached.add(description.release());
+        }
+
+        if (cached.isEmpty())
+            return false;
+
+        results.swapWith(cached);
+        return true;
+    }
+
+    /** Record fresh scan results for a plugin file. */
+    void store(const juce::File& pluginFile, const juce::OwnedArray<juce::PluginDescription>& descriptions)
+    {
+        const juce::ScopedLock sl(lock);
+
+        Entry entry;
+        entry.fingerprint = computeFingerprint(pluginFile);
+
+        for (auto* description : descriptions)
+        {
+            knownPlugins.removeType(*description);
+            knownPlugins.addType(*description);
+            entry.identifiers.add(description->createIdentifierString());
+        }
+
+        entries[pluginFile.getFullPathName()] = entry;
+        dirty = true;
+    }
+
+    /** Write the cache back to disk if anything changed. */
+    bool save()
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (!dirty)
+            return true;
+
+        juce::XmlElement root("PLUGINSCANCACHE");
+        root.setAttribute("version", 1);
+
+        auto* filesElement = root.createNewChildElement("FILES");
+        for (const auto& [path, entry] : entries)
+        {
+            auto* fileElement = filesElement->createNewChildElement("FILE");
+            fileElement->setAttribute("path", path);
+            fileElement->setAttribute("modTime", juce::String(entry.fingerprint.modificationTime));
+            fileElement->setAttribute("size", juce::String(entry.fingerprint.size));
+            fileElement->setAttribute("types", entry.identifiers.joinIntoString("|"));
+        }
+
+        if (auto knownPluginsXml = knownPlugins.createXml())
+            root.addChildElement(knownPluginsXml.release());
+
+        cacheFile.getParentDirectory().createDirectory();
+
+        if (!root.writeTo(cacheFile))
+        {
+            std::cerr << "Could not write plugin scan cache: " << cacheFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        dirty = false;
+        return true;
+    }
+
+    const juce::File& getFile() const   { return cacheFile; }
+
+private:
+    struct Fingerprint
+    {
+        juce::int64 modificationTime = 0;
+        juce::int64 size = 0;
+
+        bool operator==(const Fingerprint& other) const
+        {
+            return modificationTime == other.modificationTime && size == other.size;
+        }
+    };
+
+    struct Entry
+    {
+        Fingerprint fingerprint;
+        juce::StringArray identifiers;
+    };
+
+    juce::File cacheFile;
+    juce::KnownPluginList knownPlugins;
+    std::map<juce::String, Entry> entries;
+    juce::CriticalSection lock;
+    bool forceRescan = false;
+    bool dirty = false;
+
+    // VST3 plugins are often bundle directories - use the newest file and the
+    // total size of everything inside the bundle
+    static Fingerprint computeFingerprint(const juce::File& pluginFile)
+    {
+        Fingerprint fingerprint;
+
+        if (pluginFile.isDirectory())
+        {
+            for (const auto& child : pluginFile.findChildFiles(juce::File::findFiles, true))
+            {
+                fingerprint.modificationTime = juce::jmax(fingerprint.modificationTime, child.getLastModificationTime().toMilliseconds());
+                fingerprint.size += child.getSize();
+            }
+        }
+        else
+        {
+            fingerprint.modificationTime = pluginFile.getLastModificationTime().toMilliseconds();
+            fingerprint.size = pluginFile.getSize();
+        }
+
+        return fingerprint;
+    }
+
+    void load()
+    {
+        if (!cacheFile.existsAsFile())
+            return;
+
+        auto root = juce::XmlDocument::parse(cacheFile);
+        if (!root || !root->hasTagName("PLUGINSCANCACHE"))
+        {
+            std::cerr << "Ignoring unreadable plugin scan cache: " << cacheFile.getFullPathName() << std::endl;
+            return;
+        }
+
+        if (auto* knownPluginsXml = root->getChildByName("KNOWNPLUGINS"))
+            knownPlugins.recreateFromXml(*knownPluginsXml);
+
+        if (auto* filesElement = root->getChildByName("FILES"))
+        {
+            for (auto* fileElement : filesElement->getChildWithTagNameIterator("FILE"))
+            {
+                Entry entry;
+                entry.fingerprint.modificationTime = fileElement->getStringAttribute("modTime").getLargeIntValue();
+                entry.fingerprint.size = fileElement->getStringAttribute("size").getLargeIntValue();
+                entry.identifiers.addTokens(fileElement->getStringAttribute("types"), "|", "");
+                entry.identifiers.removeEmptyStrings();
+
+                entries[fileElement->getStringAttribute("path")] = entry;
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(PluginScanCache)
+};
@@ -0,0 +1,345 @@
+#include "PluginStateIO.h"
+
+//==============================================================================
+bool PluginStateIO::loadPreset(juce::AudioPluginInstance& plugin, const juce::String& presetPath, int& strategyUsed,
+                               bool verbose, bool debug)
+{
+    strategyUsed = 0;
+
+    if (verbose)
+        std::cout << "\n=== COMPREHENSIVE PRESET LOADING ===" << std::endl;
+
+    std::cout << "Loading preset: " << presetPath << std::endl;
+
+    juce::File presetFile(presetPath);
+    if (!presetFile.existsAsFile())
+    {
+        std::cout << "Preset file does not exist!" << std::endl;
+        return false;
+    }
+
+    juce::MemoryBlock presetData;
+    if (!presetFile.loadFileAsData(presetData))
+    {
+        std::cout << "Could not load preset file data!" << std::endl;
+        return false;
+    }
+
+    if (verbose)
+        std::cout << "Preset file size: " << presetData.getSize() << " bytes" << std::endl;
+
+    // Keep the current state to compare against afterwards (diagnostics only)
+    juce::MemoryBlock currentState;
+    if (verbose)
+    {
+        plugin.getStateInformation(currentState);
+        std::cout << "Current plugin state size: " << currentState.getSize() << " bytes" << std::endl;
+    }
+
+    // Try multiple loading strategies
+    bool success = false;
+
+    // Strategy 1: Direct setStateInformation (for .vstpreset and raw state)
+    if (!success)
+    {
+        if (verbose)
+            std::cout << "\nStrategy 1: Direct state loading..." << std::endl;
+        try
+        {
+            plugin.setStateInformation(presetData.getData(), static_cast<int>(presetData.getSize()));
+            if (verbose)
+                std::cout << "Direct state loading successful!" << std::endl;
+            success = true;
+            strategyUsed = 1;
+        }
+        catch (...)
+        {
+            if (verbose)
+                std::cout << "Direct state loading failed" << std::endl;
+        }
+    }
+
+    // Strategy 2: Try as XML (some presets are XML-based)
+    if (!success)
+    {
+        if (verbose)
+            std::cout << "\nStrategy 2: XML parsing..." << std::endl;
+        juce::String presetText = presetData.toString();
+        if (presetText.startsWith("<?xml") || presetText.contains("<preset"))
+        {
+            if (verbose)
+                std::cout << "Detected XML format" << std::endl;
+            auto xmlDoc = juce::XmlDocument::parse(presetText);
+            if (xmlDoc != nullptr)
+            {
+                if (verbose)
+                    std::cout << "XML parsed successfully" << std::endl;
+                // Try to extract state data from XML
+                auto stateElement = xmlDoc->getChildByName("state");
+                if (stateElement != nullptr)
+                {
+                    juce::String stateData = stateElement->getAllSubText();
+                    if (stateData.isNotEmpty())
+                    {
+                        juce::MemoryBlock stateBlock;
+                        if (stateBlock.fromBase64Encoding(stateData))
+                        {
+                            try
+                            {
+                                plugin.setStateInformation(stateBlock.getData(), static_cast<int>(stateBlock.getSize()));
+                                if (verbose)
+                                    std::cout << "XML state loading successful!" << std::endl;
+                                success = true;
+                                strategyUsed = 2;
+                            }
+                            catch (...)
+                            {
+                                if (verbose)
+                                    std::cout << "XML state loading failed" << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            if (verbose)
+                std::cout << "Not XML format" << std::endl;
+        }
+    }
+
+    // Strategy 3: Skip FXP parsing for now - it's clearly not working
+    // Focus on what JUCE supports natively
+
+    // Strategy 4: Try loading via JUCE's AudioProcessor methods
+    if (!success)
+    {
+        if (verbose)
+            std::cout << "\nStrategy 4: JUCE AudioProcessor methods..." << std::endl;
+
+        // Some plugins support setCurrentProgram even without visible programs
+        if (plugin.getNumPrograms() > 0 && debug)
+        {
+            std::cout << "Plugin has " << plugin.getNumPrograms() << " programs" << std::endl;
+            for (int i = 0; i < plugin.getNumPrograms(); ++i)
+            {
+                std::cout << "  Program " << i << ": " << plugin.getProgramName(i) << std::endl;
+            }
+        }
+
+        // Try to set state via MemoryInputStream
+        juce::MemoryInputStream memStream(presetData, false);
+        try
+        {
+            plugin.setStateInformation(presetData.getData(), static_cast<int>(presetData.getSize()));
+            success = true;
+            strategyUsed = 4;
+            if (verbose)
+                std::cout << "MemoryInputStream method successful!" << std::endl;
+        }
+        catch (...)
+        {
+            if (verbose)
+                std::cout << "MemoryInputStream method failed" << std::endl;
+        }
+    }
+
+    if (success)
+    {
+        std::cout << "\n*** PRESET LOADED SUCCESSFULLY ***" << std::endl;
+
+        // Verify state changed
+        if (verbose)
+        {
+            juce::MemoryBlock newState;
+            plugin.getStateInformation(newState);
+            std::cout << "New plugin state size: " << newState.getSize() << " bytes" << std::endl;
+
+            if (newState != currentState)
+                std::cout << "Plugin state has changed - preset likely loaded correctly" << std::endl;
+            else
+                std::cout << "WARNING: Plugin state appears unchanged" << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << "\n*** ALL PRESET LOADING STRATEGIES FAILED ***" << std::endl;
+        std::cout << "This may be a plugin-specific format not supported by JUCE" << std::endl;
+    }
+
+    if (verbose)
+        std::cout << "=====================================" << std::endl;
+
+    return success;
+}
+
+//==============================================================================
+bool PluginStateIO::saveState(juce::AudioPluginInstance& plugin, const juce::File& outputFile, bool writeDumps)
+{
+    std::cout << "\n=== SAVING PLUGIN STATE ===" << std::endl;
+
+    juce::MemoryBlock stateData;
+    plugin.getStateInformation(stateData);
+
+    std::cout << "Plugin state size: " << stateData.getSize() << " bytes" << std::endl;
+
+    if (stateData.getSize() == 0)
+    {
+        std::cout << "No state data available to save" << std::endl;
+        return false;
+    }
+
+    return writeState(stateData, outputFile, writeDumps, plugin.getName());
+}
+
+bool PluginStateIO::writeState(const juce::MemoryBlock& state, const juce::File& outputFile, bool writeDumps,
+                               const juce::String& pluginName, DumpNaming dumpNaming)
+{
+    outputFile.getParentDirectory().createDirectory();
+
+    if (!outputFile.replaceWithData(state.getData(), state.getSize()))
+    {
+        std::cout << "Failed to save state file: " << outputFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    std::cout << "State saved to: " << outputFile.getFullPathName() << std::endl;
+
+    if (!writeDumps)
+        return true;
+
+    auto dumpFile = [&](const juce::String& extension)
+    {
+        return dumpNaming == DumpNaming::replaceExtension ? outputFile.withFileExtension(extension)
+                                                          : juce::File(outputFile.getFullPathName() + extension);
+    };
+
+    // Also save as base64 and a hex dump for analysis
+    juce::File base64File = dumpFile(".base64");
+    base64File.replaceWithText(state.toBase64Encoding());
+    std::cout << "Base64 state saved to: " << base64File.getFullPathName() << std::endl;
+
+    juce::File hexFile = dumpFile(".hex");
+    hexFile.replaceWithText(createHexDump(state, pluginName));
+    std::cout << "Hex dump saved to: " << hexFile.getFullPathName() << std::endl;
+
+    return true;
+}
+
+juce::String PluginStateIO::createHexDump(const juce::MemoryBlock& data, const juce::String& pluginName)
+{
+    juce::String result;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data.getData());
+    size_t size = data.getSize();
+
+    result << "Plugin State Hex Dump (" << size << " bytes):\n";
+    if (pluginName.isNotEmpty())
+        result << "Plugin: " << pluginName << "\n";
+    result << "\n";
+    result << "Offset   00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F  ASCII\n";
+    result << "------   -----------------------------------------------  ----------------\n";
+
+    for (size_t i = 0; i < size; i += 16)
+    {
+        result << juce::String::formatted("%06X:  ", (unsigned int)i);
+
+        // Hex bytes
+        for (size_t j = 0; j < 16; ++j)
+        {
+            if (i + j < size)
+            {
+                result << juce::String::formatted("%02X ", bytes[i + j]);
+            }
+            else
+            {
+                result << "   ";
+            }
+        }
+
+        result << " ";
+
+        // ASCII representation
+        for (size_t j = 0; j < 16 && i + j < size; ++j)
+        {
+            uint8_t byte = bytes[i + j];
+            if (byte >= 32 && byte <= 126)
+            {
+                result << static_cast<char>(byte);
+            }
+            else
+            {
+                result << ".";
+            }
+        }
+
+        result << "\n";
+    }
+
+    // Add header analysis
+    if (size >= 4)
+    {
+        result << "\nHeader Analysis:\n";
+        result << "First 4 bytes: ";
+        for (int i = 0; i < 4; ++i)
+        {
+            result << juce::String::formatted("%02X ", bytes[i]);
+        }
+        result << " (";
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = static_cast<char>(bytes[i]);
+            result << (c >= 32 && c <= 126 ? c : '.');
+        }
+        result << ")\n";
+
+        // Check for common format signatures
+        if (bytes[0] == 'C' && bytes[1] == 'c' && bytes[2] == 'n' && bytes[3] == 'K')
+        {
+            result << "Detected: FXP/FXB format signature\n";
+        }
+        else if (bytes[0] == 0x00 && bytes[1] == 0x00 && bytes[2] == 0x00 && bytes[3] == 0x01)
+        {
+            result << "Detected: Possible VST3 preset format\n";
+        }
+        else if (bytes[0] == '<' || (bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF))
+        {
+            result << "Detected: XML/Text format\n";
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+void PluginStateIO::selectProgram(juce::AudioPluginInstance& plugin, int program, int blockSize)
+{
+    plugin.setCurrentProgram(program);
+
+    juce::AudioBuffer<float> buffer(juce::jmax(1, plugin.getTotalNumInputChannels(), plugin.getTotalNumOutputChannels()),
+                                    blockSize);
+    buffer.clear();
+    juce::MidiBuffer midi;
+    plugin.processBlock(buffer, midi);
+}
+
+std::vector<float> PluginStateIO::getParameterValues(juce::AudioPluginInstance& plugin)
+{
+    std::vector<float> values;
+    values.reserve(static_cast<size_t>(plugin.getParameters().size()));
+
+    for (auto* param : plugin.getParameters())
+        values.push_back(param->getValue());
+
+    return values;
+}
+
+juce::StringArray PluginStateIO::getParameterNames(juce::AudioPluginInstance& plugin)
+{
+    juce::StringArray names;
+
+    for (auto* param : plugin.getParameters())
+        names.add(param->getName(256));
+
+    return names;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <vector>
+
+//==============================================================================
+/**
+ * Reading and writing plugin states: preset loading with the fallback
+ * strategies, raw state files with optional .base64/.hex dumps, and the
+ * program stepping and parameter snapshots used by preset captures.
+ */
+class PluginStateIO
+{
+public:
+    /**
+     * Load a preset file into a plugin, trying the loading strategies in turn.
+     * strategyUsed reports the one that worked (1 raw state, 2 XML-wrapped
+     * base64, 4 state via stream). verbose and debug add diagnostics.
+     */
+    static bool loadPreset(juce::AudioPluginInstance& plugin, const juce::String& presetPath, int& strategyUsed,
+                           bool verbose = false, bool debug = false);
+
+    /** Write the plugin's current state to a file. */
+    static bool saveState(juce::AudioPluginInstance& plugin, const juce::File& outputFile, bool writeDumps);
+
+    /** How the .base64 and .hex dump names are built from the state file's name. */
+    enum class DumpNaming
+    {
+        appendExtension,    // Foo.bin -> Foo.bin.base64 (vstrender)
+        replaceExtension    // Foo.bin -> Foo.base64 (PluginPresetCapture)
+    };
+
+    /** Write a captured state; with writeDumps also a .base64 and a .hex dump named per dumpNaming. */
+    static bool writeState(const juce::MemoryBlock& state, const juce::File& outputFile, bool writeDumps,
+                           const juce::String& pluginName = {},
+                           DumpNaming dumpNaming = DumpNaming::appendExtension);
+
+    static juce::String createHexDump(const juce::MemoryBlock& data, const juce::String& pluginName = {});
+
+    /**
+     * Switch program and process one silent block, since some plugins only
+     * apply a program change on the audio thread.
+     */
+    static void selectProgram(juce::AudioPluginInstance& plugin, int program, int blockSize = 512);
+
+    /** Normalized values of every parameter, in parameter order. */
+    static std::vector<float> getParameterValues(juce::AudioPluginInstance& plugin);
+
+    /** Parameter names in parameter order. */
+    static juce::StringArray getParameterNames(juce::AudioPluginInstance& plugin);
+};
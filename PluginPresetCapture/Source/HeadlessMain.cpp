@@ -0,0 +1,206 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "PluginLoader.h"
+#include "PluginStateIO.h"
+#include "PresetArchive.h"
+#include "ProjectInfo.h"
+
+//==============================================================================
+// Headless capture: loads the plugin, captures and exits without creating a
+// window or running the GUI message loop, so it works on display-less nodes
+//==============================================================================
+
+static void showUsage()
+{
+    std::cout << "Plugin Preset Capture (headless)" << std::endl;
+    std::cout << "Usage: PluginPresetCaptureCli <plugin_path> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --name <text>      Plugin to use from a multi-plugin file (name contains text)" << std::endl;
+    std::cout << "  --preset <file>    Load a preset and capture it into the archive (repeatable)" << std::endl;
+    std::cout << "  --programs         Capture every program into the archive" << std::endl;
+    std::cout << "  --archive <file>   Archive file (default: <plugin>_presets.bin)" << std::endl;
+    std::cout << "  --out <file>       Write the plugin's state to a single file instead" << std::endl;
+    std::cout << "  --dumps            With --out, also write .base64 and .hex dumps" << std::endl;
+    std::cout << "  --rescan           Ignore cached scan results for this plugin" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Without --preset, --programs or --out the current state is written to" << std::endl;
+    std::cout << "<plugin>_<timestamp>.bin in the working directory." << std::endl;
+}
+
+static void capture(PresetArchive& archive, juce::AudioPluginInstance& plugin, const juce::String& name, int program)
+{
+    juce::MemoryBlock state;
+    plugin.getStateInformation(state);
+
+    auto result = archive.add(name, program, state, PluginStateIO::getParameterValues(plugin));
+
+    std::cout << "  [" << (result == PresetArchive::AddResult::added ? "added" :
+                           result == PresetArchive::AddResult::duplicate ? "duplicate" : "FAILED")
+              << "] " << name << " (" << state.getSize() << " bytes)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::String pluginPath, pluginName, outPath, archivePath;
+    juce::StringArray presetPaths;
+    bool capturePrograms = false;
+    bool writeDumps = false;
+    bool forceRescan = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg(argv[i]);
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--name" && hasValue)
+            pluginName = argv[++i];
+        else if (arg == "--preset" && hasValue)
+            presetPaths.add(argv[++i]);
+        else if (arg == "--programs")
+            capturePrograms = true;
+        else if (arg == "--archive" && hasValue)
+            archivePath = argv[++i];
+        else if (arg == "--out" && hasValue)
+            outPath = argv[++i];
+        else if (arg == "--dumps")
+            writeDumps = true;
+        else if (arg == "--rescan")
+            forceRescan = true;
+        else if (arg == "--help" || arg == "-h")
+        {
+            showUsage();
+            return 0;
+        }
+        else if (arg.startsWith("--"))
+            std::cerr << "Ignoring unknown option: " << arg << std::endl;
+        else if (pluginPath.isEmpty())
+            pluginPath = arg;
+    }
+
+    if (pluginPath.isEmpty())
+    {
+        showUsage();
+        return 1;
+    }
+
+    // Plugins need a message manager, but nothing here opens a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::cout << ProjectInfo::projectName << " " << ProjectInfo::versionString << " (headless)" << std::endl;
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    PluginScanCache scanCache(PluginScanCache::getDefaultCacheFile());
+    scanCache.setForceRescan(forceRescan);
+    PluginLoader loader(formatManager, &scanCache);
+
+    auto pluginFile = PluginLoader::resolvePluginFile(pluginPath);
+    if (!pluginFile.exists())
+    {
+        std::cerr << "Plugin file not found: " << pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+    bool usedScanCache = false;
+
+    if (!loader.findDescriptions(pluginFile, descriptions, usedScanCache))
+    {
+        std::cerr << "No valid plugin found in file: " << pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    loader.saveScanCache();
+
+    auto* description = PluginLoader::selectDescription(descriptions, pluginName, false);
+    if (description == nullptr)
+    {
+        std::cerr << "No plugin named '" << pluginName << "' in " << pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::String errorMessage;
+    auto plugin = loader.createInstance(*description, 44100.0, 512, errorMessage);
+    if (!plugin)
+    {
+        std::cerr << "Failed to create plugin: " << errorMessage << std::endl;
+        return 1;
+    }
+
+    plugin->prepareToPlay(44100.0, 512);
+    plugin->setPlayConfigDetails(description->isInstrument ? 0 : 2, 2, 44100.0, 512);
+
+    std::cout << "Loaded " << plugin->getName() << " (" << plugin->getParameters().size() << " parameters, "
+              << plugin->getNumPrograms() << " programs)" << std::endl;
+
+    auto safeName = plugin->getName().replace(" ", "_").retainCharacters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
+    bool ok = true;
+
+    if (presetPaths.isEmpty() && !capturePrograms)
+    {
+        if (outPath.isEmpty())
+        {
+            auto timestamp = juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
+            outPath = juce::File::getCurrentWorkingDirectory().getChildFile(safeName + "_" + timestamp + ".bin").getFullPathName();
+        }
+
+        ok = PluginStateIO::saveState(*plugin, juce::File::getCurrentWorkingDirectory().getChildFile(outPath), writeDumps);
+    }
+    else
+    {
+        auto archiveFile = archivePath.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(archivePath)
+                                                    : juce::File::getCurrentWorkingDirectory().getChildFile(safeName + "_presets.bin");
+
+        PresetArchive archive(archiveFile, PluginStateIO::getParameterNames(*plugin));
+        if (archive.getError().isNotEmpty())
+        {
+            std::cerr << "Cannot append to " << archiveFile.getFullPathName() << ": " << archive.getError() << std::endl;
+            plugin->releaseResources();
+            return 1;
+        }
+
+        for (const auto& presetPath : presetPaths)
+        {
+            auto presetFile = juce::File::getCurrentWorkingDirectory().getChildFile(presetPath);
+
+            int strategyUsed = 0;
+            if (!PluginStateIO::loadPreset(*plugin, presetFile.getFullPathName(), strategyUsed))
+            {
+                std::cerr << "Could not load preset: " << presetPath << std::endl;
+                ok = false;
+                continue;
+            }
+
+            capture(archive, *plugin, presetFile.getFileNameWithoutExtension(), -1);
+        }
+
+        if (capturePrograms)
+        {
+            std::cout << "Capturing " << plugin->getNumPrograms() << " programs" << std::endl;
+
+            for (int program = 0; program < plugin->getNumPrograms(); ++program)
+            {
+                PluginStateIO::selectProgram(*plugin, program);
+
+                auto programName = plugin->getProgramName(program);
+                if (programName.isEmpty())
+                    programName = "program_" + juce::String(program).paddedLeft('0', 3);
+
+                capture(archive, *plugin, programName, program);
+            }
+        }
+
+        ok = archive.flush() && ok;
+
+        std::cout << "Archive: " << archive.getFile().getFullPathName() << " (" << archive.getNumStates()
+                  << " unique states, " << archive.getNumDuplicates() << " duplicates skipped)" << std::endl;
+        std::cout << "Index:   " << archive.getIndexFile().getFullPathName() << std::endl;
+    }
+
+    plugin->releaseResources();
+    plugin.reset();
+
+    return ok ? 0 : 1;
+}
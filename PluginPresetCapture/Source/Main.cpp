@@ -1,6 +1,5 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
-#include <juce_gui_extra/juce_gui_extra.h>
 
 #include "MainComponent.h"
 #include "ProjectInfo.h"
@@ -161,6 +160,7 @@ private:
         std::cout << "  - Load presets using the plugin's interface" << std::endl;
         std::cout << "  - Adjust parameters as needed" << std::endl;
         std::cout << "  - Close the window to automatically save the state" << std::endl;
+        std::cout << "  - Capture every program, or each state change, into one archive" << std::endl;
 
         quit();
     }
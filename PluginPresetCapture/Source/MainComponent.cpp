@@ -4,7 +4,7 @@
 MainComponent::MainComponent(const juce::String& path)
     : pluginPath(path)
 {
-    // Initialize format manager
+    // Initialize format manager (before the loader's first scan)
     formatManager.addDefaultFormats();
 
     // Setup UI components
@@ -43,6 +43,25 @@ MainComponent::MainComponent(const juce::String& path)
         }
     };
 
+    addAndMakeVisible(captureProgramsButton);
+    captureProgramsButton.setButtonText("Capture All Programs");
+    captureProgramsButton.setEnabled(false);
+    captureProgramsButton.onClick = [this]()
+    {
+        if (plugin)
+        {
+            startProgramCapture();
+        }
+    };
+
+    addAndMakeVisible(watchButton);
+    watchButton.setButtonText("Watch for State Changes (capture each new state to the archive)");
+    watchButton.setEnabled(false);
+    watchButton.onClick = [this]()
+    {
+        setWatching(watchButton.getToggleState());
+    };
+
     addAndMakeVisible(exitButton);
     exitButton.setButtonText("Exit (Auto-Save State)");
     exitButton.onClick = [this]()
@@ -55,7 +74,7 @@ MainComponent::MainComponent(const juce::String& path)
     };
 
     // Set initial size
-    setSize(500, 300);
+    setSize(500, 420);
 
     // Load the plugin
     if (loadPlugin(pluginPath))
@@ -63,6 +82,8 @@ MainComponent::MainComponent(const juce::String& path)
         showStatus("Plugin loaded successfully! Click 'Open Plugin Editor' to begin.", juce::Colours::green);
         openEditorButton.setEnabled(true);
         saveStateButton.setEnabled(true);
+        captureProgramsButton.setEnabled(plugin->getNumPrograms() > 0);
+        watchButton.setEnabled(true);
     }
     else
     {
@@ -76,6 +97,8 @@ MainComponent::MainComponent(const juce::String& path)
 MainComponent::~MainComponent()
 {
     stopTimer();
+    setWatching(false);
+    archive.reset();
     editorWindow.reset();
     plugin.reset();
 }
@@ -107,6 +130,13 @@ void MainComponent::resized()
     buttonArea = area.removeFromTop(buttonHeight);
     saveStateButton.setBounds(buttonArea);
 
+    area.removeFromTop(10);
+    buttonArea = area.removeFromTop(buttonHeight);
+    captureProgramsButton.setBounds(buttonArea);
+
+    area.removeFromTop(10);
+    watchButton.setBounds(area.removeFromTop(24));
+
     area.removeFromTop(20);
     buttonArea = area.removeFromTop(buttonHeight);
     exitButton.setBounds(buttonArea);
@@ -115,6 +145,40 @@ void MainComponent::resized()
 //==============================================================================
 void MainComponent::timerCallback()
 {
+    if (batchProgram >= 0)
+    {
+        stepProgramCapture();
+        return;
+    }
+
+    // Capture once the state has settled for a tick, so dragging a control doesn't record every step
+    if (watchButton.getToggleState())
+    {
+        if (stateChanged.exchange(false))
+        {
+            watchPending = true;
+        }
+        else if (watchPending)
+        {
+            watchPending = false;
+
+            auto programName = plugin->getNumPrograms() > 0 ? plugin->getProgramName(plugin->getCurrentProgram()) : juce::String();
+            auto name = "watch_" + juce::String(++watchCaptures).paddedLeft('0', 3);
+            if (programName.isNotEmpty())
+                name << " " << programName;
+
+            captureToArchive(name, plugin->getNumPrograms() > 0 ? plugin->getCurrentProgram() : -1);
+            watchFlushPending = true;
+            lastWatchCapture = juce::Time::getMillisecondCounter();
+        }
+        else if (watchFlushPending && juce::Time::getMillisecondCounter() - lastWatchCapture >= watchFlushDelayMs)
+        {
+            // The index is rewritten whole, so it waits until the captures pause
+            watchFlushPending = false;
+            getArchive().flush();
+        }
+    }
+
     // Check if editor window was closed
     if (editorOpen && (!editorWindow || !editorWindow->isVisible()))
     {
@@ -130,115 +194,37 @@ bool MainComponent::loadPlugin(const juce::String& path)
 {
     showStatus("Loading plugin...", juce::Colours::blue);
 
-    // Clean and normalize the path
-    juce::String cleanPath = path.trim();
-
-    // Remove quotes if they exist
-    if (cleanPath.startsWith("\"") && cleanPath.endsWithIgnoreCase("\""))
-    {
-        cleanPath = cleanPath.substring(1, cleanPath.length() - 1);
-    }
-
-    // Convert forward slashes to backslashes on Windows for consistency
-    #if JUCE_WINDOWS
-    cleanPath = cleanPath.replace("/", "\\");
-    #endif
-
-    // Debug output
-    std::cout << "=== PLUGIN LOADING DEBUG ===" << std::endl;
-    std::cout << "Original path: [" << path << "]" << std::endl;
-    std::cout << "Cleaned path:  [" << cleanPath << "]" << std::endl;
-    std::cout << "Path length: " << cleanPath.length() << std::endl;
-
-    juce::File pluginFile(cleanPath);
+    auto pluginFile = PluginLoader::resolvePluginFile(path);
 
-    std::cout << "JUCE File object:" << std::endl;
-    std::cout << "  Full path: [" << pluginFile.getFullPathName() << "]" << std::endl;
-    std::cout << "  Exists: " << (pluginFile.exists() ? "YES" : "NO") << std::endl;
-    std::cout << "  Is directory: " << (pluginFile.isDirectory() ? "YES" : "NO") << std::endl;
-    std::cout << "  File size: " << pluginFile.getSize() << " bytes" << std::endl;
+    std::cout << "=== PLUGIN LOADING ===" << std::endl;
+    std::cout << "Requested path: [" << path << "]" << std::endl;
+    std::cout << "Resolved path:  [" << pluginFile.getFullPathName() << "]" << std::endl;
 
-    // Try alternative path constructions if the first one fails
     if (!pluginFile.exists())
     {
-        std::cout << "First attempt failed, trying alternatives..." << std::endl;
-
-        // Try with original path
-        juce::File altFile1(path);
-        std::cout << "Alt 1 - Original: [" << path << "] exists: " << (altFile1.exists() ? "YES" : "NO") << std::endl;
-
-        // Try with forward slashes
-        juce::String forwardPath = path.replace("\\", "/");
-        juce::File altFile2(forwardPath);
-        std::cout << "Alt 2 - Forward slashes: [" << forwardPath << "] exists: " << (altFile2.exists() ? "YES" : "NO") << std::endl;
-
-        // Try without quotes (in case they're part of the string)
-        juce::String unquotedPath = path.replace("\"", "");
-        juce::File altFile3(unquotedPath);
-        std::cout << "Alt 3 - Unquoted: [" << unquotedPath << "] exists: " << (altFile3.exists() ? "YES" : "NO") << std::endl;
-
-        // Use the first alternative that works
-        if (altFile1.exists())
-        {
-            pluginFile = altFile1;
-            std::cout << "Using Alt 1 (original path)" << std::endl;
-        }
-        else if (altFile2.exists())
-        {
-            pluginFile = altFile2;
-            std::cout << "Using Alt 2 (forward slashes)" << std::endl;
-        }
-        else if (altFile3.exists())
-        {
-            pluginFile = altFile3;
-            std::cout << "Using Alt 3 (unquoted)" << std::endl;
-        }
-        else
-        {
-            std::cout << "All alternatives failed!" << std::endl;
-            showStatus("Plugin file not found at any attempted path", juce::Colours::red);
-            std::cout << "============================" << std::endl;
-            return false;
-        }
+        showStatus("Plugin file not found: " + pluginFile.getFullPathName(), juce::Colours::red);
+        std::cout << "======================" << std::endl;
+        return false;
     }
 
-    std::cout << "Final file to load: [" << pluginFile.getFullPathName() << "]" << std::endl;
-    std::cout << "============================" << std::endl;
-
-    // Find plugin descriptions
+    // Same scan cache as the render host, so a plugin scanned by either tool loads instantly in both
     juce::OwnedArray<juce::PluginDescription> descriptions;
-    bool found = false;
-
-    for (auto* format : formatManager.getFormats())
-    {
-        descriptions.clear();
-
-        try
-        {
-            format->findAllTypesForFile(descriptions, pluginFile.getFullPathName());
-            if (descriptions.size() > 0)
-            {
-                found = true;
-                break;
-            }
-        }
-        catch (...)
-        {
-            continue;
-        }
-    }
+    bool usedScanCache = false;
 
-    if (!found || descriptions.size() == 0)
+    if (!loader.findDescriptions(pluginFile, descriptions, usedScanCache))
     {
         showStatus("No valid plugin found in file", juce::Colours::red);
         return false;
     }
 
+    loader.saveScanCache();
+    std::cout << "======================" << std::endl;
+
     // Use first available plugin
     auto* desc = descriptions[0];
 
     juce::String errorMessage;
-    plugin = formatManager.createPluginInstance(*desc, 44100.0, 512, errorMessage);
+    plugin = loader.createInstance(*desc, 44100.0, 512, errorMessage);
 
     if (!plugin)
     {
@@ -277,7 +263,7 @@ void MainComponent::savePluginState()
     plugin->getStateInformation(currentState);
 
     // Generate filename based on plugin name and timestamp
-    auto pluginName = plugin->getName().replace(" ", "_").retainCharacters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
+    auto pluginName = getSafePluginName();
     auto timestamp = juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
     auto filename = pluginName + "_" + timestamp;
 
@@ -302,20 +288,12 @@ void MainComponent::savePluginState()
 
     for (auto& file : saveLocations)
     {
-        if (file.replaceWithData(currentState.getData(), currentState.getSize()))
+        // Each location also gets .hex and .base64 dumps for analysis and easy transfer
+        if (PluginStateIO::writeState(currentState, file, true, plugin->getName(),
+                                      PluginStateIO::DumpNaming::replaceExtension))
         {
             savedCount++;
             savedPaths += "  " + file.getFullPathName() + "\n";
-
-            // Also save hex dump for analysis
-            auto hexDump = createHexDump(currentState);
-            auto hexFile = file.withFileExtension(".hex");
-            hexFile.replaceWithText(hexDump);
-
-            // Save base64 for easy transfer
-            auto base64 = currentState.toBase64Encoding();
-            auto base64File = file.withFileExtension(".base64");
-            base64File.replaceWithText(base64);
         }
     }
 
@@ -347,57 +325,134 @@ void MainComponent::savePluginState()
     }
 }
 
-juce::String MainComponent::createHexDump(const juce::MemoryBlock& data)
+juce::String MainComponent::getSafePluginName() const
+{
+    return plugin->getName().replace(" ", "_").retainCharacters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
+}
+
+//==============================================================================
+PresetArchive& MainComponent::getArchive()
 {
-    juce::String result;
-    const uint8_t* bytes = static_cast<const uint8_t*>(data.getData());
-    size_t size = data.getSize();
+    if (!archive)
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(getSafePluginName() + "_presets.bin");
+        archive = std::make_unique<PresetArchive>(file, PluginStateIO::getParameterNames(*plugin));
+    }
 
-    result << "Plugin State Hex Dump\n";
-    result << "Plugin: " << (plugin ? plugin->getName() : "Unknown") << "\n";
-    result << "Size: " << size << " bytes\n";
-    result << "Timestamp: " << juce::Time::getCurrentTime().toString(true, true) << "\n\n";
+    return *archive;
+}
 
-    result << "Offset   00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F  ASCII\n";
-    result << "------   -----------------------------------------------  ----------------\n";
+void MainComponent::startProgramCapture()
+{
+    auto numPrograms = plugin->getNumPrograms();
+    if (numPrograms <= 0 || batchProgram >= 0)
+        return;
 
-    for (size_t i = 0; i < size; i += 16)
+    if (getArchive().getError().isNotEmpty())
     {
-        result << juce::String::formatted("%06X:  ", (unsigned int)i);
+        showStatus("Cannot append to " + archive->getFile().getFileName() + ": " + archive->getError(), juce::Colours::red);
+        return;
+    }
 
-        // Hex bytes
-        for (size_t j = 0; j < 16; ++j)
-        {
-            if (i + j < size)
-            {
-                result << juce::String::formatted("%02X ", bytes[i + j]);
-            }
-            else
-            {
-                result << "   ";
-            }
-        }
+    std::cout << "\n=== CAPTURING " << numPrograms << " PROGRAMS ===" << std::endl;
+
+    plugin->getStateInformation(stateBeforeBatch);
+
+    captureProgramsButton.setEnabled(false);
+    saveStateButton.setEnabled(false);
+
+    batchProgram = 0;
+    PluginStateIO::selectProgram(*plugin, batchProgram);
 
-        result << " ";
+    // One program per tick keeps the UI responsive and gives the plugin a moment to apply it
+    startTimer(20);
+}
 
-        // ASCII representation
-        for (size_t j = 0; j < 16 && i + j < size; ++j)
+void MainComponent::stepProgramCapture()
+{
+    auto programName = plugin->getProgramName(batchProgram);
+    if (programName.isEmpty())
+        programName = "program_" + juce::String(batchProgram).paddedLeft('0', 3);
+
+    captureToArchive(programName, batchProgram);
+
+    if (++batchProgram >= plugin->getNumPrograms())
+    {
+        finishProgramCapture();
+        return;
+    }
+
+    showStatus("Capturing program " + juce::String(batchProgram + 1) + " of " + juce::String(plugin->getNumPrograms()) + "...",
+               juce::Colours::blue);
+    PluginStateIO::selectProgram(*plugin, batchProgram);
+}
+
+void MainComponent::finishProgramCapture()
+{
+    batchProgram = -1;
+
+    // Put back whatever the user had loaded before the batch
+    plugin->setStateInformation(stateBeforeBatch.getData(), static_cast<int>(stateBeforeBatch.getSize()));
+    stateChanged = false;
+    watchPending = false;
+
+    getArchive().flush();
+
+    captureProgramsButton.setEnabled(true);
+    saveStateButton.setEnabled(true);
+    startTimer(500);
+
+    showStatus("Archive holds " + juce::String(archive->getNumStates()) + " unique state(s), "
+                   + juce::String(archive->getNumDuplicates()) + " duplicate(s) skipped: " + archive->getFile().getFileName(),
+               juce::Colours::green);
+    std::cout << "Index: " << archive->getIndexFile().getFullPathName() << std::endl;
+    std::cout << "==========================" << std::endl;
+}
+
+void MainComponent::captureToArchive(const juce::String& name, int program)
+{
+    juce::MemoryBlock state;
+    plugin->getStateInformation(state);
+
+    auto result = getArchive().add(name, program, state, PluginStateIO::getParameterValues(*plugin));
+
+    std::cout << "  [" << (result == PresetArchive::AddResult::added ? "added" :
+                           result == PresetArchive::AddResult::duplicate ? "duplicate" : "FAILED")
+              << "] " << name << " (" << state.getSize() << " bytes)" << std::endl;
+
+    if (result == PresetArchive::AddResult::added && batchProgram < 0)
+        showStatus("Captured '" + name + "' (" + juce::String(archive->getNumStates()) + " states in archive)", juce::Colours::green);
+}
+
+void MainComponent::setWatching(bool shouldWatch)
+{
+    if (!plugin)
+        return;
+
+    stateChanged = false;
+    watchPending = false;
+
+    if (shouldWatch)
+    {
+        if (getArchive().getError().isNotEmpty())
         {
-            uint8_t byte = bytes[i + j];
-            if (byte >= 32 && byte <= 126)
-            {
-                result << static_cast<char>(byte);
-            }
-            else
-            {
-                result << ".";
-            }
+            watchButton.setToggleState(false, juce::dontSendNotification);
+            showStatus("Cannot append to " + archive->getFile().getFileName() + ": " + archive->getError(), juce::Colours::red);
+            return;
         }
 
-        result << "\n";
+        plugin->addListener(this);
+        showStatus("Watching for state changes. Each new state is appended to " + archive->getFile().getFileName(),
+                   juce::Colours::blue);
     }
+    else
+    {
+        plugin->removeListener(this);
+        watchFlushPending = false;
 
-    return result;
+        if (archive)
+            archive->flush();
+    }
 }
 
 void MainComponent::showStatus(const juce::String& message, juce::Colour colour)
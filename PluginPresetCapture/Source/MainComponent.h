@@ -2,13 +2,18 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
-#include <juce_gui_extra/juce_gui_extra.h>
 
 #include "PluginEditorWindow.h"
+#include "PluginLoader.h"
+#include "PluginStateIO.h"
+#include "PresetArchive.h"
+
+#include <atomic>
 
 //==============================================================================
 class MainComponent : public juce::Component,
-                     private juce::Timer
+                     private juce::Timer,
+                     private juce::AudioProcessorListener
 {
 public:
     MainComponent(const juce::String& pluginPath);
@@ -23,11 +28,24 @@ private:
     void timerCallback() override;
     bool loadPlugin(const juce::String& pluginPath);
     void savePluginState();
-    juce::String createHexDump(const juce::MemoryBlock& data);
+    juce::String getSafePluginName() const;
+
+    // Batch capture into the preset archive
+    PresetArchive& getArchive();
+    void startProgramCapture();
+    void stepProgramCapture();
+    void finishProgramCapture();
+    void captureToArchive(const juce::String& name, int program);
+    void setWatching(bool shouldWatch);
+
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override      { stateChanged = true; }
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override     { stateChanged = true; }
     void showStatus(const juce::String& message, juce::Colour colour = juce::Colours::black);
 
     //==============================================================================
     juce::AudioPluginFormatManager formatManager;
+    PluginScanCache scanCache { PluginScanCache::getDefaultCacheFile() };
+    PluginLoader loader { formatManager, &scanCache };
     std::unique_ptr<juce::AudioPluginInstance> plugin;
     std::unique_ptr<PluginEditorWindow> editorWindow;
     
@@ -36,6 +54,8 @@ private:
     juce::Label statusLabel;
     juce::TextButton openEditorButton;
     juce::TextButton saveStateButton;
+    juce::TextButton captureProgramsButton;
+    juce::ToggleButton watchButton;
     juce::TextButton exitButton;
     
     // Status tracking
@@ -43,6 +63,19 @@ private:
     bool pluginLoaded = false;
     bool editorOpen = false;
     juce::MemoryBlock initialState;
+
+    // Batch capture state
+    std::unique_ptr<PresetArchive> archive;
+    int batchProgram = -1;
+    juce::MemoryBlock stateBeforeBatch;
+    std::atomic<bool> stateChanged { false };
+    bool watchPending = false;
+    int watchCaptures = 0;
+
+    // Watch mode flushes the archive index once captures have paused this long, and when it stops
+    static constexpr juce::uint32 watchFlushDelayMs = 5000;
+    bool watchFlushPending = false;
+    juce::uint32 lastWatchCapture = 0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "PresetArchive.h"
+
+//==============================================================================
+PresetArchive::PresetArchive(const juce::File& archiveFile, const juce::StringArray& names)
+    : file(archiveFile),
+      parameterNames(names)
+{
+    file.getParentDirectory().createDirectory();
+    scanExisting();
+}
+
+PresetArchive::~PresetArchive()
+{
+    flush();
+}
+
+juce::String PresetArchive::hashState(const juce::MemoryBlock& state)
+{
+    return juce::SHA256(state).toHexString();
+}
+
+//==============================================================================
+PresetArchive::AddResult PresetArchive::add(const juce::String& name, int program, const juce::MemoryBlock& state,
+                                            const std::vector<float>& parameterValues)
+{
+    if (state.getSize() == 0 || error.isNotEmpty())
+        return AddResult::failed;
+
+    juce::SHA256 sha(state);
+    auto hash = sha.toHexString();
+
+    auto existing = entryByHash.find(hash);
+    if (existing != entryByHash.end())
+    {
+        auto& entry = entries[existing->second];
+        if (name != entry.name)
+            entry.aliases.addIfNotAlreadyThere(name);
+
+        ++numDuplicates;
+        indexDirty = true;
+        return AddResult::duplicate;
+    }
+
+    if (!output)
+    {
+        // The stream stays open for the session; appends are buffered until flush()
+        output = std::make_unique<juce::FileOutputStream>(file);
+        if (!output->openedOk())
+        {
+            std::cerr << "Could not open preset archive: " << file.getFullPathName() << std::endl;
+            output.reset();
+            return AddResult::failed;
+        }
+
+        endOfFile = output->getPosition();
+    }
+
+    auto nameUtf8 = name.toStdString();
+    auto hashBytes = sha.getRawData();
+
+    juce::MemoryOutputStream record;
+    record.writeInt(static_cast<int>(recordMagic));
+    record.write(hashBytes.getData(), hashBytes.getSize());
+    record.writeInt(program);
+    record.writeInt(static_cast<int>(nameUtf8.size()));
+    record.write(nameUtf8.data(), nameUtf8.size());
+    record.writeInt(static_cast<int>(parameterValues.size()));
+
+    for (auto value : parameterValues)
+        record.writeFloat(value);
+
+    record.writeInt64(static_cast<juce::int64>(state.getSize()));
+
+    Entry entry;
+    entry.name = name;
+    entry.program = program;
+    entry.hash = hash;
+    entry.offset = endOfFile + static_cast<juce::int64>(record.getDataSize());
+    entry.size = static_cast<juce::int64>(state.getSize());
+
+    record << state;
+
+    if (!output->write(record.getData(), record.getDataSize()))
+    {
+        std::cerr << "Could not append to preset archive: " << file.getFullPathName() << std::endl;
+        return AddResult::failed;
+    }
+
+    endOfFile += static_cast<juce::int64>(record.getDataSize());
+    entryByHash[hash] = entries.size();
+    entries.push_back(entry);
+    indexDirty = true;
+    return AddResult::added;
+}
+
+bool PresetArchive::flush()
+{
+    if (output)
+        output->flush();
+
+    if (error.isNotEmpty())
+        return false;
+
+    if (!indexDirty)
+        return true;
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("archive", file.getFileName());
+    root->setProperty("states", static_cast<int>(entries.size()));
+    root->setProperty("duplicates", numDuplicates);
+
+    juce::Array<juce::var> names;
+    for (const auto& parameterName : parameterNames)
+        names.add(parameterName);
+    root->setProperty("parameters", names);
+
+    juce::Array<juce::var> entryList;
+    for (const auto& entry : entries)
+    {
+        auto* entryObject = new juce::DynamicObject();
+        entryObject->setProperty("name", entry.name);
+        entryObject->setProperty("program", entry.program);
+        entryObject->setProperty("sha256", entry.hash);
+        entryObject->setProperty("offset", entry.offset);
+        entryObject->setProperty("size", entry.size);
+
+        if (!entry.aliases.isEmpty())
+        {
+            juce::Array<juce::var> aliases;
+            for (const auto& alias : entry.aliases)
+                aliases.add(alias);
+            entryObject->setProperty("aliases", aliases);
+        }
+
+        entryList.add(juce::var(entryObject));
+    }
+    root->setProperty("entries", entryList);
+
+    if (!getIndexFile().replaceWithText(juce::JSON::toString(juce::var(root))))
+    {
+        std::cerr << "Could not write preset archive index: " << getIndexFile().getFullPathName() << std::endl;
+        return false;
+    }
+
+    indexDirty = false;
+    return true;
+}
+
+//==============================================================================
+void PresetArchive::scanExisting()
+{
+    if (!file.existsAsFile())
+        return;
+
+    {
+        juce::MemoryMappedFile mapping(file, juce::MemoryMappedFile::readOnly);
+        if (mapping.getData() == nullptr)
+            return;
+
+        scanRecords(juce::MemoryInputStream(mapping.getData(), mapping.getSize(), false));
+    }
+
+    loadIndex();
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << "Preset archive " << file.getFullPathName() << ": " << error << std::endl;
+        return;
+    }
+
+    // The mapping has to be closed before the file can shrink
+    if (endOfFile < file.getSize())
+    {
+        std::cout << "Preset archive has a damaged tail after " << endOfFile << " bytes; it will be overwritten" << std::endl;
+        file.truncate(endOfFile);
+    }
+
+    std::cout << "Preset archive: " << entries.size() << " existing state(s) in " << file.getFullPathName() << std::endl;
+}
+
+void PresetArchive::scanRecords(juce::MemoryInputStream&& in)
+{
+    // A truncated or damaged record ends the scan; appends then continue after the last good one
+    while (!in.isExhausted())
+    {
+        if (static_cast<juce::uint32>(in.readInt()) != recordMagic || in.getNumBytesRemaining() < 32)
+            break;
+
+        juce::MemoryBlock hashBytes;
+        in.readIntoMemoryBlock(hashBytes, 32);
+
+        Entry entry;
+        entry.hash = juce::String::toHexString(hashBytes.getData(), static_cast<int>(hashBytes.getSize()), 0);
+        entry.program = in.readInt();
+
+        auto nameLength = in.readInt();
+        if (nameLength < 0 || nameLength > in.getNumBytesRemaining())
+            break;
+
+        juce::MemoryBlock nameBytes;
+        in.readIntoMemoryBlock(nameBytes, nameLength);
+        entry.name = juce::String::fromUTF8(static_cast<const char*>(nameBytes.getData()), nameLength);
+
+        auto numValues = in.readInt();
+        if (numValues < 0 || static_cast<juce::int64>(numValues) * 4 > in.getNumBytesRemaining())
+            break;
+
+        if (numValues != parameterNames.size() && error.isEmpty())
+            error = "its states have " + juce::String(numValues) + " parameters, the plugin has "
+                    + juce::String(parameterNames.size());
+
+        in.skipNextBytes(static_cast<juce::int64>(numValues) * 4);
+
+        entry.size = in.readInt64();
+        entry.offset = in.getPosition();
+
+        if (entry.size <= 0 || entry.size > in.getNumBytesRemaining())
+            break;
+
+        in.skipNextBytes(entry.size);
+
+        entryByHash[entry.hash] = entries.size();
+        entries.push_back(entry);
+        endOfFile = in.getPosition();
+    }
+}
+
+// The binary records carry no aliases or duplicate count; those live only in the index
+void PresetArchive::loadIndex()
+{
+    auto index = juce::JSON::parse(getIndexFile());
+    if (!index.isObject())
+        return;
+
+    if (auto* names = index["parameters"].getArray(); names != nullptr && error.isEmpty())
+    {
+        juce::StringArray indexedNames;
+        for (const auto& name : *names)
+            indexedNames.add(name.toString());
+
+        if (indexedNames != parameterNames)
+            error = "its parameter layout differs from the plugin's";
+    }
+
+    numDuplicates = index.getProperty("duplicates", 0);
+
+    if (auto* entryList = index["entries"].getArray())
+    {
+        for (const auto& indexed : *entryList)
+        {
+            auto existing = entryByHash.find(indexed["sha256"].toString());
+            if (existing == entryByHash.end())
+                continue;
+
+            if (auto* aliases = indexed["aliases"].getArray())
+            {
+                for (const auto& alias : *aliases)
+                    entries[existing->second].aliases.addIfNotAlreadyThere(alias.toString());
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_cryptography/juce_cryptography.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * Many captured plugin states in one append-only container file, so a batch
+ * capture session costs one buffered append per preset instead of a set of
+ * files each. Records are laid out as:
+ *
+ *   uint32 magic, 32-byte SHA-256 of the state, int32 program,
+ *   uint32 name length, name, int32 parameter count, float values...,
+ *   int64 state size, state
+ *
+ * States are deduplicated by hash: a preset that produces a state already in
+ * the archive is only recorded as an alias in the JSON index written next to
+ * the container (<archive>.json). Reopening an archive scans its records and
+ * takes the aliases and duplicate count back from the index, so later
+ * sessions keep appending and deduplicating against earlier ones. An archive
+ * whose parameter layout differs from the plugin's is not appended to: it
+ * holds another plugin's states.
+ */
+class PresetArchive
+{
+public:
+    PresetArchive(const juce::File& archiveFile, const juce::StringArray& parameterNames);
+    ~PresetArchive();
+
+    enum class AddResult
+    {
+        added,
+        duplicate,
+        failed
+    };
+
+    /** Append a state with its parameter snapshot unless an identical state is already stored. */
+    AddResult add(const juce::String& name, int program, const juce::MemoryBlock& state,
+                  const std::vector<float>& parameterValues);
+
+    /** Flush pending appends and rewrite the JSON index. */
+    bool flush();
+
+    /** Why the archive can't be appended to, or empty when it can. */
+    const juce::String& getError() const    { return error; }
+
+    const juce::File& getFile() const       { return file; }
+    juce::File getIndexFile() const         { return file.withFileExtension(file.getFileExtension() + ".json"); }
+    int getNumStates() const                { return static_cast<int>(entries.size()); }
+    int getNumDuplicates() const            { return numDuplicates; }
+
+    static juce::String hashState(const juce::MemoryBlock& state);
+
+private:
+    static constexpr juce::uint32 recordMagic = 0x31545350;    // "PST1"
+
+    struct Entry
+    {
+        juce::String name;
+        int program = -1;
+        juce::String hash;
+        juce::int64 offset = 0;
+        juce::int64 size = 0;
+        juce::StringArray aliases;
+    };
+
+    void scanExisting();
+    void scanRecords(juce::MemoryInputStream&& in);
+    void loadIndex();
+
+    juce::File file;
+    juce::StringArray parameterNames;
+    std::unique_ptr<juce::FileOutputStream> output;
+    std::vector<Entry> entries;
+    std::map<juce::String, size_t> entryByHash;
+    juce::int64 endOfFile = 0;
+    int numDuplicates = 0;
+    bool indexDirty = false;
+    juce::String error;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetArchive)
+};
@@ -20,6 +20,10 @@ if exist "PluginPresetCapture.exe" (
     del PluginPresetCapture.exe
 )
 
+if exist "PluginPresetCaptureCli.exe" (
+    del PluginPresetCaptureCli.exe
+)
+
 echo Step 2: Verifying JUCE link...
 if not exist "JUCE\CMakeLists.txt" (
     echo JUCE not found! Creating link...
@@ -56,4 +60,5 @@ if %ERRORLEVEL% NEQ 0 (
 echo.
 echo Build completed successfully!
 echo Executable: PluginPresetCapture.exe
+echo Headless:   PluginPresetCaptureCli.exe
 pause
\ No newline at end of file
@@ -0,0 +1,556 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * Features of a render computed block by block as it is written, so dataset
+ * indexes don't need a second pass over the files:
+ *
+ *  - per-channel sample peak and RMS
+ *  - integrated and maximum momentary loudness (ITU-R BS.1770-4: K-weighting,
+ *    400 ms blocks with 75% overlap, absolute and relative gates)
+ *  - spectral centroid and rolloff from an STFT of the channel mix
+ *  - onsets, as peaks of the spectral flux
+ *
+ * Only running sums and one value per 100 ms or per STFT hop are kept, so
+ * memory stays small for long renders.
+ */
+class AudioAnalyzer
+{
+public:
+    /** fftSize <= 0 measures levels and loudness only, without the spectrum. */
+    void prepare(double sampleRateToUse, int numChannelsToUse, int fftSize)
+    {
+        sampleRate = sampleRateToUse;
+        numChannels = numChannelsToUse;
+        samplesAnalysed = 0;
+
+        channelPeaks.assign(static_cast<size_t>(numChannels), 0.0f);
+        channelSumSquares.assign(static_cast<size_t>(numChannels), 0.0);
+
+        // Loudness
+        prepareKWeighting();
+        channelWeights.assign(static_cast<size_t>(numChannels), 1.0);
+        if (numChannels == 6)
+        {
+            channelWeights[3] = 0.0;                        // LFE
+            channelWeights[4] = channelWeights[5] = 1.41;   // surrounds
+        }
+
+        segmentLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+        segmentPosition = 0;
+        segmentEnergy = 0.0;
+        segmentEnergies.clear();
+        blockEnergies.clear();
+
+        // STFT
+        centroid = {};
+        rolloff = {};
+        fluxHistory.clear();
+        fluxFrameOffset = 0;
+        onsetTimes.clear();
+        lastOnsetFrame = -1;
+        scratch.setSize(numChannels, 0);
+
+        if (fftSize <= 0)
+        {
+            fft.reset();
+            return;
+        }
+
+        auto order = juce::jlimit(8, 15, static_cast<int>(std::round(std::log2(juce::jmax(256, fftSize)))));
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        frameSize = fft->getSize();
+        hopSize = frameSize / 2;
+
+        window.resize(static_cast<size_t>(frameSize));
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(frameSize),
+                                                                 juce::dsp::WindowingFunction<float>::hann, false);
+
+        frame.assign(static_cast<size_t>(frameSize), 0.0f);
+        framePosition = 0;
+        framesCompleted = 0;
+        fftData.assign(static_cast<size_t>(frameSize) * 2, 0.0f);
+        previousMagnitudes.assign(static_cast<size_t>(frameSize / 2 + 1), 0.0f);
+    }
+
+    /** Analyse the first prepared channels of the buffer. */
+    void process(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* samples = buffer.getReadPointer(ch);
+            auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+
+            auto& peak = channelPeaks[static_cast<size_t>(ch)];
+            peak = juce::jmax(peak, std::abs(range.getStart()), std::abs(range.getEnd()));
+            channelSumSquares[static_cast<size_t>(ch)] += sumOfSquares(samples, numSamples);
+        }
+
+        processLoudness(buffer, numSamples);
+
+        if (fft)
+            processSpectrum(buffer, numSamples);
+        samplesAnalysed += numSamples;
+    }
+
+    /** Highest sample peak over every channel so far. */
+    float getPeak() const
+    {
+        float peak = 0.0f;
+        for (auto channelPeak : channelPeaks)
+            peak = juce::jmax(peak, channelPeak);
+        return peak;
+    }
+
+    /** Gated integrated loudness so far, or void when everything is below the absolute gate. */
+    juce::var getIntegratedLufs() const     { return getIntegratedLoudness(); }
+
+    juce::var toVar() const
+    {
+        juce::var result(new juce::DynamicObject());
+        auto* object = result.getDynamicObject();
+
+        object->setProperty("sample_rate", sampleRate);
+        object->setProperty("samples", samplesAnalysed);
+        object->setProperty("duration_seconds", sampleRate > 0.0 ? samplesAnalysed / sampleRate : 0.0);
+
+        juce::Array<juce::var> channels;
+        float overallPeak = 0.0f;
+
+        for (size_t ch = 0; ch < channelPeaks.size(); ++ch)
+        {
+            auto rms = samplesAnalysed > 0 ? static_cast<float>(std::sqrt(channelSumSquares[ch] / samplesAnalysed)) : 0.0f;
+            overallPeak = juce::jmax(overallPeak, channelPeaks[ch]);
+
+            juce::var channel(new juce::DynamicObject());
+            channel.getDynamicObject()->setProperty("peak", channelPeaks[ch]);
+            channel.getDynamicObject()->setProperty("peak_db", juce::Decibels::gainToDecibels(channelPeaks[ch]));
+            channel.getDynamicObject()->setProperty("rms", rms);
+            channel.getDynamicObject()->setProperty("rms_db", juce::Decibels::gainToDecibels(rms));
+            channels.add(channel);
+        }
+
+        object->setProperty("peak_db", juce::Decibels::gainToDecibels(overallPeak));
+        object->setProperty("channels", channels);
+
+        juce::var loudness(new juce::DynamicObject());
+        loudness.getDynamicObject()->setProperty("integrated_lufs", getIntegratedLoudness());
+        loudness.getDynamicObject()->setProperty("max_momentary_lufs", getMaxMomentaryLoudness());
+        object->setProperty("loudness", loudness);
+
+        juce::var spectrum(new juce::DynamicObject());
+        spectrum.getDynamicObject()->setProperty("fft_size", frameSize);
+        spectrum.getDynamicObject()->setProperty("hop_size", hopSize);
+        spectrum.getDynamicObject()->setProperty("frames", framesCompleted);
+        spectrum.getDynamicObject()->setProperty("centroid_hz", centroid.toVar());
+        spectrum.getDynamicObject()->setProperty("rolloff_hz", rolloff.toVar());
+        spectrum.getDynamicObject()->setProperty("rolloff_fraction", rolloffFraction);
+        object->setProperty("spectrum", spectrum);
+
+        juce::Array<juce::var> onsets;
+        for (auto time : onsetTimes)
+            onsets.add(time);
+
+        juce::var onsetObject(new juce::DynamicObject());
+        onsetObject.getDynamicObject()->setProperty("count", onsets.size());
+        onsetObject.getDynamicObject()->setProperty("times", onsets);
+        object->setProperty("onsets", onsetObject);
+
+        return result;
+    }
+
+    int getFftSize() const  { return frameSize; }
+
+    /**
+     * Rescales the levels of a toVar() report to an output written with this
+     * gain: peaks and RMS are multiplied, dB and LUFS values move by the gain
+     * in dB. The spectrum and onsets don't depend on the level.
+     */
+    static void applyGain(juce::var& analysis, float gain)
+    {
+        if (!analysis.isObject() || gain == 1.0f)
+            return;
+
+        auto gainDb = static_cast<double>(juce::Decibels::gainToDecibels(gain));
+        float overallPeak = 0.0f;
+
+        if (auto* channels = analysis["channels"].getArray())
+        {
+            for (auto& channel : *channels)
+            {
+                auto peak = static_cast<float>(channel["peak"]) * gain;
+                auto rms = static_cast<float>(channel["rms"]) * gain;
+                overallPeak = juce::jmax(overallPeak, peak);
+
+                channel.getDynamicObject()->setProperty("peak", peak);
+                channel.getDynamicObject()->setProperty("peak_db", juce::Decibels::gainToDecibels(peak));
+                channel.getDynamicObject()->setProperty("rms", rms);
+                channel.getDynamicObject()->setProperty("rms_db", juce::Decibels::gainToDecibels(rms));
+            }
+        }
+
+        analysis.getDynamicObject()->setProperty("peak_db", juce::Decibels::gainToDecibels(overallPeak));
+
+        if (auto* loudness = analysis["loudness"].getDynamicObject())
+        {
+            for (auto* name : { "integrated_lufs", "max_momentary_lufs" })
+            {
+                if (!loudness->getProperty(name).isVoid())
+                    loudness->setProperty(name, static_cast<double>(loudness->getProperty(name)) + gainDb);
+            }
+        }
+    }
+
+    static juce::File getAnalysisFileFor(const juce::File& outputFile)
+    {
+        return outputFile.getSiblingFile(outputFile.getFileNameWithoutExtension() + ".analysis.json");
+    }
+
+    static bool writeToFile(const juce::var& analysis, const juce::File& file, const juce::String& outputFile)
+    {
+        auto document = analysis.clone();
+        document.getDynamicObject()->setProperty("output_file", outputFile);
+
+        if (!file.replaceWithText(juce::JSON::toString(document)))
+        {
+            std::cerr << "Could not write analysis: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static constexpr float rolloffFraction = 0.85f;
+    static constexpr double absoluteGateLufs = -70.0;
+
+    struct Summary
+    {
+        int count = 0;
+        double sum = 0.0, sumSquares = 0.0;
+        double minimum = std::numeric_limits<double>::max(), maximum = 0.0;
+
+        void add(double value)
+        {
+            count++;
+            sum += value;
+            sumSquares += value * value;
+            minimum = juce::jmin(minimum, value);
+            maximum = juce::jmax(maximum, value);
+        }
+
+        juce::var toVar() const
+        {
+            juce::var result(new juce::DynamicObject());
+            auto mean = count > 0 ? sum / count : 0.0;
+
+            result.getDynamicObject()->setProperty("mean", mean);
+            result.getDynamicObject()->setProperty("std", count > 0 ? std::sqrt(juce::jmax(0.0, sumSquares / count - mean * mean)) : 0.0);
+            result.getDynamicObject()->setProperty("min", count > 0 ? minimum : 0.0);
+            result.getDynamicObject()->setProperty("max", maximum);
+            return result;
+        }
+    };
+
+    // Four independent sums so the compiler can vectorise the loop without reassociating
+    static double sumOfSquares(const float* samples, int numSamples)
+    {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            sum0 += samples[i] * samples[i];
+            sum1 += samples[i + 1] * samples[i + 1];
+            sum2 += samples[i + 2] * samples[i + 2];
+            sum3 += samples[i + 3] * samples[i + 3];
+        }
+
+        for (; i < numSamples; ++i)
+            sum0 += samples[i] * samples[i];
+
+        return static_cast<double>(sum0 + sum1) + static_cast<double>(sum2 + sum3);
+    }
+
+    //==============================================================================
+    // BS.1770 K-weighting: a high shelf then a high pass, designed for the sample rate
+    void prepareKWeighting()
+    {
+        const double pi = juce::MathConstants<double>::pi;
+
+        auto shelfK = std::tan(pi * 1681.974450955533 / sampleRate);
+        auto shelfQ = 0.7071752369554196;
+        auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        auto vb = std::pow(vh, 0.4996667741545416);
+        auto shelfA0 = 1.0 + shelfK / shelfQ + shelfK * shelfK;
+
+        juce::IIRCoefficients shelf((vh + vb * shelfK / shelfQ + shelfK * shelfK) / shelfA0,
+                                    2.0 * (shelfK * shelfK - vh) / shelfA0,
+                                    (vh - vb * shelfK / shelfQ + shelfK * shelfK) / shelfA0,
+                                    1.0,
+                                    2.0 * (shelfK * shelfK - 1.0) / shelfA0,
+                                    (1.0 - shelfK / shelfQ + shelfK * shelfK) / shelfA0);
+
+        auto passK = std::tan(pi * 38.13547087602444 / sampleRate);
+        auto passQ = 0.5003270373238773;
+        auto passA0 = 1.0 + passK / passQ + passK * passK;
+
+        juce::IIRCoefficients highPass(1.0, -2.0, 1.0, 1.0,
+                                       2.0 * (passK * passK - 1.0) / passA0,
+                                       (1.0 - passK / passQ + passK * passK) / passA0);
+
+        shelfFilters.clear();
+        highPassFilters.clear();
+        shelfFilters.reserve(static_cast<size_t>(numChannels));
+        highPassFilters.reserve(static_cast<size_t>(numChannels));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            shelfFilters.emplace_back().setCoefficients(shelf);
+            highPassFilters.emplace_back().setCoefficients(highPass);
+        }
+    }
+
+    void processLoudness(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        scratch.setSize(numChannels, numSamples, false, false, true);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            scratch.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+            shelfFilters[static_cast<size_t>(ch)].processSamples(scratch.getWritePointer(ch), numSamples);
+            highPassFilters[static_cast<size_t>(ch)].processSamples(scratch.getWritePointer(ch), numSamples);
+        }
+
+        // Weighted energy over 100 ms segments; four of them make a 400 ms gating block
+        for (int start = 0; start < numSamples;)
+        {
+            auto length = juce::jmin(numSamples - start, segmentLength - segmentPosition);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                if (channelWeights[static_cast<size_t>(ch)] > 0.0)
+                    segmentEnergy += channelWeights[static_cast<size_t>(ch)] * sumOfSquares(scratch.getReadPointer(ch, start), length);
+            }
+
+            start += length;
+            segmentPosition += length;
+
+            if (segmentPosition == segmentLength)
+            {
+                segmentEnergies.push_back(segmentEnergy / segmentLength);
+                segmentEnergy = 0.0;
+                segmentPosition = 0;
+
+                auto numSegments = segmentEnergies.size();
+                if (numSegments >= 4)
+                {
+                    blockEnergies.push_back((segmentEnergies[numSegments - 1] + segmentEnergies[numSegments - 2]
+                                             + segmentEnergies[numSegments - 3] + segmentEnergies[numSegments - 4]) / 4.0);
+                }
+            }
+        }
+    }
+
+    static double energyToLufs(double energy)
+    {
+        return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -std::numeric_limits<double>::infinity();
+    }
+
+    // Null when every block is below the absolute gate, e.g. a silent render
+    juce::var getIntegratedLoudness() const
+    {
+        double sum = 0.0;
+        int count = 0;
+
+        for (auto energy : blockEnergies)
+        {
+            if (energyToLufs(energy) > absoluteGateLufs)
+            {
+                sum += energy;
+                count++;
+            }
+        }
+
+        if (count == 0)
+            return {};
+
+        auto relativeGate = energyToLufs(sum / count) - 10.0;
+        sum = 0.0;
+        count = 0;
+
+        for (auto energy : blockEnergies)
+        {
+            auto lufs = energyToLufs(energy);
+            if (lufs > absoluteGateLufs && lufs > relativeGate)
+            {
+                sum += energy;
+                count++;
+            }
+        }
+
+        return count > 0 ? juce::var(energyToLufs(sum / count)) : juce::var();
+    }
+
+    juce::var getMaxMomentaryLoudness() const
+    {
+        if (blockEnergies.empty())
+            return {};
+
+        auto maximum = *std::max_element(blockEnergies.begin(), blockEnergies.end());
+        return maximum > 0.0 ? juce::var(energyToLufs(maximum)) : juce::var();
+    }
+
+    //==============================================================================
+    void processSpectrum(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        auto gain = 1.0f / static_cast<float>(numChannels);
+
+        for (int start = 0; start < numSamples;)
+        {
+            auto length = juce::jmin(numSamples - start, frameSize - framePosition);
+            auto* destination = frame.data() + framePosition;
+
+            juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, start), gain, length);
+            for (int ch = 1; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(ch, start), gain, length);
+
+            start += length;
+            framePosition += length;
+
+            if (framePosition == frameSize)
+            {
+                analyseFrame();
+
+                // Keep the second half as the start of the next frame
+                std::copy(frame.begin() + hopSize, frame.end(), frame.begin());
+                framePosition = frameSize - hopSize;
+            }
+        }
+    }
+
+    void analyseFrame()
+    {
+        juce::FloatVectorOperations::multiply(fftData.data(), frame.data(), window.data(), frameSize);
+        std::fill(fftData.begin() + frameSize, fftData.end(), 0.0f);
+        fft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        auto numBins = frameSize / 2 + 1;
+        auto binWidth = sampleRate / frameSize;
+        double magnitudeSum = 0.0, weightedSum = 0.0, energy = 0.0, flux = 0.0;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            auto magnitude = static_cast<double>(fftData[static_cast<size_t>(bin)]);
+            magnitudeSum += magnitude;
+            weightedSum += magnitude * bin * binWidth;
+            energy += magnitude * magnitude;
+
+            auto& previous = previousMagnitudes[static_cast<size_t>(bin)];
+            flux += juce::jmax(0.0, magnitude - static_cast<double>(previous));
+            previous = static_cast<float>(magnitude);
+        }
+
+        // Silent frames have no meaningful centroid or rolloff
+        if (energy > 1.0e-10)
+        {
+            centroid.add(weightedSum / magnitudeSum);
+
+            double cumulative = 0.0;
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                auto magnitude = static_cast<double>(fftData[static_cast<size_t>(bin)]);
+                cumulative += magnitude * magnitude;
+
+                if (cumulative >= rolloffFraction * energy)
+                {
+                    rolloff.add(bin * binWidth);
+                    break;
+                }
+            }
+        }
+
+        detectOnset(flux);
+        framesCompleted++;
+    }
+
+    // A flux value that is a local maximum and well above the recent average
+    // marks an onset at the centre of its frame; onsets are at least 50 ms apart
+    void detectOnset(double flux)
+    {
+        fluxHistory.push_back(flux);
+        auto count = static_cast<int>(fluxHistory.size());
+
+        if (count < 3)
+            return;
+
+        auto candidate = fluxHistory[static_cast<size_t>(count - 2)];
+        if (candidate <= fluxHistory[static_cast<size_t>(count - 3)] || candidate < flux)
+            return;
+
+        auto windowStart = juce::jmax(0, count - 2 - fluxWindow);
+        double average = 0.0;
+        for (int i = windowStart; i < count - 2; ++i)
+            average += fluxHistory[static_cast<size_t>(i)];
+        average /= juce::jmax(1, count - 2 - windowStart);
+
+        auto frameIndex = fluxFrameOffset + count - 2;
+        auto minimumGap = static_cast<int>(std::ceil(0.05 * sampleRate / hopSize));
+
+        if (candidate > average * 1.5 + 1.0e-3 && (lastOnsetFrame < 0 || frameIndex - lastOnsetFrame >= minimumGap))
+        {
+            onsetTimes.push_back((static_cast<double>(frameIndex) * hopSize + frameSize / 2) / sampleRate);
+            lastOnsetFrame = frameIndex;
+        }
+
+        // Only the averaging window is needed from here on
+        if (count > 4 * fluxWindow)
+        {
+            fluxHistory.erase(fluxHistory.begin(), fluxHistory.begin() + (count - fluxWindow - 2));
+            fluxFrameOffset += count - fluxWindow - 2;
+        }
+    }
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    juce::int64 samplesAnalysed = 0;
+
+    std::vector<float> channelPeaks;
+    std::vector<double> channelSumSquares;
+
+    std::vector<juce::IIRFilter> shelfFilters, highPassFilters;
+    std::vector<double> channelWeights;
+    juce::AudioBuffer<float> scratch;
+    int segmentLength = 0;
+    int segmentPosition = 0;
+    double segmentEnergy = 0.0;
+    std::vector<double> segmentEnergies;    // mean weighted square per 100 ms
+    std::vector<double> blockEnergies;      // per 400 ms gating block, every 100 ms
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int frameSize = 0;
+    int hopSize = 0;
+    std::vector<float> window, frame, fftData, previousMagnitudes;
+    int framePosition = 0;
+    int framesCompleted = 0;
+    Summary centroid, rolloff;
+
+    static constexpr int fluxWindow = 16;
+    std::vector<double> fluxHistory;
+    int fluxFrameOffset = 0;
+    int lastOnsetFrame = -1;
+    std::vector<double> onsetTimes;
+};
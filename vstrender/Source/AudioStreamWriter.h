@@ -0,0 +1,465 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "AudioAnalysis.h"
+#include "OutputProcessing.h"
+
+//==============================================================================
+/**
+ * Streams rendered blocks to an audio file on a background thread.
+ * Blocks are pushed into a FIFO as they come out of the plugin chain, so
+ * memory use depends on the FIFO size rather than the render length.
+ *
+ * Gain, dither and the conversion to the file's sample format all happen on
+ * the writer thread as blocks leave the FIFO, so the chain never waits for
+ * them. Dithered blocks are handed to the format writer as integer codes. Normalising needs the level of the whole output first: the writer
+ * thread measures the blocks (AudioAnalyzer, levels and loudness only) while
+ * spooling them as raw floats next to the output, then writes the file from
+ * the spool once the render is finished. That single spool replaces writing
+ * the file and then reading and rewriting it to normalise.
+ *
+ * A failed write to the file or the spool (a full disk, say), or a spool that
+ * reads back short, stops the writing; close() then returns false and the
+ * incomplete file is deleted.
+ */
+class AudioStreamWriter : private juce::TimeSliceClient
+{
+public:
+    AudioStreamWriter() : writerThread("Audio File Writer") {}
+
+    ~AudioStreamWriter() override
+    {
+        close();
+    }
+
+    /**
+     * Create the output file and start the writer thread.
+     * Unsupported bit depths fall back to 24 bits, as before, or to the
+     * deepest depth the file format supports.
+     */
+    bool open(const juce::File& file, double sampleRate, int numChannels, int bitDepth, int fifoSamples,
+              const OutputProcessing& processingToUse = {})
+    {
+        close();
+
+        outputFile = file;
+        writtenSampleRate = sampleRate;
+        writtenChannels = numChannels;
+        samplesWritten = 0;
+        samplesSpooled = 0;
+        writeFailed = false;
+        processing = processingToUse;
+
+        if (outputFile.exists())
+        {
+            outputFile.deleteFile();
+        }
+
+        outputFile.getParentDirectory().createDirectory();
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        auto* format = formatManager.findFormatForFileExtension(outputFile.getFileExtension());
+        if (!format)
+        {
+            std::cerr << "Unsupported output format: " << outputFile.getFileExtension() << std::endl;
+            return false;
+        }
+
+        std::unique_ptr<juce::FileOutputStream> fileStream(outputFile.createOutputStream());
+        if (!fileStream)
+        {
+            std::cerr << "Could not create output file: " << outputFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        writtenBitDepth = bitDepth;
+        if (writtenBitDepth != 16 && writtenBitDepth != 24 && writtenBitDepth != 32)
+        {
+            writtenBitDepth = 24;
+        }
+
+        // FLAC stops at 24 bits, for example: use the deepest the format offers
+        auto possibleDepths = format->getPossibleBitDepths();
+        if (!possibleDepths.isEmpty() && !possibleDepths.contains(writtenBitDepth))
+        {
+            auto fallbackDepth = possibleDepths.getLast();
+            std::cout << format->getFormatName() << " does not support " << writtenBitDepth
+                      << "-bit output - writing " << fallbackDepth << " bits" << std::endl;
+            writtenBitDepth = fallbackDepth;
+        }
+
+        writer.reset(format->createWriterFor(fileStream.get(),
+                                             sampleRate,
+                                             static_cast<unsigned int>(numChannels),
+                                             writtenBitDepth,
+                                             {},
+                                             0));
+        if (!writer)
+        {
+            std::cerr << "Could not create audio writer" << std::endl;
+            return false;
+        }
+
+        fileStream.release();
+
+        postProcessor.prepare(processing.dither, numChannels, writtenBitDepth);
+        postProcessor.setGain(juce::Decibels::decibelsToGain(processing.gainDb));
+
+        if (processing.needsWholeOutput() && !openSpool())
+        {
+            writer.reset();
+            return false;
+        }
+
+        fifo.setTotalSize(juce::jmax(2, fifoSamples));
+        fifo.reset();
+        fifoBuffer.setSize(numChannels, fifo.getTotalSize());
+        block.setSize(numChannels, blockSize);
+
+        // Zero-terminated, as AudioFormatWriter::write() expects
+        intBlock.assign(static_cast<size_t>(numChannels), std::vector<int>(static_cast<size_t>(blockSize)));
+        intChannels.assign(static_cast<size_t>(numChannels) + 1, nullptr);
+        for (size_t ch = 0; ch < intBlock.size(); ++ch)
+            intChannels[ch] = intBlock[ch].data();
+
+        finishRequested = false;
+        finished.reset();
+        opened = true;
+
+        writerThread.addTimeSliceClient(this);
+        writerThread.startThread();
+        return true;
+    }
+
+    /**
+     * Queue numSamples from each channel. Waits for the writer thread when the
+     * FIFO is full instead of dropping audio.
+     */
+    bool write(const float* const* channelData, int numSamples)
+    {
+        if (!opened || numSamples <= 0)
+            return opened;
+
+        // A chunk bigger than the FIFO goes in pieces
+        for (int done = 0; done < numSamples;)
+        {
+            auto chunk = juce::jmin(numSamples - done, fifo.getTotalSize() - 1);
+
+            while (fifo.getFreeSpace() < chunk)
+            {
+                writerThread.notify();
+                juce::Thread::sleep(1);
+            }
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(chunk, start1, size1, start2, size2);
+
+            for (int ch = 0; ch < writtenChannels; ++ch)
+            {
+                fifoBuffer.copyFrom(ch, start1, channelData[ch] + done, size1);
+                if (size2 > 0)
+                    fifoBuffer.copyFrom(ch, start2, channelData[ch] + done + size1, size2);
+            }
+
+            fifo.finishedWrite(size1 + size2);
+            done += chunk;
+        }
+
+        writerThread.notify();
+        samplesWritten += numSamples;
+        return true;
+    }
+
+    bool write(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        return write(buffer.getArrayOfReadPointers(), numSamples);
+    }
+
+    /**
+     * Ask the writer thread to finalise the file once the FIFO is empty,
+     * without waiting. Several outputs can finish side by side this way.
+     */
+    void finish()
+    {
+        if (opened && !finishRequested.exchange(true))
+            writerThread.notify();
+    }
+
+    /**
+     * Flush everything still queued, finalise the file header and stop the thread.
+     * Returns false when a write failed; the output file is then removed.
+     */
+    bool close()
+    {
+        if (opened)
+        {
+            finish();
+            finished.wait(-1);
+            writerThread.removeTimeSliceClient(this);
+            opened = false;
+        }
+
+        if (writerThread.isThreadRunning())
+        {
+            writerThread.stopThread(5000);
+        }
+
+        return !writeFailed;
+    }
+
+    bool isOpen() const                     { return opened; }
+    const juce::File& getFile() const       { return outputFile; }
+    juce::int64 getSamplesWritten() const   { return samplesWritten; }
+    double getSampleRate() const            { return writtenSampleRate; }
+    int getNumChannels() const              { return writtenChannels; }
+    int getBitDepth() const                 { return writtenBitDepth; }
+
+    /** Gain applied to every sample: normalisation and gain_db together. Valid after close(). */
+    float getAppliedGain() const            { return postProcessor.getGain(); }
+
+private:
+    static constexpr int blockSize = 4096;
+
+    //==============================================================================
+    // Writer thread
+
+    int useTimeSlice() override
+    {
+        if (finished.wait(0))
+            return 50;
+
+        // Read before the FIFO: everything queued before finish() is then visible below
+        auto finishing = finishRequested.load();
+
+        if (auto ready = fifo.getNumReady(); ready > 0)
+        {
+            drainFifo(juce::jmin(ready, blockSize));
+            return 0;
+        }
+
+        if (finishing)
+        {
+            finalise();
+            finished.signal();
+            return 50;
+        }
+
+        return 1;
+    }
+
+    void drainFifo(int numSamples)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < writtenChannels; ++ch)
+        {
+            block.copyFrom(ch, 0, fifoBuffer, ch, start1, size1);
+            if (size2 > 0)
+                block.copyFrom(ch, size1, fifoBuffer, ch, start2, size2);
+        }
+
+        fifo.finishedRead(size1 + size2);
+
+        // Keep draining after a failure, so the render never waits on a full FIFO
+        if (writeFailed)
+            return;
+
+        if (spoolStream)
+        {
+            analyzer.process(block, size1 + size2);
+            writeToSpool(size1 + size2);
+        }
+        else
+            writeBlock(size1 + size2);
+    }
+
+    void writeBlock(int numSamples)
+    {
+        // Dithered codes go to the writer as ints, so its float conversion can't move them
+        if (postProcessor.isDithering())
+        {
+            postProcessor.processToInts(block, numSamples, intChannels.data());
+
+            if (!writer->write(const_cast<const int**>(intChannels.data()), numSamples))
+                fail("Could not write audio file: " + outputFile.getFullPathName());
+
+            return;
+        }
+
+        postProcessor.process(block, 0, numSamples);
+
+        if (!writer->writeFromAudioSampleBuffer(block, 0, numSamples))
+            fail("Could not write audio file: " + outputFile.getFullPathName());
+    }
+
+    void finalise()
+    {
+        if (spoolStream)
+        {
+            spoolStream->flush();
+            if (spoolStream->getStatus().failed())
+                fail("Could not write spool file: " + spoolStream->getStatus().getErrorMessage());
+
+            spoolStream.reset();
+
+            if (!writeFailed)
+            {
+                postProcessor.setGain(getNormalisationGain() * juce::Decibels::decibelsToGain(processing.gainDb));
+                writeFromSpool();
+            }
+
+            spool.reset();
+        }
+
+        // Deleting the writer writes the final header and closes the file
+        writer.reset();
+
+        if (writeFailed)
+            outputFile.deleteFile();
+    }
+
+    // Reported once; the rest of the output is dropped
+    void fail(const juce::String& message)
+    {
+        if (!writeFailed.exchange(true))
+            std::cerr << message << std::endl;
+    }
+
+    //==============================================================================
+    // Normalisation
+
+    bool openSpool()
+    {
+        spool = std::make_unique<juce::TemporaryFile>(outputFile.withFileExtension(".spool"));
+        spoolStream = spool->getFile().createOutputStream();
+
+        if (!spoolStream)
+        {
+            std::cerr << "Could not create spool file: " << spool->getFile().getFullPathName() << std::endl;
+            spool.reset();
+            return false;
+        }
+
+        analyzer.prepare(writtenSampleRate, writtenChannels, 0);
+        return true;
+    }
+
+    // Planar chunks: sample count, then each channel's floats
+    void writeToSpool(int numSamples)
+    {
+        bool ok = spoolStream->writeInt(numSamples);
+
+        for (int ch = 0; ch < writtenChannels && ok; ++ch)
+            ok = spoolStream->write(block.getReadPointer(ch), static_cast<size_t>(numSamples) * sizeof(float));
+
+        if (!ok)
+        {
+            fail("Could not write spool file: " + spool->getFile().getFullPathName());
+            return;
+        }
+
+        samplesSpooled += numSamples;
+    }
+
+    // Every spooled sample must come back, or the file would be silently short
+    void writeFromSpool()
+    {
+        juce::FileInputStream in(spool->getFile());
+        if (!in.openedOk())
+        {
+            fail("Could not read spool file: " + spool->getFile().getFullPathName());
+            return;
+        }
+
+        juce::int64 samplesRead = 0;
+
+        while (samplesRead < samplesSpooled && !writeFailed)
+        {
+            auto numSamples = in.readInt();
+            if (numSamples <= 0 || numSamples > block.getNumSamples())
+                break;
+
+            auto bytes = static_cast<int>(static_cast<size_t>(numSamples) * sizeof(float));
+            bool complete = true;
+
+            for (int ch = 0; ch < writtenChannels; ++ch)
+                complete = in.read(block.getWritePointer(ch), bytes) == bytes && complete;
+
+            if (!complete)
+                break;
+
+            writeBlock(numSamples);
+            samplesRead += numSamples;
+        }
+
+        if (samplesRead != samplesSpooled)
+            fail("Spool file " + spool->getFile().getFullPathName() + " read back " + juce::String(samplesRead)
+                 + " of " + juce::String(samplesSpooled) + " samples");
+    }
+
+    float getNormalisationGain() const
+    {
+        auto peak = analyzer.getPeak();
+        if (peak <= 0.0f)
+            return 1.0f;
+
+        if (processing.normalize == OutputProcessing::Normalize::peak)
+            return juce::Decibels::decibelsToGain(processing.normalizeTarget) / peak;
+
+        auto lufs = analyzer.getIntegratedLufs();
+        if (lufs.isVoid())
+        {
+            std::cout << "Not loudness normalising " << outputFile.getFileName() << ": below the loudness gate" << std::endl;
+            return 1.0f;
+        }
+
+        auto gain = juce::Decibels::decibelsToGain(processing.normalizeTarget - static_cast<float>(lufs));
+
+        // Loudness normalisation doesn't push the peak over full scale
+        if (peak * gain > 1.0f)
+        {
+            std::cout << "Limiting loudness normalisation of " << outputFile.getFileName() << " to "
+                      << juce::Decibels::gainToDecibels(1.0f / peak) << " dB to keep the peak at 0 dBFS" << std::endl;
+            gain = 1.0f / peak;
+        }
+
+        return gain;
+    }
+
+    //==============================================================================
+    juce::TimeSliceThread writerThread;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    juce::AbstractFifo fifo { 2 };
+    juce::AudioBuffer<float> fifoBuffer, block;
+    std::vector<std::vector<int>> intBlock;     // dithered codes of the current block
+    std::vector<int*> intChannels;
+    std::atomic<bool> finishRequested { false };
+    std::atomic<bool> writeFailed { false };
+    juce::WaitableEvent finished { true };
+    bool opened = false;
+
+    OutputProcessing processing;
+    OutputPostProcessor postProcessor;
+    AudioAnalyzer analyzer;
+    std::unique_ptr<juce::TemporaryFile> spool;
+    std::unique_ptr<juce::FileOutputStream> spoolStream;
+    juce::int64 samplesSpooled = 0;
+
+    juce::File outputFile;
+    juce::int64 samplesWritten = 0;
+    double writtenSampleRate = 0.0;
+    int writtenChannels = 0;
+    int writtenBitDepth = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(AudioStreamWriter)
+};
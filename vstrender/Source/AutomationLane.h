@@ -0,0 +1,215 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+/**
+ * Breakpoint automation for one plugin parameter, parsed from a plugin's
+ * "automation" array:
+ *
+ *   { "parameter": "Cutoff", "interpolation": "linear",
+ *     "points": [[0.0, 0.1], [4.0, 0.9]] }
+ *
+ * "parameter" is a name (matched like "parameters") or an index. Times are in
+ * seconds, values are normalised 0..1. Before the first point the first value
+ * holds, after the last point the last value holds.
+ */
+class AutomationLane
+{
+public:
+    enum class Interpolation
+    {
+        linear,
+        step
+    };
+
+    struct Breakpoint
+    {
+        double time = 0.0;
+        float value = 0.0f;
+    };
+
+    juce::String parameterName;
+    int parameterIndex = -1;
+    Interpolation interpolation = Interpolation::linear;
+    std::vector<Breakpoint> breakpoints;
+
+    static bool fromVar(const juce::var& json, AutomationLane& lane, juce::String& error)
+    {
+        auto parameter = json["parameter"];
+
+        if (parameter.isInt() || parameter.isInt64() || parameter.isDouble())
+            lane.parameterIndex = static_cast<int>(parameter);
+        else
+            lane.parameterName = parameter.toString();
+
+        if (lane.parameterIndex < 0 && lane.parameterName.isEmpty())
+        {
+            error = "missing \"parameter\"";
+            return false;
+        }
+
+        auto interpolationName = json.getProperty("interpolation", "linear").toString();
+        if (interpolationName.equalsIgnoreCase("linear"))
+            lane.interpolation = Interpolation::linear;
+        else if (interpolationName.equalsIgnoreCase("step"))
+            lane.interpolation = Interpolation::step;
+        else
+        {
+            error = "unknown interpolation '" + interpolationName + "'";
+            return false;
+        }
+
+        auto* points = json["points"].getArray();
+        if (!points || points->isEmpty())
+        {
+            error = "\"points\" must be a non-empty array";
+            return false;
+        }
+
+        lane.breakpoints.clear();
+
+        for (const auto& point : *points)
+        {
+            Breakpoint breakpoint;
+
+            if (point.isArray() && point.size() >= 2)
+            {
+                breakpoint.time = point[0];
+                breakpoint.value = static_cast<float>(point[1]);
+            }
+            else if (point.isObject())
+            {
+                breakpoint.time = point.getProperty("time", 0.0);
+                breakpoint.value = static_cast<float>(point.getProperty("value", 0.0));
+            }
+            else
+            {
+                error = "points must be [time, value] or {\"time\": t, \"value\": v}";
+                return false;
+            }
+
+            breakpoint.time = juce::jmax(0.0, breakpoint.time);
+            breakpoint.value = juce::jlimit(0.0f, 1.0f, breakpoint.value);
+            lane.breakpoints.push_back(breakpoint);
+        }
+
+        std::stable_sort(lane.breakpoints.begin(), lane.breakpoints.end(),
+                         [](const Breakpoint& a, const Breakpoint& b) { return a.time < b.time; });
+        return true;
+    }
+
+    juce::String getDescription() const
+    {
+        return parameterName.isNotEmpty() ? parameterName : ("#" + juce::String(parameterIndex));
+    }
+};
+
+//==============================================================================
+/**
+ * Plays automation lanes against parameters that were resolved once before
+ * rendering. Render time only moves forward, so each lane keeps a cursor
+ * instead of searching its breakpoints every block, and a parameter is only
+ * touched when its value actually changes.
+ */
+class AutomationPlayer
+{
+public:
+    void clear()
+    {
+        targets.clear();
+        breakpointSamples.clear();
+        nextBreakpoint = 0;
+    }
+
+    void addTarget(juce::AudioProcessorParameter* parameter, const AutomationLane& lane)
+    {
+        if (parameter && !lane.breakpoints.empty())
+            targets.push_back({ parameter, &lane });
+    }
+
+    bool isEmpty() const    { return targets.empty(); }
+
+    /** Rewind the lanes and convert breakpoint times to sample positions. */
+    void prepare(double sampleRate)
+    {
+        breakpointSamples.clear();
+        nextBreakpoint = 0;
+
+        for (auto& target : targets)
+        {
+            target.cursor = 0;
+            target.lastValue = -1.0f;
+
+            for (const auto& breakpoint : target.lane->breakpoints)
+                breakpointSamples.push_back(static_cast<juce::int64>(breakpoint.time * sampleRate));
+        }
+
+        std::sort(breakpointSamples.begin(), breakpointSamples.end());
+        breakpointSamples.erase(std::unique(breakpointSamples.begin(), breakpointSamples.end()), breakpointSamples.end());
+    }
+
+    /** Set every automated parameter to its value at timeInSeconds. Times must not go backwards. */
+    void apply(double timeInSeconds)
+    {
+        for (auto& target : targets)
+        {
+            auto value = getValue(target, timeInSeconds);
+
+            if (value != target.lastValue)
+            {
+                target.parameter->setValue(value);
+                target.lastValue = value;
+            }
+        }
+    }
+
+    /**
+     * Length of the segment starting at startSample that ends on the next
+     * breakpoint, or maxSamples when no breakpoint falls inside the block.
+     */
+    int getSamplesUntilNextBreakpoint(juce::int64 startSample, int maxSamples)
+    {
+        while (nextBreakpoint < breakpointSamples.size() && breakpointSamples[nextBreakpoint] <= startSample)
+            nextBreakpoint++;
+
+        if (nextBreakpoint < breakpointSamples.size() && breakpointSamples[nextBreakpoint] < startSample + maxSamples)
+            return static_cast<int>(breakpointSamples[nextBreakpoint] - startSample);
+
+        return maxSamples;
+    }
+
+private:
+    struct Target
+    {
+        juce::AudioProcessorParameter* parameter = nullptr;
+        const AutomationLane* lane = nullptr;
+        size_t cursor = 0;
+        float lastValue = -1.0f;
+    };
+
+    static float getValue(Target& target, double time)
+    {
+        const auto& points = target.lane->breakpoints;
+
+        while (target.cursor + 1 < points.size() && points[target.cursor + 1].time <= time)
+            target.cursor++;
+
+        const auto& current = points[target.cursor];
+
+        if (time <= current.time || target.cursor + 1 >= points.size()
+            || target.lane->interpolation == AutomationLane::Interpolation::step)
+            return current.value;
+
+        const auto& next = points[target.cursor + 1];
+        auto proportion = static_cast<float>((time - current.time) / (next.time - current.time));
+        return current.value + (next.value - current.value) * proportion;
+    }
+
+    std::vector<Target> targets;
+    std::vector<juce::int64> breakpointSamples;
+    size_t nextBreakpoint = 0;
+};
@@ -0,0 +1,325 @@
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <psapi.h>
+#else
+ #include <sys/resource.h>
+#endif
+
+#include <cstdlib>
+
+#include "PluginHost.h"
+
+//==============================================================================
+// Render pipeline benchmarks
+//
+// Runs fixed scenarios through the same RenderEngine the host uses and prints
+// one JSON document: samples/sec and setup cost per scenario, and the peak
+// RSS of the whole run (the process-wide peak only ever grows, so it can't
+// be told apart per scenario).
+// Scenarios whose plugins are not available are reported as skipped.
+//==============================================================================
+
+struct BenchOptions
+{
+    juce::String dexedPath;
+    juce::String midiFile;
+    juce::String effectPath;
+    juce::String effectName;
+    juce::String outputFile;
+    double inputSeconds = 20.0;
+    int iterations = 3;
+};
+
+struct BenchScenario
+{
+    juce::String name;
+    juce::String kind;          // "passthrough", "instrument" or "effects"
+    int numEffects = 0;
+    double sampleRate = 44100.0;
+    int bufferSize = 512;
+};
+
+static juce::int64 getPeakResidentBytes()
+{
+   #if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<juce::int64>(counters.PeakWorkingSetSize);
+    return 0;
+   #else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    #if defined(__APPLE__)
+     return static_cast<juce::int64>(usage.ru_maxrss);           // bytes on macOS
+    #else
+     return static_cast<juce::int64>(usage.ru_maxrss) * 1024;    // kilobytes on Linux
+    #endif
+   #endif
+}
+
+static std::vector<BenchScenario> createScenarios()
+{
+    std::vector<BenchScenario> scenarios;
+    const double sampleRates[] = { 44100.0, 96000.0 };
+    const int bufferSizes[] = { 64, 512, 2048 };
+
+    for (auto sampleRate : sampleRates)
+    {
+        for (auto bufferSize : bufferSizes)
+        {
+            auto suffix = "_" + juce::String(static_cast<int>(sampleRate)) + "_" + juce::String(bufferSize);
+            scenarios.push_back({ "passthrough" + suffix, "passthrough", 0, sampleRate, bufferSize });
+            scenarios.push_back({ "dexed_scale" + suffix, "instrument", 0, sampleRate, bufferSize });
+        }
+    }
+
+    for (auto numEffects : { 1, 4, 16 })
+        scenarios.push_back({ "effects_x" + juce::String(numEffects) + "_48000_512", "effects", numEffects, 48000.0, 512 });
+
+    return scenarios;
+}
+
+// Deterministic stereo noise at -12 dB, one file per sample rate
+static juce::File createInputFile(const juce::File& workDir, double sampleRate, double seconds)
+{
+    auto file = workDir.getChildFile("bench_input_" + juce::String(static_cast<int>(sampleRate)) + ".wav");
+    if (file.existsAsFile())
+        return file;
+
+    AudioStreamWriter writer;
+    if (!writer.open(file, sampleRate, 2, 24, 32768))
+        return {};
+
+    juce::Random random(1234);
+    juce::AudioBuffer<float> block(2, 4096);
+    auto remaining = static_cast<juce::int64>(seconds * sampleRate);
+
+    while (remaining > 0)
+    {
+        auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(block.getNumSamples()), remaining));
+
+        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            auto* data = block.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+        }
+
+        writer.write(block, numSamples);
+        remaining -= numSamples;
+    }
+
+    if (!writer.close())
+        return {};
+
+    return file;
+}
+
+static juce::var runScenario(const BenchScenario& scenario, const BenchOptions& options, const juce::File& workDir,
+                             PluginScanCache* scanCache, MidiScheduleCache* scheduleCache)
+{
+    juce::var result(new juce::DynamicObject());
+    auto* object = result.getDynamicObject();
+
+    object->setProperty("name", scenario.name);
+    object->setProperty("kind", scenario.kind);
+    object->setProperty("sample_rate", scenario.sampleRate);
+    object->setProperty("buffer_size", scenario.bufferSize);
+
+    auto skip = [&](const juce::String& reason)
+    {
+        object->setProperty("status", "skipped");
+        object->setProperty("reason", reason);
+        return result;
+    };
+
+    ProcessingConfig job;
+    job.sampleRate = scenario.sampleRate;
+    job.bitDepth = 24;
+    job.bufferSize = scenario.bufferSize;
+    job.outputFile = workDir.getChildFile(scenario.name + ".wav").getFullPathName();
+
+    if (scenario.kind == "instrument")
+    {
+        if (options.dexedPath.isEmpty() || !juce::File(options.dexedPath).exists())
+            return skip("Dexed not found (use --dexed <path>)");
+
+        if (!juce::File(options.midiFile).existsAsFile())
+            return skip("MIDI file not found: " + options.midiFile);
+
+        PluginConfig dexed;
+        dexed.pluginPath = options.dexedPath;
+        dexed.isInstrument = true;
+        dexed.midiFile = options.midiFile;
+
+        job.hasInstrument = true;
+        job.plugins.push_back(dexed);
+    }
+    else
+    {
+        auto inputFile = createInputFile(workDir, scenario.sampleRate, options.inputSeconds);
+        if (!inputFile.existsAsFile())
+            return skip("Could not create input file");
+
+        job.inputFile = inputFile.getFullPathName();
+
+        if (scenario.kind == "effects")
+        {
+            if (options.effectPath.isEmpty() || !juce::File(options.effectPath).exists())
+                return skip("No effect plugin (use --effect <path>)");
+
+            for (int i = 0; i < scenario.numEffects; ++i)
+            {
+                PluginConfig effect;
+                effect.pluginPath = options.effectPath;
+                effect.pluginName = options.effectName;
+                job.plugins.push_back(effect);
+            }
+        }
+    }
+
+    object->setProperty("plugins", static_cast<int>(job.plugins.size()));
+
+    RenderEngine engine(scanCache, scheduleCache);
+
+    auto setupStart = juce::Time::getMillisecondCounterHiRes();
+    if (!engine.loadPlugins(job))
+    {
+        object->setProperty("status", "failed");
+        object->setProperty("reason", "Could not load plugin chain");
+        return result;
+    }
+    auto setupSeconds = (juce::Time::getMillisecondCounterHiRes() - setupStart) / 1000.0;
+
+    double bestRate = 0.0;
+    double totalRate = 0.0;
+    juce::int64 samples = 0;
+
+    for (int iteration = 0; iteration < options.iterations; ++iteration)
+    {
+        if (!engine.renderJob(job))
+        {
+            object->setProperty("status", "failed");
+            object->setProperty("reason", "Render failed");
+            return result;
+        }
+
+        const auto& stats = engine.getLastStats();
+        samples = stats.samplesRendered;
+
+        auto rate = stats.renderSeconds > 0.0 ? samples / stats.renderSeconds : 0.0;
+        bestRate = juce::jmax(bestRate, rate);
+        totalRate += rate;
+    }
+
+    engine.releasePlugins();
+    juce::File(job.outputFile).deleteFile();
+
+    object->setProperty("status", "ok");
+    object->setProperty("setup_seconds", setupSeconds);
+    object->setProperty("iterations", options.iterations);
+    object->setProperty("samples", samples);
+    object->setProperty("best_samples_per_second", bestRate);
+    object->setProperty("mean_samples_per_second", totalRate / options.iterations);
+    object->setProperty("best_realtime_factor", bestRate / scenario.sampleRate);
+    return result;
+}
+
+static bool parseOptions(int argc, char* argv[], BenchOptions& options)
+{
+    options.dexedPath = "C:\\Program Files\\Common Files\\VST3\\Dexed.vst3";
+    options.midiFile = juce::File::getCurrentWorkingDirectory().getChildFile("c_major_scale_fixed.mid").getFullPathName();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg(argv[i]);
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--dexed" && hasValue)               options.dexedPath = argv[++i];
+        else if (arg == "--midi" && hasValue)           options.midiFile = argv[++i];
+        else if (arg == "--effect" && hasValue)         options.effectPath = argv[++i];
+        else if (arg == "--effect-name" && hasValue)    options.effectName = argv[++i];
+        else if (arg == "--output" && hasValue)         options.outputFile = argv[++i];
+        else if (arg == "--seconds" && hasValue)        options.inputSeconds = juce::jmax(1.0, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--iterations" && hasValue)     options.iterations = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::initialiseJuce_GUI();
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: VSTPluginHostBench [--dexed <Dexed.vst3>] [--midi <file.mid>] [--effect <plugin.vst3>]"
+                  << " [--effect-name <name>] [--seconds <input length>] [--iterations <n>] [--output <results.json>]" << std::endl;
+        std::exit(1);
+    }
+
+    // Engine chatter would dominate the timings at small buffer sizes
+    HostLog::setLevel(LogLevel::quiet);
+
+    auto workDir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("VSTPluginHostBench");
+    workDir.createDirectory();
+
+    PluginScanCache scanCache(PluginScanCache::getDefaultCacheFile());
+    MidiScheduleCache scheduleCache;
+
+    juce::var report(new juce::DynamicObject());
+    auto* reportObject = report.getDynamicObject();
+    reportObject->setProperty("host_version", "1.0.0");
+    reportObject->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    reportObject->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    reportObject->setProperty("cpu", juce::SystemStats::getCpuModel());
+    reportObject->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    reportObject->setProperty("input_seconds", options.inputSeconds);
+
+    juce::Array<juce::var> results;
+    int failures = 0;
+
+    for (const auto& scenario : createScenarios())
+    {
+        std::cerr << "[BENCH] " << scenario.name << std::endl;
+
+        auto result = runScenario(scenario, options, workDir, &scanCache, &scheduleCache);
+        if (result["status"].toString() == "failed")
+            failures++;
+
+        results.add(result);
+    }
+
+    reportObject->setProperty("scenarios", results);
+    reportObject->setProperty("peak_rss_bytes", getPeakResidentBytes());
+
+    auto json = juce::JSON::toString(report);
+
+    if (options.outputFile.isNotEmpty())
+    {
+        if (!juce::File(options.outputFile).replaceWithText(json))
+        {
+            std::cerr << "Could not write " << options.outputFile << std::endl;
+            failures++;
+        }
+    }
+    else
+    {
+        HostLog::writeToStdout(json);
+    }
+
+    workDir.deleteRecursively();
+
+    // Skip static destruction, as the host does, to avoid plugin cleanup crashes
+    std::exit(failures == 0 ? 0 : 1);
+}
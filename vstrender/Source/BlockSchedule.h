@@ -0,0 +1,243 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <limits>
+#include <vector>
+
+#include "RenderProfiler.h"
+
+//==============================================================================
+/**
+ * How a job cuts its render into blocks, from the job's keys:
+ *
+ *   "adaptive_blocks": { "max_block_size": "auto", "min_block_size": 1 },
+ *   "pre_roll": 0.5
+ *
+ * Without adaptive_blocks every block is buffer_size long. With it, blocks
+ * grow to max_block_size through stretches without MIDI and are cut where
+ * the next event starts, so events land at the start of the block that plays
+ * them; events closer together than min_block_size share a block. "auto"
+ * (also what "adaptive_blocks": true means) times each plugin at sizes from
+ * buffer_size up to autoBlockLimit and takes the largest size any of them
+ * still gains from. The host tunes once per batch, before its workers start,
+ * and stores the size in every job as tunedBlockSize, so all jobs of a batch
+ * render at the same size. "tuned_block_size" pins that size instead; the
+ * host sets it in the requests it sends to isolated worker processes. Jobs
+ * with automation lanes keep buffer_size steps, so parameter updates don't
+ * get coarser.
+ *
+ * pre_roll runs that many seconds of silence through the chain, without MIDI,
+ * after the job's state is loaded and before anything is written, so
+ * smoothed parameters, oversampling filters and lookahead buffers have
+ * settled by the first sample of the file.
+ */
+struct BlockSchedule
+{
+    static constexpr int autoBlockLimit = 16384;
+
+    bool adaptive = false;
+    int maxBlockSize = 0;       // 0 = tuned per chain
+    int minBlockSize = 1;
+    double preRollSeconds = 0.0;
+
+    // For "auto": the size picked for the batch, and the timings it was picked from (for the profile)
+    int tunedBlockSize = 0;
+    juce::var tuning;
+
+    bool isTuned() const        { return adaptive && maxBlockSize <= 0; }
+    bool needsTuning() const    { return isTuned() && tunedBlockSize <= 0; }
+
+    static bool fromVar(const juce::var& json, int bufferSize, BlockSchedule& schedule, juce::String& error)
+    {
+        schedule = {};
+        schedule.preRollSeconds = juce::jmax(0.0, static_cast<double>(json.getProperty("pre_roll", 0.0)));
+
+        auto adaptiveJson = json["adaptive_blocks"];
+        if (adaptiveJson.isVoid() || (adaptiveJson.isBool() && !static_cast<bool>(adaptiveJson)))
+            return true;
+
+        schedule.adaptive = true;
+
+        if (!adaptiveJson.isObject())
+            return true;
+
+        auto maxJson = adaptiveJson["max_block_size"];
+        if (maxJson.isString() && !maxJson.toString().equalsIgnoreCase("auto"))
+        {
+            error = "max_block_size must be a number or \"auto\"";
+            return false;
+        }
+
+        if (!maxJson.isVoid() && !maxJson.isString())
+            schedule.maxBlockSize = juce::jmax(bufferSize, static_cast<int>(maxJson));
+
+        if (schedule.isTuned() && adaptiveJson.hasProperty("tuned_block_size"))
+            schedule.tunedBlockSize = juce::jlimit(juce::jmax(1, bufferSize), juce::jmax(bufferSize, autoBlockLimit),
+                                                   static_cast<int>(adaptiveJson["tuned_block_size"]));
+
+        // Events at most a buffer apart always get their own block
+        schedule.minBlockSize = juce::jlimit(1, juce::jmax(1, bufferSize),
+                                             static_cast<int>(adaptiveJson.getProperty("min_block_size", 1)));
+        return true;
+    }
+
+    /** Largest block the plugins are prepared for: every block of the render fits in it. */
+    int getPreparedBlockSize(int bufferSize) const
+    {
+        if (!adaptive)
+            return bufferSize;
+
+        return juce::jmax(bufferSize, maxBlockSize > 0 ? maxBlockSize : autoBlockLimit);
+    }
+
+    /** Part of the render cache key. A tuned job is keyed on the size it was tuned to, not on "auto". */
+    void writeTo(juce::OutputStream& out) const
+    {
+        out.writeBool(adaptive);
+        out.writeInt(maxBlockSize);
+        out.writeInt(tunedBlockSize);
+        out.writeInt(minBlockSize);
+        out.writeDouble(preRollSeconds);
+    }
+};
+
+//==============================================================================
+/**
+ * Picks block sizes from processBlock timings. Each candidate size is timed
+ * over a few blocks on a quiet input (no MIDI for instruments, noise at
+ * -60 dBFS for effects, so silence detection doesn't skip the work) and the
+ * fastest block per sample is kept, which filters out preemption. A plugin's
+ * size is the smallest one within tolerance of its best time per sample;
+ * bigger blocks than that save next to nothing.
+ */
+class BlockSizeTuner
+{
+public:
+    struct Measurement
+    {
+        int blockSize = 0;
+        double secondsPerSample = 0.0;
+    };
+
+    struct PluginResult
+    {
+        juce::String name;
+        std::vector<Measurement> measurements;
+        int blockSize = 0;
+    };
+
+    /** buffer_size, doubled up to maxSize. */
+    static std::vector<int> getCandidates(int bufferSize, int maxSize)
+    {
+        std::vector<int> candidates;
+
+        for (auto size = juce::jmax(1, bufferSize); size <= maxSize; size *= 2)
+            candidates.push_back(size);
+
+        if (candidates.empty())
+            candidates.push_back(juce::jmax(1, bufferSize));
+
+        return candidates;
+    }
+
+    static PluginResult measure(juce::AudioPluginInstance& plugin, int numChannels, bool isInstrument,
+                                const std::vector<int>& candidates)
+    {
+        PluginResult result;
+        result.name = plugin.getName();
+
+        juce::AudioBuffer<float> storage(numChannels, candidates.back());
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+
+        for (auto size : candidates)
+        {
+            // The first block of each size is a warm-up and isn't counted
+            auto repeats = juce::jmax(minRepeats, samplesPerCandidate / size) + 1;
+            auto fastest = std::numeric_limits<double>::max();
+
+            for (int repeat = 0; repeat < repeats; ++repeat)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* data = storage.getWritePointer(ch);
+                    for (int i = 0; i < size; ++i)
+                        data[i] = isInstrument ? 0.0f : (random.nextFloat() * 2.0f - 1.0f) * 0.001f;
+                }
+
+                juce::AudioBuffer<float> block(storage.getArrayOfWritePointers(), numChannels, 0, size);
+                midi.clear();
+
+                auto start = RenderProfiler::now();
+                plugin.processBlock(block, midi);
+                auto seconds = RenderProfiler::secondsSince(start);
+
+                if (repeat > 0)
+                    fastest = juce::jmin(fastest, seconds);
+            }
+
+            result.measurements.push_back({ size, fastest / size });
+        }
+
+        result.blockSize = pickBlockSize(result.measurements);
+        return result;
+    }
+
+    static int pickBlockSize(const std::vector<Measurement>& measurements, double tolerance = 0.05)
+    {
+        if (measurements.empty())
+            return 0;
+
+        auto best = std::numeric_limits<double>::max();
+        for (const auto& measurement : measurements)
+            best = juce::jmin(best, measurement.secondsPerSample);
+
+        for (const auto& measurement : measurements)
+        {
+            if (measurement.secondsPerSample <= best * (1.0 + tolerance))
+                return measurement.blockSize;
+        }
+
+        return measurements.back().blockSize;
+    }
+
+    /** The chain runs at the largest size any plugin still gains from. */
+    static int getChainBlockSize(const std::vector<PluginResult>& results, int fallback)
+    {
+        int size = 0;
+        for (const auto& result : results)
+            size = juce::jmax(size, result.blockSize);
+
+        return size > 0 ? size : fallback;
+    }
+
+    /** For the render profile. */
+    static juce::var toVar(const std::vector<PluginResult>& results, int chainBlockSize)
+    {
+        juce::Array<juce::var> pluginList;
+
+        for (const auto& result : results)
+        {
+            juce::var timings(new juce::DynamicObject());
+            for (const auto& measurement : result.measurements)
+                timings.getDynamicObject()->setProperty(juce::String(measurement.blockSize), measurement.secondsPerSample * 1.0e9);
+
+            juce::var entry(new juce::DynamicObject());
+            entry.getDynamicObject()->setProperty("name", result.name);
+            entry.getDynamicObject()->setProperty("block_size", result.blockSize);
+            entry.getDynamicObject()->setProperty("ns_per_sample", timings);
+            pluginList.add(entry);
+        }
+
+        juce::var tuning(new juce::DynamicObject());
+        tuning.getDynamicObject()->setProperty("block_size", chainBlockSize);
+        tuning.getDynamicObject()->setProperty("plugins", pluginList);
+        return tuning;
+    }
+
+private:
+    static constexpr int minRepeats = 4;
+    static constexpr int samplesPerCandidate = 4 * BlockSchedule::autoBlockLimit;
+};
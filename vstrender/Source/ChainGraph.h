@@ -0,0 +1,429 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+/**
+ * Routing between the plugins of a job, from a "graph" object:
+ *
+ *   "graph": {
+ *     "threads": 4,
+ *     "edges": [
+ *       { "from": "input", "to": 0 },
+ *       { "from": "input", "to": 1, "gain_db": -6.0 },
+ *       { "from": 0, "to": 2 },
+ *       { "from": 1, "to": 2 },
+ *       { "from": 2, "to": "output" }
+ *     ]
+ *   }
+ *
+ * Nodes are plugin indices. A node's input is the sum of its incoming edges,
+ * each scaled by "gain" (linear) or "gain_db"; a node without incoming edges
+ * starts from silence, which is what an instrument wants.
+ */
+struct GraphConfig
+{
+    static constexpr int inputNode = -1;
+    static constexpr int outputNode = -2;
+
+    struct Edge
+    {
+        int from = inputNode;
+        int to = outputNode;
+        float gain = 1.0f;
+    };
+
+    std::vector<Edge> edges;
+    int threads = 0;    // 0 = as many as the widest level needs, up to the core count
+
+    bool isEmpty() const    { return edges.empty(); }
+
+    static bool fromVar(const juce::var& json, size_t numPlugins, GraphConfig& graph, juce::String& error)
+    {
+        auto* edgesArray = json["edges"].getArray();
+        if (edgesArray == nullptr || edgesArray->isEmpty())
+        {
+            error = "\"edges\" must be a non-empty array";
+            return false;
+        }
+
+        graph.threads = json.getProperty("threads", 0);
+        bool reachesOutput = false;
+
+        for (int i = 0; i < edgesArray->size(); ++i)
+        {
+            const auto& edgeJson = edgesArray->getReference(i);
+            Edge edge;
+
+            if (!parseNode(edgeJson["from"], numPlugins, edge.from) || edge.from == outputNode)
+            {
+                error = "edge " + juce::String(i) + ": invalid \"from\"";
+                return false;
+            }
+
+            if (!parseNode(edgeJson["to"], numPlugins, edge.to) || edge.to == inputNode)
+            {
+                error = "edge " + juce::String(i) + ": invalid \"to\"";
+                return false;
+            }
+
+            if (edgeJson.hasProperty("gain_db"))
+                edge.gain = juce::Decibels::decibelsToGain(static_cast<float>(edgeJson["gain_db"]), -200.0f);
+            else
+                edge.gain = static_cast<float>(edgeJson.getProperty("gain", 1.0));
+
+            reachesOutput = reachesOutput || edge.to == outputNode;
+            graph.edges.push_back(edge);
+        }
+
+        if (!reachesOutput)
+        {
+            error = "no edge leads to \"output\"";
+            return false;
+        }
+
+        std::vector<std::vector<size_t>> levels;
+        if (!computeLevels(graph, numPlugins, levels))
+        {
+            error = "the graph has a cycle";
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * The routing used when a chain holds several instruments and no "graph":
+     * each instrument starts a bus with the effects listed after it, up to the
+     * next instrument; the buses are summed into the effects that follow the
+     * last instrument, or straight into the output. Returns an empty graph
+     * (plain series) for fewer than two instruments, or when the chain does
+     * not start with one.
+     */
+    static GraphConfig createInstrumentBuses(const std::vector<bool>& instrumentNodes)
+    {
+        GraphConfig graph;
+
+        auto numInstruments = std::count(instrumentNodes.begin(), instrumentNodes.end(), true);
+        if (numInstruments < 2 || !instrumentNodes.front())
+            return graph;
+
+        auto lastInstrument = static_cast<int>(std::find(instrumentNodes.rbegin(), instrumentNodes.rend(), true).base()
+                                               - instrumentNodes.begin()) - 1;
+        auto numNodes = static_cast<int>(instrumentNodes.size());
+        auto mixNode = lastInstrument + 1 < numNodes ? lastInstrument + 1 : outputNode;
+
+        // Buses: instrument -> its inserts -> master
+        for (int node = 0; node <= lastInstrument; ++node)
+        {
+            auto next = node + 1;
+            bool busEnds = next > lastInstrument || instrumentNodes[static_cast<size_t>(next)];
+            graph.edges.push_back({ node, busEnds ? mixNode : next, 1.0f });
+        }
+
+        // Master: the effects after the last instrument, in series
+        for (int node = lastInstrument + 1; node < numNodes; ++node)
+            graph.edges.push_back({ node, node + 1 < numNodes ? node + 1 : outputNode, 1.0f });
+
+        return graph;
+    }
+
+    /**
+     * Nodes grouped so every node only depends on nodes of earlier levels;
+     * the nodes of one level can run at the same time. False on a cycle.
+     */
+    static bool computeLevels(const GraphConfig& graph, size_t numNodes, std::vector<std::vector<size_t>>& levels)
+    {
+        std::vector<int> nodeLevels(numNodes, 0);
+
+        // Longest-path relaxation; needing more than numNodes passes means a cycle
+        for (size_t pass = 0;; ++pass)
+        {
+            bool changed = false;
+
+            for (const auto& edge : graph.edges)
+            {
+                if (edge.from < 0 || edge.to < 0)
+                    continue;
+
+                auto& level = nodeLevels[static_cast<size_t>(edge.to)];
+                if (level < nodeLevels[static_cast<size_t>(edge.from)] + 1)
+                {
+                    level = nodeLevels[static_cast<size_t>(edge.from)] + 1;
+                    changed = true;
+                }
+            }
+
+            if (!changed)
+                break;
+
+            if (pass >= numNodes)
+                return false;
+        }
+
+        levels.clear();
+        for (size_t node = 0; node < numNodes; ++node)
+        {
+            auto level = static_cast<size_t>(nodeLevels[node]);
+            if (levels.size() <= level)
+                levels.resize(level + 1);
+
+            levels[level].push_back(node);
+        }
+
+        return true;
+    }
+
+private:
+    static bool parseNode(const juce::var& value, size_t numPlugins, int& node)
+    {
+        if (value.isString())
+        {
+            if (value.toString() == "input")    { node = inputNode; return true; }
+            if (value.toString() == "output")   { node = outputNode; return true; }
+            return false;
+        }
+
+        if (!value.isInt() && !value.isInt64() && !value.isDouble())
+            return false;
+
+        node = static_cast<int>(value);
+        return node >= 0 && static_cast<size_t>(node) < numPlugins;
+    }
+};
+
+//==============================================================================
+/**
+ * Persistent helper threads that run the tasks of one graph level; the calling
+ * thread takes tasks too. Threads sleep on a condition variable between
+ * levels, so an idle engine costs nothing.
+ */
+class LevelWorkers
+{
+public:
+    ~LevelWorkers()
+    {
+        stop();
+    }
+
+    void start(int numHelpers)
+    {
+        if (static_cast<int>(threads.size()) == numHelpers)
+            return;
+
+        stop();
+        quit = false;
+
+        for (int i = 0; i < numHelpers; ++i)
+            threads.emplace_back([this, startGeneration = generation]() { workerLoop(startGeneration); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+
+        wake.notify_all();
+
+        for (auto& thread : threads)
+            thread.join();
+
+        threads.clear();
+    }
+
+    /** Run task(0) .. task(numTasks - 1) across the helpers and this thread; returns when all are done. */
+    void run(int numTasks, const std::function<void(int)>& task)
+    {
+        if (threads.empty() || numTasks <= 1)
+        {
+            for (int i = 0; i < numTasks; ++i)
+                task(i);
+
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentTask = &task;
+            taskCount = numTasks;
+            nextTask = 0;
+            busyHelpers = static_cast<int>(threads.size());
+            generation++;
+        }
+
+        wake.notify_all();
+        runTasks(task, numTasks);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return busyHelpers == 0; });
+        currentTask = nullptr;
+    }
+
+private:
+    // Started with the current generation, so a new thread only picks up runs issued after it
+    void workerLoop(juce::uint64 seenGeneration)
+    {
+        for (;;)
+        {
+            const std::function<void(int)>* task;
+            int count;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return quit || generation != seenGeneration; });
+
+                if (quit)
+                    return;
+
+                seenGeneration = generation;
+                task = currentTask;
+                count = taskCount;
+            }
+
+            runTasks(*task, count);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--busyHelpers == 0)
+                    done.notify_one();
+            }
+        }
+    }
+
+    void runTasks(const std::function<void(int)>& task, int count)
+    {
+        for (auto index = nextTask++; index < count; index = nextTask++)
+            task(index);
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)>* currentTask = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask { 0 };
+    int busyHelpers = 0;
+    juce::uint64 generation = 0;
+    bool quit = false;
+};
+
+//==============================================================================
+/**
+ * Runs one block through a GraphConfig. Every node owns a buffer allocated
+ * in prepare(), which holds its output for the rest of the block; edges read
+ * from those buffers, so nothing is allocated while rendering. The nodes of
+ * a level are processed concurrently by LevelWorkers.
+ */
+class ChainGraph
+{
+public:
+    /** Called for each node with its summed input, to be processed in place. */
+    using NodeProcessor = std::function<void(size_t node, juce::AudioBuffer<float>& buffer)>;
+
+    void prepare(const GraphConfig& graphToUse, size_t numNodes, int numChannelsToUse, int maxBlockSize)
+    {
+        graph = graphToUse;
+        numChannels = numChannelsToUse;
+        GraphConfig::computeLevels(graph, numNodes, levels);
+
+        incoming.assign(numNodes, {});
+        outputEdges.clear();
+
+        for (const auto& edge : graph.edges)
+        {
+            if (edge.to == GraphConfig::outputNode)
+                outputEdges.push_back(edge);
+            else
+                incoming[static_cast<size_t>(edge.to)].push_back(edge);
+        }
+
+        nodeBuffers.resize(numNodes);
+        for (auto& buffer : nodeBuffers)
+            buffer.setSize(numChannels, maxBlockSize);
+
+        inputBuffer.setSize(numChannels, maxBlockSize);
+
+        size_t widestLevel = 1;
+        for (const auto& level : levels)
+            widestLevel = std::max(widestLevel, level.size());
+
+        auto maxThreads = static_cast<size_t>(juce::jmax(1, juce::SystemStats::getNumCpus()));
+        auto threads = graph.threads > 0 ? static_cast<size_t>(graph.threads) : std::min(widestLevel, maxThreads);
+        workers.start(static_cast<int>(std::min(threads, widestLevel)) - 1);
+
+        // Built once: a std::function made per level and block could allocate
+        levelTask = [this](int index) { processLevelNode(index); };
+    }
+
+    /** Replace the first numSamples of io (the graph input) with the graph output. */
+    void process(juce::AudioBuffer<float>& io, int numSamples, const NodeProcessor& processNode)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            inputBuffer.copyFrom(ch, 0, io, ch, 0, numSamples);
+
+        currentProcessor = &processNode;
+        currentNumSamples = numSamples;
+
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            currentLevel = level;
+            workers.run(static_cast<int>(levels[level].size()), levelTask);
+        }
+
+        juce::AudioBuffer<float> output(io.getArrayOfWritePointers(), numChannels, 0, numSamples);
+        mixInto(output, outputEdges, numSamples);
+    }
+
+    /** A node's output from the last process() call. */
+    const juce::AudioBuffer<float>& getNodeOutput(size_t node) const    { return nodeBuffers[node]; }
+
+    size_t getNumLevels() const     { return levels.size(); }
+
+private:
+    void processLevelNode(int index)
+    {
+        auto node = levels[currentLevel][static_cast<size_t>(index)];
+        juce::AudioBuffer<float> buffer(nodeBuffers[node].getArrayOfWritePointers(), numChannels, 0, currentNumSamples);
+
+        mixInto(buffer, incoming[node], currentNumSamples);
+        (*currentProcessor)(node, buffer);
+    }
+
+    void mixInto(juce::AudioBuffer<float>& destination, const std::vector<GraphConfig::Edge>& edges, int numSamples) const
+    {
+        destination.clear();
+
+        for (const auto& edge : edges)
+        {
+            const auto& source = edge.from == GraphConfig::inputNode ? inputBuffer : nodeBuffers[static_cast<size_t>(edge.from)];
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                destination.addFrom(ch, 0, source, ch, 0, numSamples, edge.gain);
+        }
+    }
+
+    GraphConfig graph;
+    int numChannels = 0;
+    std::vector<std::vector<size_t>> levels;
+    std::vector<std::vector<GraphConfig::Edge>> incoming;
+    std::vector<GraphConfig::Edge> outputEdges;
+    std::vector<juce::AudioBuffer<float>> nodeBuffers;
+    juce::AudioBuffer<float> inputBuffer;
+
+    std::function<void(int)> levelTask;
+    const NodeProcessor* currentProcessor = nullptr;
+    size_t currentLevel = 0;
+    int currentNumSamples = 0;
+
+    LevelWorkers workers;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <iostream>
+
+//==============================================================================
+/**
+ * Process-wide console verbosity, set from the "log_level" config key.
+ *
+ *   quiet   - errors on stderr and the final JSON summary only
+ *   normal  - job progress and results (default)
+ *   verbose - parameter tables, MIDI analysis, render progress
+ *   debug   - per-event MIDI and program listings
+ *
+ * Hot paths check isEnabled() before building any output, so a disabled level
+ * costs one relaxed atomic load.
+ */
+enum class LogLevel
+{
+    quiet = 0,
+    normal,
+    verbose,
+    debug
+};
+
+class HostLog
+{
+public:
+    /** Quiet also puts std::cout into a failed state so any remaining chatter is dropped. */
+    static void setLevel(LogLevel newLevel)
+    {
+        currentLevel().store(static_cast<int>(newLevel), std::memory_order_relaxed);
+
+        if (newLevel == LogLevel::quiet)
+            std::cout.setstate(std::ios::failbit);
+        else
+            std::cout.clear();
+    }
+
+    static LogLevel getLevel()
+    {
+        return static_cast<LogLevel>(currentLevel().load(std::memory_order_relaxed));
+    }
+
+    static bool isEnabled(LogLevel level)
+    {
+        return static_cast<int>(level) <= currentLevel().load(std::memory_order_relaxed);
+    }
+
+    static bool parseLevel(const juce::String& name, LogLevel& result)
+    {
+        for (auto level : { LogLevel::quiet, LogLevel::normal, LogLevel::verbose, LogLevel::debug })
+        {
+            if (name.equalsIgnoreCase(getLevelName(level)))
+            {
+                result = level;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static const char* getLevelName(LogLevel level)
+    {
+        switch (level)
+        {
+            case LogLevel::quiet:   return "quiet";
+            case LogLevel::normal:  return "normal";
+            case LogLevel::verbose: return "verbose";
+            case LogLevel::debug:   return "debug";
+        }
+
+        return "normal";
+    }
+
+    /** Write to stdout regardless of the level (used for the quiet-mode summary). */
+    static void writeToStdout(const juce::String& text)
+    {
+        auto state = std::cout.rdstate();
+        std::cout.clear();
+        std::cout << text << std::endl;
+        std::cout.setstate(state);
+    }
+
+private:
+    static std::atomic<int>& currentLevel()
+    {
+        static std::atomic<int> level { static_cast<int>(LogLevel::normal) };
+        return level;
+    }
+};
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "MidiUtilities.h"
+
+//==============================================================================
+/**
+ * Directory-wide versions of the MidiUtilities file operations, for preparing
+ * MIDI corpora. Every .mid/.midi under the input directory is read once; its
+ * analysis, every transposition variant and the channel extraction are all
+ * produced from that one parse. Files are spread over worker threads and the
+ * per-file results come back as one report instead of per-file console output.
+ *
+ * Outputs mirror the input tree under the output directory:
+ *
+ *   <relative dir>/<name>_t+3.mid     transposition variants
+ *   <relative dir>/<name>_ch1-2.mid   channel extraction
+ */
+class MidiCorpus
+{
+public:
+    struct Options
+    {
+        juce::File inputDirectory;
+        juce::File outputDirectory;
+        bool recursive = true;
+
+        // Transposition variants from transposeMin to transposeMax; 0 is skipped
+        bool transpose = false;
+        int transposeMin = 0;
+        int transposeMax = 0;
+
+        // Channels to extract (none = no extraction)
+        std::vector<int> channels;
+
+        int numThreads = 0;    // 0 = one per CPU
+    };
+
+    struct FileResult
+    {
+        juce::String relativePath;
+        bool parsed = false;
+        juce::String error;
+        MidiUtilities::MidiAnalysis analysis;
+        bool validForVsti = false;
+        juce::String validationMessage;
+        int filesWritten = 0;
+        int writeFailures = 0;
+        double seconds = 0.0;
+    };
+
+    struct Report
+    {
+        std::vector<FileResult> files;
+        int numThreads = 0;
+        double seconds = 0.0;
+
+        int getNumParsed() const
+        {
+            int count = 0;
+            for (const auto& file : files)
+                count += file.parsed ? 1 : 0;
+            return count;
+        }
+
+        bool hasFailures() const
+        {
+            for (const auto& file : files)
+                if (!file.parsed || file.writeFailures > 0)
+                    return true;
+
+            return false;
+        }
+
+        void print() const
+        {
+            int valid = 0, written = 0, writeFailures = 0;
+            juce::int64 totalNotes = 0, totalEvents = 0;
+            double totalDuration = 0.0;
+            int lowestNote = 127, highestNote = 0;
+
+            for (const auto& file : files)
+            {
+                if (!file.parsed)
+                    continue;
+
+                valid += file.validForVsti ? 1 : 0;
+                written += file.filesWritten;
+                writeFailures += file.writeFailures;
+                totalNotes += file.analysis.totalNotes;
+                totalEvents += file.analysis.totalEvents;
+                totalDuration += file.analysis.totalDuration;
+
+                if (file.analysis.totalNotes > 0)
+                {
+                    lowestNote = juce::jmin(lowestNote, file.analysis.lowestNote);
+                    highestNote = juce::jmax(highestNote, file.analysis.highestNote);
+                }
+            }
+
+            std::cout << "=== MIDI CORPUS REPORT ===" << std::endl;
+            std::cout << "Files: " << files.size() << " (" << getNumParsed() << " parsed, "
+                      << valid << " valid for VSTi rendering)" << std::endl;
+            std::cout << "Total Duration: " << totalDuration << " seconds" << std::endl;
+            std::cout << "Total Notes: " << totalNotes << std::endl;
+            std::cout << "Total Events: " << totalEvents << std::endl;
+
+            if (totalNotes > 0)
+                std::cout << "Note Range: " << lowestNote << " - " << highestNote << std::endl;
+
+            std::cout << "Files Written: " << written;
+            if (writeFailures > 0)
+                std::cout << " (" << writeFailures << " failed)";
+            std::cout << std::endl;
+
+            // Only the problem files are listed one by one
+            for (const auto& file : files)
+            {
+                if (!file.parsed)
+                    std::cout << "  FAILED  " << file.relativePath << ": " << file.error << std::endl;
+                else if (!file.validForVsti)
+                    std::cout << "  INVALID " << file.relativePath << ": " << file.validationMessage << std::endl;
+                else if (file.writeFailures > 0)
+                    std::cout << "  WRITE   " << file.relativePath << ": " << file.writeFailures << " output(s) failed" << std::endl;
+            }
+
+            std::cout << "Time: " << seconds << " seconds on " << numThreads << " thread(s)" << std::endl;
+            std::cout << "==========================" << std::endl;
+        }
+
+        juce::var toVar() const
+        {
+            juce::Array<juce::var> fileList;
+
+            for (const auto& file : files)
+            {
+                juce::var entry(new juce::DynamicObject());
+                auto* object = entry.getDynamicObject();
+                object->setProperty("file", file.relativePath);
+                object->setProperty("parsed", file.parsed);
+
+                if (!file.parsed)
+                {
+                    object->setProperty("error", file.error);
+                    fileList.add(entry);
+                    continue;
+                }
+
+                const auto& analysis = file.analysis;
+                object->setProperty("valid", file.validForVsti);
+                if (file.validationMessage.isNotEmpty())
+                    object->setProperty("validation", file.validationMessage);
+
+                object->setProperty("duration", analysis.totalDuration);
+                object->setProperty("first_note", analysis.firstNoteTime);
+                object->setProperty("last_note", analysis.lastNoteTime);
+                object->setProperty("notes", analysis.totalNotes);
+                object->setProperty("events", analysis.totalEvents);
+                object->setProperty("tracks", static_cast<int>(analysis.tracks.size()));
+                object->setProperty("average_tempo", analysis.averageTempo);
+
+                if (analysis.totalNotes > 0)
+                {
+                    object->setProperty("lowest_note", analysis.lowestNote);
+                    object->setProperty("highest_note", analysis.highestNote);
+                }
+
+                juce::Array<juce::var> channelList;
+                for (const auto& [channel, info] : analysis.channels)
+                {
+                    juce::var channelEntry(new juce::DynamicObject());
+                    channelEntry.getDynamicObject()->setProperty("channel", channel);
+                    channelEntry.getDynamicObject()->setProperty("notes", info.noteCount);
+                    if (info.programNumber >= 0)
+                        channelEntry.getDynamicObject()->setProperty("program", info.programNumber);
+                    channelList.add(channelEntry);
+                }
+
+                object->setProperty("channels", channelList);
+                object->setProperty("files_written", file.filesWritten);
+                object->setProperty("write_failures", file.writeFailures);
+                object->setProperty("seconds", file.seconds);
+                fileList.add(entry);
+            }
+
+            juce::var result(new juce::DynamicObject());
+            result.getDynamicObject()->setProperty("num_files", static_cast<int>(files.size()));
+            result.getDynamicObject()->setProperty("num_parsed", getNumParsed());
+            result.getDynamicObject()->setProperty("threads", numThreads);
+            result.getDynamicObject()->setProperty("seconds", seconds);
+            result.getDynamicObject()->setProperty("files", fileList);
+            return result;
+        }
+
+        bool writeTo(const juce::File& file) const
+        {
+            file.getParentDirectory().createDirectory();
+
+            if (!file.replaceWithText(juce::JSON::toString(toVar())))
+            {
+                std::cerr << "Could not write corpus report: " << file.getFullPathName() << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+    };
+
+    /** Process every MIDI file under options.inputDirectory. */
+    static Report run(const Options& options)
+    {
+        Report report;
+        auto start = juce::Time::getMillisecondCounterHiRes();
+
+        auto inputs = options.inputDirectory.findChildFiles(juce::File::findFiles, options.recursive, "*.mid;*.midi");
+        inputs.sort();
+
+        report.files.resize(static_cast<size_t>(inputs.size()));
+
+        int requested = (options.numThreads > 0) ? options.numThreads : juce::SystemStats::getNumCpus();
+        auto workerCount = static_cast<size_t>(juce::jlimit(1, juce::jmax(1, inputs.size()), requested));
+        report.numThreads = static_cast<int>(workerCount);
+
+        std::atomic<size_t> nextFile { 0 };
+        std::vector<std::thread> workers;
+
+        for (size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+        {
+            workers.emplace_back([&options, &inputs, &report, &nextFile]()
+            {
+                for (auto fileIndex = nextFile++; fileIndex < report.files.size(); fileIndex = nextFile++)
+                    report.files[fileIndex] = processFile(options, inputs.getReference(static_cast<int>(fileIndex)));
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        report.seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        return report;
+    }
+
+    /** Output name for one transposition variant, e.g. "song_t-2.mid". */
+    static juce::String getTransposedName(const juce::File& input, int semitones)
+    {
+        return input.getFileNameWithoutExtension() + "_t" + (semitones >= 0 ? "+" : "") + juce::String(semitones)
+               + input.getFileExtension();
+    }
+
+    /** Output name for a channel extraction, e.g. "song_ch1-10.mid". */
+    static juce::String getExtractedName(const juce::File& input, const std::vector<int>& channels)
+    {
+        juce::StringArray parts;
+        for (auto channel : channels)
+            parts.add(juce::String(channel));
+
+        return input.getFileNameWithoutExtension() + "_ch" + parts.joinIntoString("-") + input.getFileExtension();
+    }
+
+private:
+    static FileResult processFile(const Options& options, const juce::File& input)
+    {
+        FileResult result;
+        result.relativePath = input.getRelativePathFrom(options.inputDirectory);
+        auto start = juce::Time::getMillisecondCounterHiRes();
+
+        // The single parse: analysis and every output below come from this MidiFile
+        juce::MidiFile midi;
+        if (!MidiUtilities::readMidiFile(input, midi))
+        {
+            result.error = "could not read or parse";
+            return result;
+        }
+
+        result.parsed = true;
+
+        // Analysis wants seconds; the outputs keep the file's ticks
+        if (auto parsed = ParsedMidiFile::fromMidiFile(midi))
+        {
+            result.analysis = MidiUtilities::analyzeMidi(*parsed, false);
+            result.validForVsti = MidiUtilities::validateAnalysis(result.analysis, result.validationMessage);
+        }
+
+        auto outputDirectory = options.outputDirectory.getChildFile(result.relativePath).getParentDirectory();
+
+        auto write = [&result](const juce::MidiFile& output, const juce::File& file)
+        {
+            if (MidiUtilities::writeMidiFile(output, file))
+                result.filesWritten++;
+            else
+                result.writeFailures++;
+        };
+
+        if (options.transpose)
+        {
+            for (int semitones = options.transposeMin; semitones <= options.transposeMax; ++semitones)
+            {
+                if (semitones != 0)
+                    write(MidiUtilities::transposed(midi, semitones), outputDirectory.getChildFile(getTransposedName(input, semitones)));
+            }
+        }
+
+        if (!options.channels.empty())
+            write(MidiUtilities::extractChannels(midi, options.channels), outputDirectory.getChildFile(getExtractedName(input, options.channels)));
+
+        result.seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        return result;
+    }
+};
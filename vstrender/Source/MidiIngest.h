@@ -0,0 +1,340 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+//==============================================================================
+/**
+ * A MIDI file parsed once into a flat event table with times in seconds,
+ * already resolved against the file's tempo map. Analysis, validation and
+ * MIDI schedule compilation all read this one representation.
+ *
+ * Short messages are stored inline; sysex and meta events live in a byte
+ * pool. The table either owns its storage (fresh parse) or points straight
+ * into a memory-mapped binary cache file:
+ *
+ *   header (64 bytes), Event[numEvents], pool
+ *
+ * The cache is written in native byte order and only read back on the
+ * machine that wrote it; the header records the source file's size and
+ * modification time so a changed .mid is parsed again.
+ */
+class ParsedMidiFile
+{
+public:
+    ParsedMidiFile() = default;
+
+    struct Event
+    {
+        double timeInSeconds = 0.0;
+        juce::uint32 poolOffset = 0;    // data offset when size > 3
+        juce::uint32 size = 0;
+        juce::uint16 track = 0;
+        juce::uint8 bytes[3] = {};
+        juce::uint8 reserved = 0;
+    };
+
+    static_assert(sizeof(Event) == 24, "Event is part of the binary cache format");
+
+    /** Parse a .mid through a read-only mapping of the file. Null if it can't be read. */
+    static std::shared_ptr<ParsedMidiFile> parse(const juce::File& midiFile)
+    {
+        juce::MemoryMappedFile mapping(midiFile, juce::MemoryMappedFile::readOnly);
+        if (mapping.getData() == nullptr)
+        {
+            std::cerr << "Could not open MIDI file: " << midiFile.getFullPathName() << std::endl;
+            return nullptr;
+        }
+
+        juce::MemoryInputStream in(mapping.getData(), mapping.getSize(), false);
+
+        juce::MidiFile midi;
+        if (!midi.readFrom(in))
+        {
+            std::cerr << "Could not parse MIDI file: " << midiFile.getFullPathName() << std::endl;
+            return nullptr;
+        }
+
+        return fromMidiFile(std::move(midi));
+    }
+
+    /** Build the table from a MidiFile still stamped in ticks. */
+    static std::shared_ptr<ParsedMidiFile> fromMidiFile(juce::MidiFile midi)
+    {
+        auto parsed = std::make_shared<ParsedMidiFile>();
+        parsed->timeFormat = midi.getTimeFormat();
+        parsed->numTracks = midi.getNumTracks();
+
+        // Ticks to seconds through the tempo events of every track, as the file's tempo map
+        midi.convertTimestampTicksToSeconds();
+
+        for (int trackIndex = 0; trackIndex < midi.getNumTracks(); ++trackIndex)
+        {
+            const auto* track = midi.getTrack(trackIndex);
+
+            for (int eventIndex = 0; eventIndex < track->getNumEvents(); ++eventIndex)
+            {
+                const auto& message = track->getEventPointer(eventIndex)->message;
+
+                Event event;
+                event.timeInSeconds = message.getTimeStamp();
+                event.track = static_cast<juce::uint16>(trackIndex);
+                event.size = static_cast<juce::uint32>(message.getRawDataSize());
+
+                if (event.size > 3)
+                {
+                    event.poolOffset = static_cast<juce::uint32>(parsed->ownedPool.getSize());
+                    parsed->ownedPool.append(message.getRawData(), event.size);
+                }
+                else
+                {
+                    std::copy(message.getRawData(), message.getRawData() + event.size, event.bytes);
+                }
+
+                parsed->ownedEvents.push_back(event);
+                parsed->lengthInSeconds = juce::jmax(parsed->lengthInSeconds, event.timeInSeconds);
+            }
+        }
+
+        parsed->useOwnedStorage();
+        return parsed;
+    }
+
+    /** Map a cache file written by writeCache(). Null if it is missing, damaged or stale for sourceFile. */
+    static std::shared_ptr<ParsedMidiFile> openCache(const juce::File& cacheFile, const juce::File& sourceFile)
+    {
+        if (!cacheFile.existsAsFile())
+            return nullptr;
+
+        auto parsed = std::make_shared<ParsedMidiFile>();
+        parsed->mapping = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+
+        auto* base = static_cast<const char*>(parsed->mapping->getData());
+        auto mappedSize = parsed->mapping->getSize();
+
+        if (base == nullptr || mappedSize < headerSize)
+            return nullptr;
+
+        juce::MemoryInputStream header(base, headerSize, false);
+
+        if (static_cast<juce::uint32>(header.readInt()) != cacheMagic
+            || header.readInt() != static_cast<int>(sizeof(Event))
+            || header.readInt64() != sourceFile.getSize()
+            || header.readInt64() != sourceFile.getLastModificationTime().toMilliseconds())
+            return nullptr;
+
+        parsed->timeFormat = header.readInt();
+        parsed->numTracks = header.readInt();
+        parsed->lengthInSeconds = header.readDouble();
+
+        auto numEvents = static_cast<size_t>(header.readInt64());
+        auto poolSize = static_cast<size_t>(header.readInt64());
+
+        if (headerSize + numEvents * sizeof(Event) + poolSize != mappedSize)
+            return nullptr;
+
+        // The mapping is page-aligned and the header is 64 bytes, so the table can be used in place
+        parsed->events = reinterpret_cast<const Event*>(base + headerSize);
+        parsed->numEvents = numEvents;
+        parsed->pool = reinterpret_cast<const juce::uint8*>(base + headerSize + numEvents * sizeof(Event));
+        parsed->poolSize = poolSize;
+        return parsed;
+    }
+
+    /** Write the table as a cache file for sourceFile. */
+    bool writeCache(const juce::File& cacheFile, const juce::File& sourceFile) const
+    {
+        juce::MemoryOutputStream out;
+        out.writeInt(static_cast<int>(cacheMagic));
+        out.writeInt(static_cast<int>(sizeof(Event)));
+        out.writeInt64(sourceFile.getSize());
+        out.writeInt64(sourceFile.getLastModificationTime().toMilliseconds());
+        out.writeInt(timeFormat);
+        out.writeInt(numTracks);
+        out.writeDouble(lengthInSeconds);
+        out.writeInt64(static_cast<juce::int64>(numEvents));
+        out.writeInt64(static_cast<juce::int64>(poolSize));
+
+        while (out.getDataSize() < headerSize)
+            out.writeByte(0);
+
+        if (numEvents > 0)
+            out.write(events, numEvents * sizeof(Event));
+
+        if (poolSize > 0)
+            out.write(pool, poolSize);
+
+        // Written under a temporary name, so a concurrent reader never maps half a file
+        cacheFile.getParentDirectory().createDirectory();
+        juce::TemporaryFile temp(cacheFile);
+
+        if (!temp.getFile().replaceWithData(out.getData(), out.getDataSize()) || !temp.overwriteTargetFileWithTemporary())
+        {
+            std::cerr << "Could not write MIDI cache: " << cacheFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    int getTimeFormat() const               { return timeFormat; }
+    int getNumTracks() const                { return numTracks; }
+    size_t size() const                     { return numEvents; }
+    double getLengthInSeconds() const       { return lengthInSeconds; }
+    const Event& getEvent(size_t index) const { return events[index]; }
+
+    const juce::uint8* getData(const Event& event) const
+    {
+        return event.size > 3 ? pool + event.poolOffset : event.bytes;
+    }
+
+    /** The event as a MidiMessage stamped in seconds (allocates only for long messages). */
+    juce::MidiMessage getMessage(size_t index) const
+    {
+        const auto& event = events[index];
+        return juce::MidiMessage(getData(event), static_cast<int>(event.size), event.timeInSeconds);
+    }
+
+private:
+    static constexpr juce::uint32 cacheMagic = 0x3156454d;    // "MEV1"
+    static constexpr size_t headerSize = 64;
+
+    void useOwnedStorage()
+    {
+        events = ownedEvents.data();
+        numEvents = ownedEvents.size();
+        pool = static_cast<const juce::uint8*>(ownedPool.getData());
+        poolSize = ownedPool.getSize();
+    }
+
+    int timeFormat = 0;
+    int numTracks = 0;
+    double lengthInSeconds = 0.0;
+
+    const Event* events = nullptr;
+    size_t numEvents = 0;
+    const juce::uint8* pool = nullptr;
+    size_t poolSize = 0;
+
+    std::vector<Event> ownedEvents;
+    juce::MemoryBlock ownedPool;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+    JUCE_DECLARE_NON_COPYABLE(ParsedMidiFile)
+};
+
+//==============================================================================
+/**
+ * Parsed MIDI files shared by every render engine, keyed by path and
+ * modification time. With a cache directory each file is parsed once across
+ * runs: later runs map its binary cache instead of reading the .mid. An empty
+ * directory keeps the cache in memory. Engines asking for the same file wait
+ * for one load of it; loads of different files run side by side.
+ */
+class MidiIngestCache
+{
+public:
+    explicit MidiIngestCache(const juce::File& directory = {})
+        : cacheDirectory(directory)
+    {
+    }
+
+    static juce::File getDefaultDirectory()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("VSTPluginHost")
+                   .getChildFile("midi_cache");
+    }
+
+    const juce::File& getDirectory() const  { return cacheDirectory; }
+
+    /** The parsed file, or nullptr when it is missing or unreadable. */
+    std::shared_ptr<const ParsedMidiFile> get(const juce::File& midiFile)
+    {
+        if (!midiFile.existsAsFile())
+        {
+            std::cerr << "MIDI file not found: " << midiFile.getFullPathName() << std::endl;
+            return nullptr;
+        }
+
+        Key key { midiFile.getFullPathName(), midiFile.getLastModificationTime().toMilliseconds() };
+
+        // The lock only covers the lookup: the first request for a file loads
+        // it, and only later requests for that same file wait for its result
+        std::promise<std::shared_ptr<const ParsedMidiFile>> loaded;
+        std::shared_future<std::shared_ptr<const ParsedMidiFile>> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto existing = files.find(key);
+            if (existing != files.end())
+                pending = existing->second;
+            else
+                files[key] = loaded.get_future().share();
+        }
+
+        if (pending.valid())
+            return pending.get();
+
+        auto parsed = load(midiFile, key);
+        loaded.set_value(parsed);
+
+        // A failed load isn't kept, so the next request tries again
+        if (!parsed)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            files.erase(key);
+        }
+
+        return parsed;
+    }
+
+private:
+    struct Key
+    {
+        juce::String path;
+        juce::int64 modificationTime;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(path, modificationTime) < std::tie(other.path, other.modificationTime);
+        }
+    };
+
+    // From the binary cache when it is current, otherwise parsed and cached
+    std::shared_ptr<const ParsedMidiFile> load(const juce::File& midiFile, const Key& key) const
+    {
+        std::shared_ptr<ParsedMidiFile> parsed;
+        juce::File cacheFile;
+
+        if (cacheDirectory != juce::File())
+        {
+            cacheFile = cacheDirectory.getChildFile(juce::String::toHexString(key.path.hashCode64()) + ".midc");
+            parsed = ParsedMidiFile::openCache(cacheFile, midiFile);
+        }
+
+        if (!parsed)
+        {
+            parsed = ParsedMidiFile::parse(midiFile);
+            if (!parsed)
+                return nullptr;
+
+            if (cacheFile != juce::File())
+                parsed->writeCache(cacheFile, midiFile);
+        }
+
+        return parsed;
+    }
+
+    juce::File cacheDirectory;
+    std::mutex mutex;
+    std::map<Key, std::shared_future<std::shared_ptr<const ParsedMidiFile>>> files;
+};
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "MidiSchedule.h"
+#include "RenderSummary.h"
+
+//==============================================================================
+/**
+ * One short probe sequence: a chord (or single note) held for noteLength
+ * seconds, for key- and velocity-split sampling. It compiles straight into a
+ * MidiSchedule, so the render host never needs a .mid file for it.
+ */
+struct MidiProbe
+{
+    size_t index = 0;
+    int rootNote = 60;
+    int velocity = 100;
+    juce::String chordName;
+    std::vector<int> notes;
+    int channel = 1;
+    double noteLength = 1.0;
+
+    /** e.g. "C4_v96_major" */
+    juce::String getName() const
+    {
+        static const char* noteNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+        return juce::String(noteNames[rootNote % 12]) + juce::String(rootNote / 12 - 1)
+               + "_v" + juce::String(velocity) + "_" + chordName;
+    }
+
+    std::shared_ptr<MidiSchedule> compile(double sampleRate, int blockSize) const
+    {
+        auto schedule = std::make_shared<MidiSchedule>(sampleRate, blockSize);
+
+        for (auto note : notes)
+            schedule->addEvent(0.0, juce::MidiMessage::noteOn(channel, note, static_cast<juce::uint8>(velocity)));
+
+        for (auto note : notes)
+            schedule->addEvent(noteLength, juce::MidiMessage::noteOff(channel, note, static_cast<juce::uint8>(64)));
+
+        schedule->setLengthInSeconds(noteLength);
+        schedule->finalise();
+        return schedule;
+    }
+
+    /** The same sequence as a MIDI file (960 PPQ at 120 BPM). */
+    juce::MidiFile toMidiFile() const
+    {
+        constexpr int ticksPerQuarter = 960;
+        constexpr double ticksPerSecond = ticksPerQuarter * 2.0;
+
+        juce::MidiMessageSequence track;
+        track.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 0.0);
+
+        auto endTick = noteLength * ticksPerSecond;
+
+        for (auto note : notes)
+        {
+            track.addEvent(juce::MidiMessage::noteOn(channel, note, static_cast<juce::uint8>(velocity)), 0.0);
+            track.addEvent(juce::MidiMessage::noteOff(channel, note, static_cast<juce::uint8>(64)), endTick);
+        }
+
+        track.addEvent(juce::MidiMessage::endOfTrack(), endTick);
+        track.updateMatchedPairs();
+
+        juce::MidiFile midi;
+        midi.setTicksPerQuarterNote(ticksPerQuarter);
+        midi.addTrack(track);
+        return midi;
+    }
+};
+
+//==============================================================================
+/**
+ * A seeded, parameterised set of probe sequences, from a "probes" object:
+ *
+ *   "probes": {
+ *     "plugin": 0,
+ *     "mode": "grid",
+ *     "notes": { "min": 21, "max": 108, "step": 3 },
+ *     "velocities": [32, 64, 96, 127],
+ *     "chords": ["single", "major", [0, 5, 10]],
+ *     "note_length": 1.5,
+ *     "channel": 1,
+ *     "manifest": "renders/probes.csv"
+ *   }
+ *
+ * "notes" and "velocities" are lists or { min, max, step } ranges. "chords"
+ * are names (single, fifth, octave, major, minor, dim, aug, sus2, sus4, maj7,
+ * min7, dom7) or interval lists above the root; chord notes outside 0-127
+ * are dropped, and a chord with none left at some root is rejected.
+ * "grid" takes every note x velocity x chord combination (chord changing
+ * fastest); "random" draws "count" combinations. A sequence is generated from
+ * its index alone (the random draw is seeded by seed and index), so any
+ * thread can produce any sequence without building the whole set.
+ */
+class MidiProbeSet
+{
+public:
+    enum class Mode
+    {
+        grid,
+        random
+    };
+
+    struct Chord
+    {
+        juce::String name;
+        std::vector<int> intervals;
+    };
+
+    int pluginIndex = 0;
+    Mode mode = Mode::grid;
+    size_t count = 0;
+    juce::int64 seed = 1;
+    std::vector<int> notes;
+    std::vector<int> velocities;
+    std::vector<Chord> chords;
+    double noteLength = 1.0;
+    int channel = 1;
+    juce::String manifestFile;
+
+    static bool fromVar(const juce::var& json, MidiProbeSet& set, juce::String& error)
+    {
+        if (!json.isObject())
+        {
+            error = "probe set must be an object";
+            return false;
+        }
+
+        set.pluginIndex = json.getProperty("plugin", 0);
+        set.seed = static_cast<juce::int64>(json.getProperty("seed", 1));
+        set.noteLength = json.getProperty("note_length", 1.0);
+        set.channel = json.getProperty("channel", 1);
+        set.manifestFile = json.getProperty("manifest", "");
+
+        auto modeName = json.getProperty("mode", "grid").toString();
+        if (modeName.equalsIgnoreCase("grid"))
+            set.mode = Mode::grid;
+        else if (modeName.equalsIgnoreCase("random"))
+            set.mode = Mode::random;
+        else
+        {
+            error = "unknown mode '" + modeName + "'";
+            return false;
+        }
+
+        if (!parseValues(json.getProperty("notes", 60), 0, 127, set.notes, "notes", error)
+            || !parseValues(json.getProperty("velocities", 100), 1, 127, set.velocities, "velocities", error)
+            || !parseChords(json["chords"], set.chords, error))
+            return false;
+
+        // Every note x chord combination must keep at least one note, or its probe would be silent
+        for (const auto& chord : set.chords)
+        {
+            for (auto root : set.notes)
+            {
+                if (!std::any_of(chord.intervals.begin(), chord.intervals.end(),
+                                 [root] (int interval) { return isInRange(root + interval); }))
+                {
+                    error = "chord '" + chord.name + "' has no notes in 0-127 at root note " + juce::String(root);
+                    return false;
+                }
+            }
+        }
+
+        if (set.noteLength <= 0.0)
+        {
+            error = "\"note_length\" must be positive";
+            return false;
+        }
+
+        if (set.channel < 1 || set.channel > 16)
+        {
+            error = "\"channel\" must be 1-16";
+            return false;
+        }
+
+        if (set.mode == Mode::random)
+        {
+            auto requested = static_cast<juce::int64>(json.getProperty("count", 0));
+            if (requested <= 0)
+            {
+                error = "\"count\" is required for random probe sets";
+                return false;
+            }
+
+            set.count = static_cast<size_t>(requested);
+        }
+        else
+        {
+            set.count = set.notes.size() * set.velocities.size() * set.chords.size();
+        }
+
+        return true;
+    }
+
+    size_t size() const     { return count; }
+
+    MidiProbe get(size_t index) const
+    {
+        size_t noteIndex, velocityIndex, chordIndex;
+
+        if (mode == Mode::grid)
+        {
+            chordIndex = index % chords.size();
+            velocityIndex = (index / chords.size()) % velocities.size();
+            noteIndex = index / (chords.size() * velocities.size());
+        }
+        else
+        {
+            // SplitMix-style scramble, so neighbouring indexes get unrelated streams
+            auto mixed = static_cast<juce::uint64>(seed) + (static_cast<juce::uint64>(index) + 1) * 0x9e3779b97f4a7c15ull;
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ull;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebull;
+
+            juce::Random random(static_cast<juce::int64>(mixed ^ (mixed >> 31)));
+            noteIndex = static_cast<size_t>(random.nextInt(static_cast<int>(notes.size())));
+            velocityIndex = static_cast<size_t>(random.nextInt(static_cast<int>(velocities.size())));
+            chordIndex = static_cast<size_t>(random.nextInt(static_cast<int>(chords.size())));
+        }
+
+        MidiProbe probe;
+        probe.index = index;
+        probe.rootNote = notes[noteIndex];
+        probe.velocity = velocities[velocityIndex];
+        probe.chordName = chords[chordIndex].name;
+        probe.channel = channel;
+        probe.noteLength = noteLength;
+
+        for (auto interval : chords[chordIndex].intervals)
+        {
+            auto note = probe.rootNote + interval;
+            if (isInRange(note))
+                probe.notes.push_back(note);
+        }
+
+        return probe;
+    }
+
+    /**
+     * One row per probe: its index, output file and musical parameters, then
+     * the render results when jobStats is given (one entry per probe).
+     */
+    bool writeManifest(const juce::File& file, const juce::StringArray& outputFiles,
+                       const std::vector<RenderStats>& jobStats = {}) const
+    {
+        juce::StringArray header { "probe", "output_file", "name", "root_note", "velocity", "chord", "notes" };
+        if (!jobStats.empty())
+            RenderSummary::addCsvStatsHeader(header);
+
+        juce::MemoryOutputStream csv;
+        csv << header.joinIntoString(",") << "\n";
+
+        for (int probeIndex = 0; probeIndex < outputFiles.size(); ++probeIndex)
+        {
+            auto probe = get(static_cast<size_t>(probeIndex));
+
+            juce::StringArray noteList;
+            for (auto note : probe.notes)
+                noteList.add(juce::String(note));
+
+            juce::StringArray row { juce::String(probeIndex), RenderSummary::quoteCsv(outputFiles[probeIndex]), probe.getName(),
+                                    juce::String(probe.rootNote), juce::String(probe.velocity),
+                                    RenderSummary::quoteCsv(probe.chordName), noteList.joinIntoString(" ") };
+
+            if (static_cast<size_t>(probeIndex) < jobStats.size())
+                RenderSummary::addCsvStats(row, jobStats[static_cast<size_t>(probeIndex)]);
+
+            csv << row.joinIntoString(",") << "\n";
+        }
+
+        file.getParentDirectory().createDirectory();
+        if (!file.replaceWithData(csv.getData(), csv.getDataSize()))
+        {
+            std::cerr << "Could not write probe manifest: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static bool isInRange(int note)     { return note >= 0 && note <= 127; }
+
+    // A single number, a list, or a { min, max, step } range
+    static bool parseValues(const juce::var& json, int lowest, int highest, std::vector<int>& values,
+                            const juce::String& name, juce::String& error)
+    {
+        values.clear();
+
+        if (auto* list = json.getArray())
+        {
+            for (const auto& value : *list)
+                values.push_back(static_cast<int>(value));
+        }
+        else if (json.isObject())
+        {
+            int minValue = json.getProperty("min", lowest);
+            int maxValue = json.getProperty("max", highest);
+            int step = juce::jmax(1, static_cast<int>(json.getProperty("step", 1)));
+
+            for (int value = minValue; value <= maxValue; value += step)
+                values.push_back(value);
+        }
+        else
+        {
+            values.push_back(static_cast<int>(json));
+        }
+
+        for (auto value : values)
+        {
+            if (value < lowest || value > highest)
+            {
+                error = "\"" + name + "\" value " + juce::String(value) + " outside "
+                        + juce::String(lowest) + "-" + juce::String(highest);
+                return false;
+            }
+        }
+
+        if (values.empty())
+        {
+            error = "\"" + name + "\" is empty";
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool parseChords(const juce::var& json, std::vector<Chord>& chords, juce::String& error)
+    {
+        chords.clear();
+
+        if (json.isVoid())
+        {
+            chords.push_back({ "single", { 0 } });
+            return true;
+        }
+
+        auto* list = json.getArray();
+        if (list == nullptr || list->isEmpty())
+        {
+            error = "\"chords\" must be a non-empty array";
+            return false;
+        }
+
+        for (const auto& entry : *list)
+        {
+            Chord chord;
+
+            if (auto* intervals = entry.getArray())
+            {
+                juce::StringArray parts;
+                for (const auto& interval : *intervals)
+                {
+                    chord.intervals.push_back(static_cast<int>(interval));
+                    parts.add(juce::String(static_cast<int>(interval)));
+                }
+
+                chord.name = parts.joinIntoString("-");
+            }
+            else
+            {
+                chord.name = entry.toString();
+                chord.intervals = getNamedChord(chord.name);
+            }
+
+            if (chord.intervals.empty())
+            {
+                error = "unknown chord '" + chord.name + "'";
+                return false;
+            }
+
+            chords.push_back(std::move(chord));
+        }
+
+        return true;
+    }
+
+    static std::vector<int> getNamedChord(const juce::String& name)
+    {
+        if (name.equalsIgnoreCase("single")) return { 0 };
+        if (name.equalsIgnoreCase("fifth"))  return { 0, 7 };
+        if (name.equalsIgnoreCase("octave")) return { 0, 12 };
+        if (name.equalsIgnoreCase("major"))  return { 0, 4, 7 };
+        if (name.equalsIgnoreCase("minor"))  return { 0, 3, 7 };
+        if (name.equalsIgnoreCase("dim"))    return { 0, 3, 6 };
+        if (name.equalsIgnoreCase("aug"))    return { 0, 4, 8 };
+        if (name.equalsIgnoreCase("sus2"))   return { 0, 2, 7 };
+        if (name.equalsIgnoreCase("sus4"))   return { 0, 5, 7 };
+        if (name.equalsIgnoreCase("maj7"))   return { 0, 4, 7, 11 };
+        if (name.equalsIgnoreCase("min7"))   return { 0, 3, 7, 10 };
+        if (name.equalsIgnoreCase("dom7"))   return { 0, 4, 7, 10 };
+        return {};
+    }
+};
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+//==============================================================================
+/**
+ * MIDI sequence compiled for one sample rate and block size.
+ * Event times are converted to sample positions once and kept in a flat,
+ * sorted array of packed short messages; sysex payloads live in a separate
+ * byte pool. A MidiBuffer is prebuilt for every block, so the render loop only
+ * copies a ready slice into a reserved scratch buffer.
+ *
+ * A compiled schedule is immutable and can be shared between render threads.
+ */
+class MidiSchedule
+{
+public:
+    struct EventCounts
+    {
+        int total = 0;
+        int noteOns = 0;
+        int noteOffs = 0;
+    };
+
+    MidiSchedule(double sampleRateToUse, int blockSizeToUse)
+        : sampleRate(sampleRateToUse), blockSize(juce::jmax(1, blockSizeToUse))
+    {
+    }
+
+    /** Append an event. Meta events (tempo, track names...) are file structure only and are dropped. */
+    void addEvent(double timeInSeconds, const juce::MidiMessage& message)
+    {
+        if (message.isMetaEvent() || timeInSeconds < 0.0)
+            return;
+
+        Event event;
+        event.samplePosition = static_cast<juce::int64>(timeInSeconds * sampleRate);
+
+        auto* rawData = message.getRawData();
+        auto rawSize = message.getRawDataSize();
+
+        if (message.isSysEx() || rawSize > 3)
+        {
+            event.sysexOffset = static_cast<juce::uint32>(sysexPool.getSize());
+            event.sysexSize = static_cast<juce::uint32>(rawSize);
+            sysexPool.append(rawData, static_cast<size_t>(rawSize));
+        }
+        else
+        {
+            event.size = static_cast<juce::uint8>(rawSize);
+            std::copy(rawData, rawData + rawSize, event.bytes);
+        }
+
+        events.push_back(event);
+    }
+
+    void setLengthInSeconds(double newLength)    { lengthInSeconds = newLength; }
+
+    /**
+     * Sort by sample position (stable, so same-sample events keep file order)
+     * and build the per-block buffers. Call once after the last addEvent().
+     */
+    void finalise()
+    {
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event& a, const Event& b) { return a.samplePosition < b.samplePosition; });
+
+        blocks.clear();
+        maxBlockBytes = 0;
+
+        if (events.empty())
+            return;
+
+        blocks.resize(static_cast<size_t>(events.back().samplePosition / blockSize) + 1);
+
+        for (const auto& event : events)
+        {
+            auto blockIndex = static_cast<size_t>(event.samplePosition / blockSize);
+            auto offset = static_cast<int>(event.samplePosition - static_cast<juce::int64>(blockIndex) * blockSize);
+            blocks[blockIndex].addEvent(getEventData(event), getEventSize(event), offset);
+        }
+
+        for (const auto& block : blocks)
+            maxBlockBytes = juce::jmax(maxBlockBytes, static_cast<size_t>(block.data.size()));
+    }
+
+    /**
+     * Replace dest with the events in [startSample, startSample + numSamples),
+     * positioned relative to startSample. Block-aligned ranges copy the
+     * prebuilt buffer; anything else falls back to a binary search.
+     * dest keeps its capacity, so no allocation happens once it has been
+     * reserved with getMaxBlockBytes().
+     */
+    void fillBlock(juce::MidiBuffer& dest, juce::int64 startSample, int numSamples) const
+    {
+        dest.clear();
+
+        if (numSamples <= 0 || events.empty())
+            return;
+
+        if (startSample % blockSize == 0 && numSamples <= blockSize)
+        {
+            auto blockIndex = static_cast<size_t>(startSample / blockSize);
+            if (blockIndex < blocks.size())
+                dest.addEvents(blocks[blockIndex], 0, numSamples, 0);
+            return;
+        }
+
+        auto endSample = startSample + numSamples;
+        auto it = std::lower_bound(events.begin(), events.end(), startSample,
+                                   [](const Event& e, juce::int64 position) { return e.samplePosition < position; });
+
+        for (; it != events.end() && it->samplePosition < endSample; ++it)
+            dest.addEvent(getEventData(*it), getEventSize(*it), static_cast<int>(it->samplePosition - startSample));
+    }
+
+    /** Sample position of the first event at or after startSample, or -1 when there is none. */
+    juce::int64 getNextEventPosition(juce::int64 startSample) const
+    {
+        auto it = std::lower_bound(events.begin(), events.end(), startSample,
+                                   [](const Event& e, juce::int64 position) { return e.samplePosition < position; });
+
+        return it != events.end() ? it->samplePosition : -1;
+    }
+
+    /** Counts of the events that land before endSample, for the render summary. */
+    EventCounts countEventsBefore(juce::int64 endSample) const
+    {
+        EventCounts counts;
+
+        for (const auto& event : events)
+        {
+            if (event.samplePosition >= endSample)
+                break;
+
+            counts.total++;
+
+            if (event.size == 3)
+            {
+                auto status = event.bytes[0] & 0xf0;
+                if (status == 0x90 && event.bytes[2] > 0)
+                    counts.noteOns++;
+                else if (status == 0x80 || status == 0x90)
+                    counts.noteOffs++;
+            }
+        }
+
+        return counts;
+    }
+
+    /** Serialise the compiled events, e.g. into a render cache key. */
+    void writeTo(juce::OutputStream& out) const
+    {
+        out.writeDouble(sampleRate);
+        out.writeInt(blockSize);
+        out.writeDouble(lengthInSeconds);
+        out.writeInt64(static_cast<juce::int64>(events.size()));
+
+        for (const auto& event : events)
+        {
+            out.writeInt64(event.samplePosition);
+            out.write(getEventData(event), static_cast<size_t>(getEventSize(event)));
+        }
+    }
+
+    size_t getNumEvents() const             { return events.size(); }
+    juce::int64 getLastEventPosition() const { return events.empty() ? 0 : events.back().samplePosition; }
+    size_t getMaxBlockBytes() const         { return maxBlockBytes; }
+    double getLengthInSeconds() const       { return lengthInSeconds; }
+    double getSampleRate() const            { return sampleRate; }
+    int getBlockSize() const                { return blockSize; }
+
+private:
+    struct Event
+    {
+        juce::int64 samplePosition = 0;
+        juce::uint32 sysexOffset = 0;
+        juce::uint32 sysexSize = 0;     // non-zero when the message lives in sysexPool
+        juce::uint8 size = 0;
+        juce::uint8 bytes[3] = {};
+    };
+
+    const juce::uint8* getEventData(const Event& event) const
+    {
+        if (event.sysexSize > 0)
+            return static_cast<const juce::uint8*>(sysexPool.getData()) + event.sysexOffset;
+
+        return event.bytes;
+    }
+
+    static int getEventSize(const Event& event)
+    {
+        return event.sysexSize > 0 ? static_cast<int>(event.sysexSize) : event.size;
+    }
+
+    double sampleRate;
+    int blockSize;
+    double lengthInSeconds = 0.0;
+    std::vector<Event> events;
+    juce::MemoryBlock sysexPool;
+    std::vector<juce::MidiBuffer> blocks;
+    size_t maxBlockBytes = 0;
+};
+
+//==============================================================================
+/**
+ * Compiled schedules shared by every render engine in the process, keyed by
+ * MIDI file, modification time, sample rate and block size. Rendering one MIDI
+ * file against a whole bank compiles it once. The variant names a selection
+ * of the file's events (e.g. the tracks or channels one instrument plays), so
+ * the parts of one file are cached side by side. Engines asking for the same
+ * schedule wait for one compile of it; different schedules compile side by side.
+ */
+class MidiScheduleCache
+{
+public:
+    using Compiler = std::function<std::shared_ptr<MidiSchedule>()>;
+
+    /** Return the cached schedule, or run compile and keep its result. Null results are not cached. */
+    std::shared_ptr<const MidiSchedule> getOrCompile(const juce::File& midiFile, const juce::String& variant,
+                                                     double sampleRate, int blockSize, const Compiler& compile)
+    {
+        Key key { midiFile.getFullPathName(), variant, midiFile.getLastModificationTime().toMilliseconds(),
+                  sampleRate, blockSize };
+
+        // The lock only covers the lookup: the first request for a key compiles
+        // it, and only later requests for that same key wait for its result
+        std::promise<std::shared_ptr<const MidiSchedule>> compiled;
+        std::shared_future<std::shared_ptr<const MidiSchedule>> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto existing = schedules.find(key);
+            if (existing != schedules.end())
+                pending = existing->second;
+            else
+                schedules[key] = compiled.get_future().share();
+        }
+
+        if (pending.valid())
+            return pending.get();
+
+        std::shared_ptr<const MidiSchedule> schedule = compile();
+        compiled.set_value(schedule);
+
+        if (!schedule)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            schedules.erase(key);
+        }
+
+        return schedule;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        schedules.clear();
+    }
+
+private:
+    struct Key
+    {
+        juce::String path;
+        juce::String variant;
+        juce::int64 modificationTime;
+        double sampleRate;
+        int blockSize;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(path, variant, modificationTime, sampleRate, blockSize)
+                 < std::tie(other.path, other.variant, other.modificationTime, other.sampleRate, other.blockSize);
+        }
+    };
+
+    std::mutex mutex;
+    std::map<Key, std::shared_future<std::shared_ptr<const MidiSchedule>>> schedules;
+};
@@ -6,6 +6,8 @@
 #include <map>
 #include <set>
 
+#include "MidiIngest.h"
+
 //==============================================================================
 /**
  * Enhanced MIDI utilities for VSTi rendering
@@ -94,128 +96,116 @@ public:
      */
     static MidiAnalysis analyzeMidiFile(const juce::String& midiFilePath)
     {
-        MidiAnalysis analysis;
-        
         juce::File midiFile(midiFilePath);
         if (!midiFile.existsAsFile())
         {
             std::cerr << "MIDI file not found: " << midiFilePath << std::endl;
-            return analysis;
-        }
-        
-        juce::FileInputStream fileStream(midiFile);
-        if (!fileStream.openedOk())
-        {
-            std::cerr << "Could not open MIDI file: " << midiFilePath << std::endl;
-            return analysis;
-        }
-        
-        juce::MidiFile midi;
-        if (!midi.readFrom(fileStream))
-        {
-            std::cerr << "Could not parse MIDI file: " << midiFilePath << std::endl;
-            return analysis;
+            return {};
         }
+
+        auto parsed = ParsedMidiFile::parse(midiFile);
+        return parsed ? analyzeMidi(*parsed) : MidiAnalysis();
+    }
+
+    /**
+     * Analyze an already parsed file (event times are resolved against its tempo map).
+     * Batch callers pass printHeader = false and report the results themselves.
+     */
+    static MidiAnalysis analyzeMidi(const ParsedMidiFile& midi, bool printHeader = true)
+    {
+        MidiAnalysis analysis;
         
         // Basic file info
         int timeFormat = midi.getTimeFormat();
         bool isTicksPerQuarter = (timeFormat > 0);
         
-        std::cout << "MIDI File Analysis:" << std::endl;
-        std::cout << "  Time Format: " << timeFormat << (isTicksPerQuarter ? " (PPQ)" : " (SMPTE)") << std::endl;
-        std::cout << "  Tracks: " << midi.getNumTracks() << std::endl;
+        if (printHeader)
+        {
+            std::cout << "MIDI File Analysis:" << std::endl;
+            std::cout << "  Time Format: " << timeFormat << (isTicksPerQuarter ? " (PPQ)" : " (SMPTE)") << std::endl;
+            std::cout << "  Tracks: " << midi.getNumTracks() << std::endl;
+        }
         
-        // Track-by-track analysis
         double currentTempo = 120.0; // Default tempo
         int tempoEventCount = 0;
         double totalTempo = 0.0;
-        
+
         for (int trackIndex = 0; trackIndex < midi.getNumTracks(); ++trackIndex)
         {
-            const auto* track = midi.getTrack(trackIndex);
             MidiAnalysis::TrackInfo trackInfo;
             trackInfo.trackIndex = trackIndex;
-            trackInfo.eventCount = track->getNumEvents();
+            trackInfo.eventCount = 0;
             trackInfo.noteCount = 0;
             trackInfo.hasNotes = false;
             trackInfo.hasControlChanges = false;
             trackInfo.hasProgramChanges = false;
             trackInfo.hasTempoChanges = false;
+            analysis.tracks.push_back(trackInfo);
+        }
+        
+        // Events are stored track by track; each one updates its track's info
+        for (size_t eventIndex = 0; eventIndex < midi.size(); ++eventIndex)
+        {
+            const auto& event = midi.getEvent(eventIndex);
+            if (event.track >= analysis.tracks.size())
+                continue;
+
+            auto& trackInfo = analysis.tracks[event.track];
+            auto message = midi.getMessage(eventIndex);
+            double timeInSeconds = event.timeInSeconds;
             
-            // Analyze events in this track
-            for (int eventIndex = 0; eventIndex < track->getNumEvents(); ++eventIndex)
+            trackInfo.eventCount++;
+            analysis.totalEvents++;
+            analysis.totalDuration = juce::jmax(analysis.totalDuration, timeInSeconds);
+            
+            // Analyze message type
+            if (message.isNoteOn())
             {
-                const auto& midiEvent = track->getEventPointer(eventIndex);
-                const auto& message = midiEvent->message;
+                trackInfo.hasNotes = true;
+                trackInfo.noteCount++;
+                analysis.totalNotes++;
                 
-                // Convert to absolute time
-                double timeInSeconds = 0.0;
-                if (isTicksPerQuarter)
-                {
-                    // Simple conversion assuming current tempo
-                    double ticksPerSecond = (timeFormat * currentTempo) / 60.0;
-                    timeInSeconds = midiEvent->timeStamp / ticksPerSecond;
-                }
-                else
-                {
-                    // SMPTE format - direct time conversion
-                    timeInSeconds = midiEvent->timeStamp;
-                }
+                int noteNumber = message.getNoteNumber();
+                int channel = message.getChannel();
                 
-                analysis.totalEvents++;
-                analysis.totalDuration = juce::jmax(analysis.totalDuration, timeInSeconds);
+                analysis.lowestNote = juce::jmin(analysis.lowestNote, noteNumber);
+                analysis.highestNote = juce::jmax(analysis.highestNote, noteNumber);
                 
-                // Analyze message type
-                if (message.isNoteOn())
-                {
-                    trackInfo.hasNotes = true;
-                    trackInfo.noteCount++;
-                    analysis.totalNotes++;
-                    
-                    int noteNumber = message.getNoteNumber();
-                    int channel = message.getChannel();
-                    
-                    analysis.lowestNote = juce::jmin(analysis.lowestNote, noteNumber);
-                    analysis.highestNote = juce::jmax(analysis.highestNote, noteNumber);
-                    
-                    if (analysis.firstNoteTime == 0.0 || timeInSeconds < analysis.firstNoteTime)
-                        analysis.firstNoteTime = timeInSeconds;
-                    if (timeInSeconds > analysis.lastNoteTime)
-                        analysis.lastNoteTime = timeInSeconds;
-                    
-                    trackInfo.channelMask |= (1 << (channel - 1));
-                    
-                    // Update channel info
-                    auto& channelInfo = analysis.channels[channel];
-                    channelInfo.channel = channel;
-                    channelInfo.noteCount++;
-                    channelInfo.usedNotes.insert(noteNumber);
-                    channelInfo.isDrumChannel = (channel == 10); // MIDI channel 10 is typically drums
-                }
-                else if (message.isControllerOfType(7)) // Volume CC
-                {
-                    trackInfo.hasControlChanges = true;
-                }
-                else if (message.isProgramChange())
-                {
-                    trackInfo.hasProgramChanges = true;
-                    int channel = message.getChannel();
-                    analysis.channels[channel].programNumber = message.getProgramChangeNumber();
-                }
-                else if (message.isTempoMetaEvent())
-                {
-                    trackInfo.hasTempoChanges = true;
-                    currentTempo = 60000000.0 / message.getTempoSecondsPerQuarterNote();
-                    totalTempo += currentTempo;
-                    tempoEventCount++;
-                }
-                else if (message.isTrackNameEvent())
-                {
-                    trackInfo.trackName = message.getTextFromTextMetaEvent();
-                }
+                if (analysis.firstNoteTime == 0.0 || timeInSeconds < analysis.firstNoteTime)
+                    analysis.firstNoteTime = timeInSeconds;
+                if (timeInSeconds > analysis.lastNoteTime)
+                    analysis.lastNoteTime = timeInSeconds;
+                
+                trackInfo.channelMask |= (1 << (channel - 1));
+                
+                // Update channel info
+                auto& channelInfo = analysis.channels[channel];
+                channelInfo.channel = channel;
+                channelInfo.noteCount++;
+                channelInfo.usedNotes.insert(noteNumber);
+                channelInfo.isDrumChannel = (channel == 10); // MIDI channel 10 is typically drums
+            }
+            else if (message.isControllerOfType(7)) // Volume CC
+            {
+                trackInfo.hasControlChanges = true;
+            }
+            else if (message.isProgramChange())
+            {
+                trackInfo.hasProgramChanges = true;
+                int channel = message.getChannel();
+                analysis.channels[channel].programNumber = message.getProgramChangeNumber();
+            }
+            else if (message.isTempoMetaEvent())
+            {
+                trackInfo.hasTempoChanges = true;
+                currentTempo = 60.0 / message.getTempoSecondsPerQuarterNote();
+                totalTempo += currentTempo;
+                tempoEventCount++;
+            }
+            else if (message.isTrackNameEvent())
+            {
+                trackInfo.trackName = message.getTextFromTextMetaEvent();
             }
-            
-            analysis.tracks.push_back(trackInfo);
         }
         
         // Calculate average tempo
@@ -316,7 +306,16 @@ public:
      */
     static bool validateMidiForVsti(const juce::String& midiFilePath, juce::String& errorMessage)
     {
-        auto analysis = analyzeMidiFile(midiFilePath);
+        return validateAnalysis(analyzeMidiFile(midiFilePath), errorMessage);
+    }
+
+    static bool validateMidiForVsti(const ParsedMidiFile& midi, juce::String& errorMessage)
+    {
+        return validateAnalysis(analyzeMidi(midi, false), errorMessage);
+    }
+
+    static bool validateAnalysis(const MidiAnalysis& analysis, juce::String& errorMessage)
+    {
         
         if (analysis.totalEvents == 0)
         {
@@ -355,33 +354,57 @@ public:
     }
     
     /**
-     * Extract specific channels from MIDI file
+     * Read a MIDI file through a read-only mapping, keeping its tick timestamps
      */
-    static bool extractMidiChannels(const juce::String& inputPath, 
-                                   const juce::String& outputPath,
-                                   const std::vector<int>& channels)
+    static bool readMidiFile(const juce::File& inputFile, juce::MidiFile& midi)
     {
-        juce::File inputFile(inputPath);
         if (!inputFile.existsAsFile())
         {
-            std::cerr << "Input MIDI file not found: " << inputPath << std::endl;
+            std::cerr << "Input MIDI file not found: " << inputFile.getFullPathName() << std::endl;
             return false;
         }
         
-        juce::FileInputStream fileStream(inputFile);
-        if (!fileStream.openedOk())
+        juce::MemoryMappedFile mapping(inputFile, juce::MemoryMappedFile::readOnly);
+        if (mapping.getData() == nullptr)
         {
-            std::cerr << "Could not open input MIDI file: " << inputPath << std::endl;
+            std::cerr << "Could not open input MIDI file: " << inputFile.getFullPathName() << std::endl;
             return false;
         }
         
-        juce::MidiFile inputMidi;
-        if (!inputMidi.readFrom(fileStream))
+        juce::MemoryInputStream stream(mapping.getData(), mapping.getSize(), false);
+        if (!midi.readFrom(stream))
         {
-            std::cerr << "Could not parse input MIDI file: " << inputPath << std::endl;
+            std::cerr << "Could not parse input MIDI file: " << inputFile.getFullPathName() << std::endl;
             return false;
         }
         
+        return true;
+    }
+    
+    /**
+     * Write a MIDI file, creating its directory
+     */
+    static bool writeMidiFile(const juce::MidiFile& midi, const juce::File& outputFile)
+    {
+        outputFile.getParentDirectory().createDirectory();
+        
+        juce::FileOutputStream outputStream(outputFile);
+        if (!outputStream.openedOk())
+        {
+            std::cerr << "Could not create output MIDI file: " << outputFile.getFullPathName() << std::endl;
+            return false;
+        }
+        
+        outputStream.setPosition(0);
+        outputStream.truncate();
+        return midi.writeTo(outputStream);
+    }
+    
+    /**
+     * Copy of a MIDI file keeping only the given channels (plus non-channel events)
+     */
+    static juce::MidiFile extractChannels(const juce::MidiFile& inputMidi, const std::vector<int>& channels)
+    {
         juce::MidiFile outputMidi;
         outputMidi.setTicksPerQuarterNote(inputMidi.getTimeFormat());
         
@@ -417,69 +440,14 @@ public:
             }
         }
         
-        // Write output file
-        juce::File outputFile(outputPath);
-        outputFile.getParentDirectory().createDirectory();
-        
-        juce::FileOutputStream outputStream(outputFile);
-        if (!outputStream.openedOk())
-        {
-            std::cerr << "Could not create output MIDI file: " << outputPath << std::endl;
-            return false;
-        }
-        
-        bool success = outputMidi.writeTo(outputStream);
-        if (success)
-        {
-            std::cout << "Extracted MIDI channels to: " << outputPath << std::endl;
-            std::cout << "  Input tracks: " << inputMidi.getNumTracks() << std::endl;
-            std::cout << "  Output tracks: " << outputMidi.getNumTracks() << std::endl;
-            std::cout << "  Extracted channels: ";
-            for (size_t i = 0; i < channels.size(); ++i)
-            {
-                std::cout << channels[i];
-                if (i < channels.size() - 1) std::cout << ", ";
-            }
-            std::cout << std::endl;
-        }
-        
-        return success;
+        return outputMidi;
     }
     
     /**
-     * Transpose MIDI file by semitones
+     * Copy of a MIDI file with its notes moved by semitones (drum channel untouched)
      */
-    static bool transposeMidi(const juce::String& inputPath, 
-                             const juce::String& outputPath,
-                             int semitones)
+    static juce::MidiFile transposed(const juce::MidiFile& inputMidi, int semitones)
     {
-        if (semitones < -48 || semitones > 48)
-        {
-            std::cerr << "Transpose amount out of range (-48 to +48): " << semitones << std::endl;
-            return false;
-        }
-        
-        juce::File inputFile(inputPath);
-        if (!inputFile.existsAsFile())
-        {
-            std::cerr << "Input MIDI file not found: " << inputPath << std::endl;
-            return false;
-        }
-        
-        juce::FileInputStream fileStream(inputFile);
-        if (!fileStream.openedOk())
-        {
-            std::cerr << "Could not open input MIDI file: " << inputPath << std::endl;
-            return false;
-        }
-        
-        juce::MidiFile inputMidi;
-        if (!inputMidi.readFrom(fileStream))
-        {
-            std::cerr << "Could not parse input MIDI file: " << inputPath << std::endl;
-            return false;
-        }
-        
         juce::MidiFile outputMidi;
         outputMidi.setTicksPerQuarterNote(inputMidi.getTimeFormat());
         
@@ -512,18 +480,58 @@ public:
             outputMidi.addTrack(outputTrack);
         }
         
-        // Write output file
-        juce::File outputFile(outputPath);
-        outputFile.getParentDirectory().createDirectory();
+        return outputMidi;
+    }
+    
+    /**
+     * Extract specific channels from MIDI file
+     */
+    static bool extractMidiChannels(const juce::String& inputPath, 
+                                   const juce::String& outputPath,
+                                   const std::vector<int>& channels)
+    {
+        juce::MidiFile inputMidi;
+        if (!readMidiFile(juce::File(inputPath), inputMidi))
+            return false;
         
-        juce::FileOutputStream outputStream(outputFile);
-        if (!outputStream.openedOk())
+        auto outputMidi = extractChannels(inputMidi, channels);
+        
+        bool success = writeMidiFile(outputMidi, juce::File(outputPath));
+        if (success)
+        {
+            std::cout << "Extracted MIDI channels to: " << outputPath << std::endl;
+            std::cout << "  Input tracks: " << inputMidi.getNumTracks() << std::endl;
+            std::cout << "  Output tracks: " << outputMidi.getNumTracks() << std::endl;
+            std::cout << "  Extracted channels: ";
+            for (size_t i = 0; i < channels.size(); ++i)
+            {
+                std::cout << channels[i];
+                if (i < channels.size() - 1) std::cout << ", ";
+            }
+            std::cout << std::endl;
+        }
+        
+        return success;
+    }
+    
+    /**
+     * Transpose MIDI file by semitones
+     */
+    static bool transposeMidi(const juce::String& inputPath, 
+                             const juce::String& outputPath,
+                             int semitones)
+    {
+        if (semitones < -48 || semitones > 48)
         {
-            std::cerr << "Could not create output MIDI file: " << outputPath << std::endl;
+            std::cerr << "Transpose amount out of range (-48 to +48): " << semitones << std::endl;
             return false;
         }
         
-        bool success = outputMidi.writeTo(outputStream);
+        juce::MidiFile inputMidi;
+        if (!readMidiFile(juce::File(inputPath), inputMidi))
+            return false;
+        
+        bool success = writeMidiFile(transposed(inputMidi, semitones), juce::File(outputPath));
         if (success)
         {
             std::cout << "Transposed MIDI file saved to: " << outputPath << std::endl;
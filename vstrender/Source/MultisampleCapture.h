@@ -0,0 +1,370 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "MidiProbeSet.h"
+#include "MidiSchedule.h"
+
+//==============================================================================
+/**
+ * Captures an instrument patch as a multisample (key x velocity x round
+ * robin), from a "multisample" object:
+ *
+ *   "multisample": {
+ *     "plugin": 0,
+ *     "layout": "zones",
+ *     "notes": { "min": 24, "max": 96, "step": 3 },
+ *     "velocities": [40, 80, 127],
+ *     "hold": 2.0,
+ *     "release_tail": 4.0,
+ *     "tail_threshold_db": -70.0
+ *   }
+ *
+ * "zones" renders every zone as its own batch job on the warm instances
+ * (state restored and reset() between notes, auto tail ending each note
+ * once its release has died away) into <output>_<note>_v<velocity>.
+ * "continuous" plays all zones back to back into output_file, one slot of
+ * hold + release_tail seconds each, and the slot ends are trimmed where the
+ * tail falls below the threshold. Either way an .sfz and a .json mapping are
+ * written next to output_file.
+ *
+ * "round_robin" takes need the continuous layout: there each take plays on
+ * from where the previous slot left the instrument. A zones job starts from
+ * the same restored state with the same MIDI every time, so its takes would
+ * be sample-identical copies.
+ *
+ * Each sampled note covers the keys up to half way to its neighbours; a
+ * velocity layer covers the velocities above the layer below it.
+ */
+class MultisampleCapture
+{
+public:
+    enum class Layout
+    {
+        zones,
+        continuous
+    };
+
+    struct Zone
+    {
+        size_t index = 0;
+        int note = 60;
+        int velocity = 100;
+        int roundRobin = 0;
+        int lowKey = 0, highKey = 127;
+        int lowVelocity = 1, highVelocity = 127;
+    };
+
+    /** Where one zone's audio ended up. end is inclusive, as in SFZ; -1 = to the end of the file. */
+    struct Region
+    {
+        juce::File sampleFile;
+        juce::int64 offset = 0;
+        juce::int64 end = -1;
+        bool rendered = false;
+    };
+
+    int pluginIndex = 0;
+    Layout layout = Layout::zones;
+    std::vector<int> notes;
+    std::vector<int> velocities;
+    int roundRobins = 1;
+    double holdSeconds = 1.0;
+    double tailSeconds = 2.0;
+    float tailThresholdDb = -70.0f;
+    int channel = 1;
+
+    static bool fromVar(const juce::var& json, MultisampleCapture& capture, juce::String& error)
+    {
+        if (!json.isObject())
+        {
+            error = "multisample must be an object";
+            return false;
+        }
+
+        capture.pluginIndex = json.getProperty("plugin", 0);
+        capture.roundRobins = json.getProperty("round_robin", 1);
+        capture.holdSeconds = json.getProperty("hold", 1.0);
+        capture.tailSeconds = json.getProperty("release_tail", 2.0);
+        capture.tailThresholdDb = static_cast<float>(json.getProperty("tail_threshold_db", -70.0));
+        capture.channel = json.getProperty("channel", 1);
+
+        auto layoutName = json.getProperty("layout", "zones").toString();
+        if (layoutName.equalsIgnoreCase("zones"))
+            capture.layout = Layout::zones;
+        else if (layoutName.equalsIgnoreCase("continuous"))
+            capture.layout = Layout::continuous;
+        else
+        {
+            error = "unknown layout '" + layoutName + "'";
+            return false;
+        }
+
+        // Notes and velocities take the same forms as in a probe set
+        juce::var probeJson(new juce::DynamicObject());
+        probeJson.getDynamicObject()->setProperty("notes", json.getProperty("notes", 60));
+        probeJson.getDynamicObject()->setProperty("velocities", json.getProperty("velocities", 100));
+        probeJson.getDynamicObject()->setProperty("channel", capture.channel);
+
+        MidiProbeSet probes;
+        if (!MidiProbeSet::fromVar(probeJson, probes, error))
+            return false;
+
+        capture.notes = probes.notes;
+        capture.velocities = probes.velocities;
+
+        for (auto* values : { &capture.notes, &capture.velocities })
+        {
+            std::sort(values->begin(), values->end());
+            values->erase(std::unique(values->begin(), values->end()), values->end());
+        }
+
+        if (capture.roundRobins < 1 || capture.holdSeconds <= 0.0 || capture.tailSeconds < 0.0)
+        {
+            error = "\"round_robin\" must be at least 1, \"hold\" positive and \"release_tail\" not negative";
+            return false;
+        }
+
+        if (capture.roundRobins > 1 && capture.layout == Layout::zones)
+        {
+            error = "\"round_robin\" needs \"layout\": \"continuous\"; zones render every take from the same state";
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Every zone, by note, then velocity, then round robin. */
+    std::vector<Zone> getZones() const
+    {
+        std::vector<Zone> zones;
+
+        for (size_t noteIndex = 0; noteIndex < notes.size(); ++noteIndex)
+        {
+            for (size_t velocityIndex = 0; velocityIndex < velocities.size(); ++velocityIndex)
+            {
+                for (int roundRobin = 0; roundRobin < roundRobins; ++roundRobin)
+                {
+                    Zone zone;
+                    zone.index = zones.size();
+                    zone.note = notes[noteIndex];
+                    zone.velocity = velocities[velocityIndex];
+                    zone.roundRobin = roundRobin;
+                    zone.lowKey = noteIndex == 0 ? 0 : (notes[noteIndex - 1] + zone.note) / 2 + 1;
+                    zone.highKey = noteIndex + 1 == notes.size() ? 127 : (zone.note + notes[noteIndex + 1]) / 2;
+                    zone.lowVelocity = velocityIndex == 0 ? 1 : velocities[velocityIndex - 1] + 1;
+                    zone.highVelocity = velocityIndex + 1 == velocities.size() ? 127 : zone.velocity;
+                    zones.push_back(zone);
+                }
+            }
+        }
+
+        return zones;
+    }
+
+    double getSlotLength() const        { return holdSeconds + tailSeconds; }
+
+    /** A zones-layout job's "midi_probe": the zone's note held for holdSeconds. */
+    juce::var createProbeJson(const Zone& zone) const
+    {
+        juce::var probeJson(new juce::DynamicObject());
+        probeJson.getDynamicObject()->setProperty("notes", zone.note);
+        probeJson.getDynamicObject()->setProperty("velocities", zone.velocity);
+        probeJson.getDynamicObject()->setProperty("note_length", holdSeconds);
+        probeJson.getDynamicObject()->setProperty("channel", channel);
+        return probeJson;
+    }
+
+    /** Output file of one zone in the zones layout, next to baseFile. */
+    juce::File getZoneFile(const juce::File& baseFile, const Zone& zone) const
+    {
+        auto name = baseFile.getFileNameWithoutExtension() + "_" + juce::String(zone.note).paddedLeft('0', 3)
+                    + "_v" + juce::String(zone.velocity).paddedLeft('0', 3);
+
+        return baseFile.getSiblingFile(name + baseFile.getFileExtension());
+    }
+
+    /** The continuous layout: every zone in its own slot, one after the other. */
+    std::shared_ptr<MidiSchedule> compileContinuous(double sampleRate, int blockSize) const
+    {
+        auto schedule = std::make_shared<MidiSchedule>(sampleRate, blockSize);
+        auto zones = getZones();
+
+        for (const auto& zone : zones)
+        {
+            auto start = getSlotStart(zone, sampleRate) / sampleRate;
+            schedule->addEvent(start, juce::MidiMessage::noteOn(channel, zone.note, static_cast<juce::uint8>(zone.velocity)));
+            schedule->addEvent(start + holdSeconds, juce::MidiMessage::noteOff(channel, zone.note, static_cast<juce::uint8>(64)));
+        }
+
+        schedule->setLengthInSeconds(static_cast<double>(zones.size()) * getSlotLength());
+        schedule->finalise();
+        return schedule;
+    }
+
+    /** First sample of a zone's slot in the continuous layout. */
+    juce::int64 getSlotStart(const Zone& zone, double sampleRate) const
+    {
+        return static_cast<juce::int64>(static_cast<double>(zone.index) * getSlotLength() * sampleRate);
+    }
+
+    /**
+     * Regions of a continuous render: each slot, trimmed a few milliseconds
+     * after the last sample above the tail threshold.
+     */
+    std::vector<Region> sliceContinuous(const juce::File& renderFile) const
+    {
+        auto zones = getZones();
+        std::vector<Region> regions(zones.size());
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(renderFile));
+
+        if (reader == nullptr)
+        {
+            std::cerr << "Could not read multisample render: " << renderFile.getFullPathName() << std::endl;
+            return regions;
+        }
+
+        auto sampleRate = reader->sampleRate;
+        auto threshold = juce::Decibels::decibelsToGain(tailThresholdDb);
+        auto margin = static_cast<juce::int64>(0.01 * sampleRate);
+        juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels), 8192);
+
+        for (size_t zoneIndex = 0; zoneIndex < zones.size(); ++zoneIndex)
+        {
+            auto& region = regions[zoneIndex];
+            region.sampleFile = renderFile;
+            region.offset = getSlotStart(zones[zoneIndex], sampleRate);
+
+            auto slotEnd = juce::jmin(reader->lengthInSamples,
+                                      zoneIndex + 1 < zones.size() ? getSlotStart(zones[zoneIndex + 1], sampleRate)
+                                                                   : reader->lengthInSamples);
+            if (slotEnd <= region.offset)
+                continue;
+
+            // The hold always stays; only the release is trimmed
+            auto lastAudible = juce::jmin(slotEnd - 1, region.offset + static_cast<juce::int64>(holdSeconds * sampleRate));
+
+            for (auto position = region.offset; position < slotEnd; position += buffer.getNumSamples())
+            {
+                auto numSamples = static_cast<int>(juce::jmin<juce::int64>(buffer.getNumSamples(), slotEnd - position));
+                reader->read(&buffer, 0, numSamples, position, true, true);
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                {
+                    auto* samples = buffer.getReadPointer(ch);
+                    for (int i = numSamples; --i >= 0;)
+                    {
+                        if (std::abs(samples[i]) > threshold)
+                        {
+                            lastAudible = juce::jmax(lastAudible, position + i);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            region.end = juce::jmin(slotEnd - 1, lastAudible + margin);
+            region.rendered = true;
+        }
+
+        return regions;
+    }
+
+    /** Write <base>.sfz and <base>.json for the captured regions (one per zone). */
+    bool writeMetadata(const juce::File& baseFile, const std::vector<Region>& regions, double sampleRate) const
+    {
+        auto zones = getZones();
+        auto sfzFile = baseFile.withFileExtension(".sfz");
+        auto mappingFile = baseFile.withFileExtension(".json");
+
+        juce::MemoryOutputStream sfz;
+        sfz << "// " << baseFile.getFileNameWithoutExtension() << ": " << static_cast<int>(notes.size()) << " notes x "
+            << static_cast<int>(velocities.size()) << " velocity layers x " << roundRobins << " round robin(s)\n\n";
+        sfz << "<control>\n<global>\n";
+        sfz << "ampeg_release=" << juce::String(tailSeconds, 3) << "\n\n";
+
+        juce::Array<juce::var> zoneList;
+        int rendered = 0;
+
+        for (size_t zoneIndex = 0; zoneIndex < zones.size() && zoneIndex < regions.size(); ++zoneIndex)
+        {
+            const auto& zone = zones[zoneIndex];
+            const auto& region = regions[zoneIndex];
+            auto samplePath = region.sampleFile.getRelativePathFrom(sfzFile.getParentDirectory()).replace("\\", "/");
+
+            juce::var zoneJson(new juce::DynamicObject());
+            auto* object = zoneJson.getDynamicObject();
+            object->setProperty("zone", static_cast<int>(zone.index));
+            object->setProperty("file", samplePath);
+            object->setProperty("note", zone.note);
+            object->setProperty("velocity", zone.velocity);
+            object->setProperty("round_robin", zone.roundRobin + 1);
+            object->setProperty("lokey", zone.lowKey);
+            object->setProperty("hikey", zone.highKey);
+            object->setProperty("lovel", zone.lowVelocity);
+            object->setProperty("hivel", zone.highVelocity);
+            object->setProperty("offset", region.offset);
+            object->setProperty("end", region.end);
+            object->setProperty("rendered", region.rendered);
+            zoneList.add(zoneJson);
+
+            // A zone that failed to render is listed in the mapping but left out of the instrument
+            if (!region.rendered)
+                continue;
+
+            rendered++;
+            sfz << "<region> sample=" << samplePath
+                << " lokey=" << zone.lowKey << " hikey=" << zone.highKey << " pitch_keycenter=" << zone.note
+                << " lovel=" << zone.lowVelocity << " hivel=" << zone.highVelocity;
+
+            if (roundRobins > 1)
+                sfz << " seq_length=" << roundRobins << " seq_position=" << (zone.roundRobin + 1);
+
+            if (region.offset > 0)
+                sfz << " offset=" << region.offset;
+
+            if (region.end >= 0)
+                sfz << " end=" << region.end;
+
+            sfz << "\n";
+        }
+
+        juce::var mapping(new juce::DynamicObject());
+        auto* object = mapping.getDynamicObject();
+        object->setProperty("name", baseFile.getFileNameWithoutExtension());
+        object->setProperty("layout", layout == Layout::zones ? "zones" : "continuous");
+        object->setProperty("sample_rate", sampleRate);
+        object->setProperty("hold_seconds", holdSeconds);
+        object->setProperty("release_tail_seconds", tailSeconds);
+        object->setProperty("round_robins", roundRobins);
+        object->setProperty("zones_rendered", rendered);
+        object->setProperty("zones", zoneList);
+
+        sfzFile.getParentDirectory().createDirectory();
+
+        if (!sfzFile.replaceWithData(sfz.getData(), sfz.getDataSize()))
+        {
+            std::cerr << "Could not write SFZ file: " << sfzFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        if (!mappingFile.replaceWithText(juce::JSON::toString(mapping)))
+        {
+            std::cerr << "Could not write multisample mapping: " << mappingFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        std::cout << "Multisample: " << rendered << " of " << zones.size() << " zones mapped in "
+                  << sfzFile.getFullPathName() << std::endl;
+        return true;
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+/**
+ * Post-processing of one output file, from keys of the job or of an
+ * "outputs" entry:
+ *
+ *   "gain_db": -3.0,
+ *   "normalize": { "mode": "lufs", "target": -16.0 },
+ *   "dither": true
+ *
+ * "normalize" is "peak" (target in dBFS, default -1), "lufs" (integrated
+ * loudness, default -16 LUFS) or an object with "mode" and "target"; loudness
+ * normalisation never lifts the peak above 0 dBFS. gain_db is applied on top.
+ * "dither" adds TPDF dither with first-order noise shaping before 16- and
+ * 24-bit files are quantised; "tpdf" leaves the dither flat. Float files are
+ * never dithered.
+ */
+struct OutputProcessing
+{
+    enum class Normalize
+    {
+        none,
+        peak,
+        loudness
+    };
+
+    enum class Dither
+    {
+        none,
+        tpdf,
+        shaped
+    };
+
+    float gainDb = 0.0f;
+    Normalize normalize = Normalize::none;
+    float normalizeTarget = -1.0f;
+    Dither dither = Dither::none;
+
+    bool isActive() const           { return gainDb != 0.0f || normalize != Normalize::none || dither != Dither::none; }
+
+    /** Normalising needs the level of the whole output before the first sample is written. */
+    bool needsWholeOutput() const   { return normalize != Normalize::none; }
+
+    /** Reads the keys present in json; the others keep the values of defaults. */
+    static bool fromVar(const juce::var& json, const OutputProcessing& defaults, OutputProcessing& processing,
+                        juce::String& error)
+    {
+        processing = defaults;
+
+        if (json.hasProperty("gain_db"))
+            processing.gainDb = static_cast<float>(json["gain_db"]);
+
+        if (json.hasProperty("normalize"))
+        {
+            auto normalizeJson = json["normalize"];
+            auto modeName = normalizeJson.isObject() ? normalizeJson["mode"].toString() : normalizeJson.toString();
+
+            if (normalizeJson.isBool() && !static_cast<bool>(normalizeJson))
+                processing.normalize = Normalize::none;
+            else if (modeName.equalsIgnoreCase("peak") || normalizeJson.isBool())
+                processing.normalize = Normalize::peak;
+            else if (modeName.equalsIgnoreCase("lufs") || modeName.equalsIgnoreCase("loudness"))
+                processing.normalize = Normalize::loudness;
+            else
+            {
+                error = "unknown normalize mode '" + modeName + "'";
+                return false;
+            }
+
+            auto defaultTarget = processing.normalize == Normalize::loudness ? -16.0 : -1.0;
+            processing.normalizeTarget = static_cast<float>(normalizeJson.getProperty("target", defaultTarget));
+        }
+
+        if (json.hasProperty("dither"))
+        {
+            auto ditherJson = json["dither"];
+
+            if (ditherJson.isBool())
+                processing.dither = static_cast<bool>(ditherJson) ? Dither::shaped : Dither::none;
+            else if (ditherJson.toString().equalsIgnoreCase("tpdf"))
+                processing.dither = Dither::tpdf;
+            else if (ditherJson.toString().equalsIgnoreCase("shaped"))
+                processing.dither = Dither::shaped;
+            else if (ditherJson.toString().equalsIgnoreCase("none"))
+                processing.dither = Dither::none;
+            else
+            {
+                error = "unknown dither '" + ditherJson.toString() + "'";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Part of the render cache key of a processed output. */
+    void writeTo(juce::OutputStream& out) const
+    {
+        out.writeFloat(gainDb);
+        out.writeInt(static_cast<int>(normalize));
+        out.writeFloat(normalizeTarget);
+        out.writeInt(static_cast<int>(dither));
+    }
+
+    juce::String getDescription() const
+    {
+        juce::StringArray parts;
+
+        if (normalize == Normalize::peak)
+            parts.add("peak normalised to " + juce::String(normalizeTarget, 1) + " dBFS");
+        else if (normalize == Normalize::loudness)
+            parts.add("loudness normalised to " + juce::String(normalizeTarget, 1) + " LUFS");
+
+        if (gainDb != 0.0f)
+            parts.add(juce::String(gainDb, 1) + " dB gain");
+
+        if (dither == Dither::shaped)
+            parts.add("noise-shaped TPDF dither");
+        else if (dither == Dither::tpdf)
+            parts.add("TPDF dither");
+
+        return parts.joinIntoString(", ");
+    }
+};
+
+//==============================================================================
+/**
+ * Applies gain and dither to blocks just before the writer packs them. Gain
+ * alone goes through FloatVectorOperations (SSE/NEON in JUCE) on the float
+ * block. Dithered output is quantised here, in double precision, straight to
+ * the output's integer codes, left-justified in 32 bits as
+ * AudioFormatWriter::write(const int**) takes them: the writer only shifts
+ * them down, so every code reaches the file as computed. Going back through
+ * floats would not work, because JUCE scales floats by 2^31 - 1 rather than
+ * 2^31 and codes from half scale upwards would come out one LSB low.
+ *
+ * The dither noise comes from a fixed-seed generator, so a render written
+ * twice is bit-identical (as the render cache expects).
+ */
+class OutputPostProcessor
+{
+public:
+    void prepare(OutputProcessing::Dither ditherToUse, int numChannels, int bitDepth)
+    {
+        ditherMode = (bitDepth == 16 || bitDepth == 24) ? ditherToUse : OutputProcessing::Dither::none;
+        scale = std::ldexp(1.0, bitDepth - 1);
+        justify = std::ldexp(1.0, 32 - bitDepth);
+        errors.assign(static_cast<size_t>(numChannels), 0.0);
+        randomState = 0x2545f4914f6cdd1dull;
+        gain = 1.0f;
+    }
+
+    void setGain(float newGain)     { gain = newGain; }
+    float getGain() const           { return gain; }
+
+    bool isActive() const           { return gain != 1.0f || isDithering(); }
+    bool isDithering() const        { return ditherMode != OutputProcessing::Dither::none; }
+
+    /** Gain in place, for outputs that aren't dithered. */
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        if (gain == 1.0f)
+            return;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch, startSample), gain, numSamples);
+    }
+
+    /** Gain and dither into left-justified 32-bit codes, one array per channel of buffer. */
+    void processToInts(const juce::AudioBuffer<float>& buffer, int numSamples, int* const* destChannels)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            dither(buffer.getReadPointer(ch), destChannels[ch], numSamples, errors[static_cast<size_t>(ch)]);
+    }
+
+private:
+    // Error feedback runs sample by sample, so this loop is scalar by nature. It
+    // runs in double: at 24 bits a float near full scale has no bits left below
+    // the LSB, which would turn the dither into plain truncation.
+    void dither(const float* samples, int* dest, int numSamples, double& error)
+    {
+        const bool shaped = ditherMode == OutputProcessing::Dither::shaped;
+        const auto maxLevel = scale - 1.0;
+        const auto sampleGain = static_cast<double>(gain) * scale;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // First-order shaping: the previous error is subtracted, pushing the noise towards Nyquist
+            auto wanted = static_cast<double>(samples[i]) * sampleGain - (shaped ? error : 0.0);
+            auto noise = nextUniform() + nextUniform();     // triangular, +-1 LSB
+            auto quantised = juce::jlimit(-scale, maxLevel, std::floor(wanted + noise + 0.5));
+
+            error = quantised - wanted;
+            dest[i] = static_cast<int>(quantised * justify);
+        }
+    }
+
+    // xorshift64*, uniform in [-0.5, 0.5)
+    double nextUniform()
+    {
+        randomState ^= randomState >> 12;
+        randomState ^= randomState << 25;
+        randomState ^= randomState >> 27;
+        auto value = static_cast<juce::uint32>((randomState * 0x2545f4914f6cdd1dull) >> 40);
+        return static_cast<double>(value) * (1.0 / 16777216.0) - 0.5;
+    }
+
+    OutputProcessing::Dither ditherMode = OutputProcessing::Dither::none;
+    double scale = 32768.0;
+    double justify = 65536.0;
+    float gain = 1.0f;
+    std::vector<double> errors;
+    juce::uint64 randomState = 0;
+};
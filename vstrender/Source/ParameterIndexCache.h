@@ -0,0 +1,175 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/**
+ * Parameter names of one plugin with hash lookups, so config names resolve
+ * without asking the plugin for every parameter's name. Immutable once
+ * built and shared between render engines.
+ */
+class ParameterIndex
+{
+public:
+    explicit ParameterIndex(std::vector<juce::String> namesToUse)
+        : names(std::move(namesToUse))
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            // The first of several parameters with one name wins, as with a linear search
+            byName.emplace(names[i], static_cast<int>(i));
+            byFoldedName.emplace(names[i].toLowerCase(), static_cast<int>(i));
+        }
+    }
+
+    /**
+     * Index of the parameter a config name refers to: an exact match, then a
+     * case-insensitive one, then the first name containing it. -1 if none.
+     */
+    int find(const juce::String& name) const
+    {
+        auto exact = byName.find(name);
+        if (exact != byName.end())
+            return exact->second;
+
+        auto folded = byFoldedName.find(name.toLowerCase());
+        if (folded != byFoldedName.end())
+            return folded->second;
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (names[i].containsIgnoreCase(name))
+                return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    int size() const                            { return static_cast<int>(names.size()); }
+    const juce::String& getName(int index) const { return names[static_cast<size_t>(index)]; }
+
+private:
+    std::vector<juce::String> names;
+    std::unordered_map<juce::String, int> byName;
+    std::unordered_map<juce::String, int> byFoldedName;
+};
+
+//==============================================================================
+/**
+ * Persistent parameter indexes keyed by plugin identifier and version, saved
+ * as XML like the plugin scan cache. A plugin's names are read from the
+ * instance once; later loads only compare the parameter count. An empty file
+ * keeps the cache in memory.
+ */
+class ParameterIndexCache
+{
+public:
+    explicit ParameterIndexCache(const juce::File& file = {})
+        : cacheFile(file)
+    {
+        load();
+    }
+
+    static juce::File getDefaultCacheFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("VSTPluginHost")
+                   .getChildFile("parameter_index_cache.xml");
+    }
+
+    const juce::File& getFile() const   { return cacheFile; }
+
+    /** The index for a plugin instance, read from the plugin on a miss. */
+    std::shared_ptr<const ParameterIndex> getIndex(juce::AudioPluginInstance& plugin)
+    {
+        auto key = createKey(plugin);
+        const auto& params = plugin.getParameters();
+
+        const juce::ScopedLock sl(lock);
+
+        auto entry = indexes.find(key);
+        if (entry != indexes.end() && entry->second->size() == params.size())
+            return entry->second;
+
+        std::vector<juce::String> names;
+        names.reserve(static_cast<size_t>(params.size()));
+
+        for (auto* param : params)
+            names.push_back(param->getName(256));
+
+        auto index = std::make_shared<const ParameterIndex>(std::move(names));
+        indexes[key] = index;
+        dirty = true;
+        return index;
+    }
+
+    /** Write the cache back to disk if anything changed. */
+    bool save()
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (!dirty || cacheFile == juce::File())
+            return true;
+
+        juce::XmlElement root("PARAMETERINDEXCACHE");
+        root.setAttribute("version", 1);
+
+        for (const auto& [key, index] : indexes)
+        {
+            auto* pluginElement = root.createNewChildElement("PLUGIN");
+            pluginElement->setAttribute("key", key);
+
+            for (int i = 0; i < index->size(); ++i)
+                pluginElement->createNewChildElement("PARAM")->setAttribute("name", index->getName(i));
+        }
+
+        cacheFile.getParentDirectory().createDirectory();
+
+        if (!root.writeTo(cacheFile))
+        {
+            std::cerr << "Could not write parameter index cache: " << cacheFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        dirty = false;
+        return true;
+    }
+
+private:
+    static juce::String createKey(juce::AudioPluginInstance& plugin)
+    {
+        auto description = plugin.getPluginDescription();
+        return description.createIdentifierString() + "|" + description.version;
+    }
+
+    void load()
+    {
+        if (!cacheFile.existsAsFile())
+            return;
+
+        auto root = juce::XmlDocument::parse(cacheFile);
+        if (!root || !root->hasTagName("PARAMETERINDEXCACHE") || root->getIntAttribute("version") != 1)
+            return;
+
+        for (auto* pluginElement : root->getChildWithTagNameIterator("PLUGIN"))
+        {
+            std::vector<juce::String> names;
+
+            for (auto* paramElement : pluginElement->getChildWithTagNameIterator("PARAM"))
+                names.push_back(paramElement->getStringAttribute("name"));
+
+            indexes[pluginElement->getStringAttribute("key")] = std::make_shared<const ParameterIndex>(std::move(names));
+        }
+    }
+
+    juce::File cacheFile;
+    std::map<juce::String, std::shared_ptr<const ParameterIndex>> indexes;
+    juce::CriticalSection lock;
+    bool dirty = false;
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "RenderSummary.h"
+
+//==============================================================================
+/**
+ * A parameter-space sweep, from a "sweep" object:
+ *
+ *   "sweep": {
+ *     "plugin": 0,
+ *     "mode": "lhs",
+ *     "points": 200,
+ *     "seed": 7,
+ *     "manifest": "renders/sweep.csv",
+ *     "parameters": [
+ *       { "parameter": "Cutoff", "min": 0.1, "max": 0.9, "steps": 5 },
+ *       { "parameter": 12, "values": [0.0, 0.5, 1.0] }
+ *     ]
+ *   }
+ *
+ * "parameter" is a name (matched like "parameters") or an index. "grid" takes
+ * every combination of the dimensions' steps or values; "random" and "lhs"
+ * (Latin hypercube: every dimension split into "points" equal strata, each
+ * used once) draw "points" values from [min, max], or pick from "values".
+ * The seed makes the point set reproducible.
+ */
+class ParameterSweep
+{
+public:
+    enum class Mode
+    {
+        grid,
+        random,
+        latinHypercube
+    };
+
+    struct Dimension
+    {
+        juce::String parameterName;
+        int parameterIndex = -1;
+        double minValue = 0.0;
+        double maxValue = 1.0;
+        int steps = 2;
+        std::vector<double> values;
+
+        /** The key a job's "parameters" object uses for this dimension. */
+        juce::String getParameterKey() const
+        {
+            return parameterName.isNotEmpty() ? parameterName : ("#" + juce::String(parameterIndex));
+        }
+
+        // Maps u in [0, 1) to the dimension's range or one of its values
+        double getValueAt(double u) const
+        {
+            if (!values.empty())
+                return values[std::min(values.size() - 1, static_cast<size_t>(u * static_cast<double>(values.size())))];
+
+            return minValue + u * (maxValue - minValue);
+        }
+    };
+
+    int pluginIndex = 0;
+    Mode mode = Mode::grid;
+    int numPoints = 0;
+    juce::int64 seed = 1;
+    juce::String manifestFile;
+    std::vector<Dimension> dimensions;
+
+    static bool fromVar(const juce::var& json, ParameterSweep& sweep, juce::String& error)
+    {
+        sweep.pluginIndex = json.getProperty("plugin", 0);
+        sweep.numPoints = json.getProperty("points", 0);
+        sweep.seed = static_cast<juce::int64>(json.getProperty("seed", 1));
+        sweep.manifestFile = json.getProperty("manifest", "");
+
+        auto modeName = json.getProperty("mode", "grid").toString();
+        if (modeName.equalsIgnoreCase("grid"))
+            sweep.mode = Mode::grid;
+        else if (modeName.equalsIgnoreCase("random"))
+            sweep.mode = Mode::random;
+        else if (modeName.equalsIgnoreCase("lhs") || modeName.equalsIgnoreCase("latin_hypercube"))
+            sweep.mode = Mode::latinHypercube;
+        else
+        {
+            error = "unknown mode '" + modeName + "'";
+            return false;
+        }
+
+        auto* parameters = json["parameters"].getArray();
+        if (parameters == nullptr || parameters->isEmpty())
+        {
+            error = "\"parameters\" must be a non-empty array";
+            return false;
+        }
+
+        for (const auto& parameterJson : *parameters)
+        {
+            Dimension dimension;
+            auto parameter = parameterJson["parameter"];
+
+            if (parameter.isInt() || parameter.isInt64() || parameter.isDouble())
+                dimension.parameterIndex = static_cast<int>(parameter);
+            else
+                dimension.parameterName = parameter.toString();
+
+            if (dimension.parameterIndex < 0 && dimension.parameterName.isEmpty())
+            {
+                error = "sweep parameter without \"parameter\"";
+                return false;
+            }
+
+            if (auto* values = parameterJson["values"].getArray())
+            {
+                for (const auto& value : *values)
+                    dimension.values.push_back(juce::jlimit(0.0, 1.0, static_cast<double>(value)));
+            }
+
+            dimension.minValue = juce::jlimit(0.0, 1.0, static_cast<double>(parameterJson.getProperty("min", 0.0)));
+            dimension.maxValue = juce::jlimit(0.0, 1.0, static_cast<double>(parameterJson.getProperty("max", 1.0)));
+            dimension.steps = juce::jmax(1, static_cast<int>(parameterJson.getProperty("steps", 2)));
+
+            if (parameterJson.hasProperty("values") && dimension.values.empty())
+            {
+                error = "\"values\" of " + dimension.getParameterKey() + " is empty";
+                return false;
+            }
+
+            sweep.dimensions.push_back(dimension);
+        }
+
+        if (sweep.mode != Mode::grid && sweep.numPoints <= 0)
+        {
+            error = "\"points\" is required for random and lhs sweeps";
+            return false;
+        }
+
+        return true;
+    }
+
+    /** One value per dimension for every point, in render order. */
+    std::vector<std::vector<double>> generatePoints() const
+    {
+        std::vector<std::vector<double>> points;
+
+        if (mode == Mode::grid)
+        {
+            size_t total = 1;
+            for (const auto& dimension : dimensions)
+                total *= static_cast<size_t>(getGridSize(dimension));
+
+            // The last dimension changes fastest, like nested loops in parameter order
+            for (size_t pointIndex = 0; pointIndex < total; ++pointIndex)
+            {
+                std::vector<double> point(dimensions.size());
+                auto remainder = pointIndex;
+
+                for (size_t d = dimensions.size(); d-- > 0;)
+                {
+                    auto size = static_cast<size_t>(getGridSize(dimensions[d]));
+                    point[d] = getGridValue(dimensions[d], static_cast<int>(remainder % size));
+                    remainder /= size;
+                }
+
+                points.push_back(std::move(point));
+            }
+
+            return points;
+        }
+
+        juce::Random random(seed);
+        auto count = static_cast<size_t>(numPoints);
+        points.assign(count, std::vector<double>(dimensions.size()));
+
+        for (size_t d = 0; d < dimensions.size(); ++d)
+        {
+            // A fresh shuffle of the strata per dimension decouples the dimensions
+            std::vector<size_t> strata(count);
+            std::iota(strata.begin(), strata.end(), size_t(0));
+
+            for (size_t i = count; mode == Mode::latinHypercube && i > 1; --i)
+                std::swap(strata[i - 1], strata[static_cast<size_t>(random.nextInt(static_cast<int>(i)))]);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto u = random.nextDouble();
+
+                if (mode == Mode::latinHypercube)
+                    u = (static_cast<double>(strata[i]) + u) / static_cast<double>(count);
+
+                points[i][d] = dimensions[d].getValueAt(u);
+            }
+        }
+
+        return points;
+    }
+
+    /**
+     * One row per point: its index, output file, parameter vector and the
+     * render results, so a dataset can be loaded as columns without parsing
+     * file names.
+     */
+    bool writeManifest(const juce::File& file, const std::vector<std::vector<double>>& points,
+                       const std::vector<RenderStats>& jobStats) const
+    {
+        juce::StringArray header { "point", "output_file" };
+        for (const auto& dimension : dimensions)
+            header.add(RenderSummary::quoteCsv(dimension.getParameterKey()));
+
+        RenderSummary::addCsvStatsHeader(header);
+
+        juce::MemoryOutputStream csv;
+        csv << header.joinIntoString(",") << "\n";
+
+        for (size_t pointIndex = 0; pointIndex < points.size() && pointIndex < jobStats.size(); ++pointIndex)
+        {
+            const auto& stats = jobStats[pointIndex];
+            juce::StringArray row { juce::String(static_cast<int>(pointIndex)), RenderSummary::quoteCsv(stats.outputFile) };
+
+            for (auto value : points[pointIndex])
+                row.add(juce::String(value, 6));
+
+            RenderSummary::addCsvStats(row, stats);
+
+            csv << row.joinIntoString(",") << "\n";
+        }
+
+        file.getParentDirectory().createDirectory();
+        if (!file.replaceWithData(csv.getData(), csv.getDataSize()))
+        {
+            std::cerr << "Could not write sweep manifest: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static int getGridSize(const Dimension& dimension)
+    {
+        return dimension.values.empty() ? dimension.steps : static_cast<int>(dimension.values.size());
+    }
+
+    static double getGridValue(const Dimension& dimension, int step)
+    {
+        if (!dimension.values.empty())
+            return dimension.values[static_cast<size_t>(step)];
+
+        if (dimension.steps == 1)
+            return dimension.minValue;
+
+        return dimension.minValue + (dimension.maxValue - dimension.minValue) * step / (dimension.steps - 1);
+    }
+};
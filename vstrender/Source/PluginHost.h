@@ -0,0 +1,4272 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <iomanip>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <list>
+#include <numeric>
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <juce_data_structures/juce_data_structures.h>
+#include <juce_events/juce_events.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "AudioStreamWriter.h"
+#include "BlockSchedule.h"
+#include "PluginLoader.h"
+#include "PluginScanCache.h"
+#include "PluginStateIO.h"
+#include "MidiIngest.h"
+#include "MidiSchedule.h"
+#include "MidiUtilities.h"
+#include "MidiProbeSet.h"
+#include "MultisampleCapture.h"
+#include "HostLog.h"
+#include "RenderSummary.h"
+#include "RenderProfiler.h"
+#include "AutomationLane.h"
+#include "WorkerProcess.h"
+#include "RenderCache.h"
+#include "SysExBank.h"
+#include "StateSnapshotStore.h"
+#include "RenderOutputs.h"
+#include "Resampler.h"
+#include "AudioAnalysis.h"
+#include "ChainGraph.h"
+#include "ParameterSweep.h"
+#include "ParameterIndexCache.h"
+
+//==============================================================================
+// Debug and safety utilities
+//==============================================================================
+
+inline void safeLog(const char* message) {
+    try {
+        std::cout << "[DEBUG] " << message << std::endl;
+        std::cout.flush();
+    } catch (...) {
+        std::cerr << "[DEBUG] " << message << std::endl;
+    }
+}
+
+// Forward declaration
+class AudioPluginHost;
+inline AudioPluginHost* g_hostInstance = nullptr;
+
+//==============================================================================
+// Parameter enumeration and management utilities
+//==============================================================================
+
+struct ParameterInfo
+{
+    int index;
+    juce::String name;
+    juce::String label;
+    juce::String text;
+    float value;
+    float defaultValue;
+    int numSteps;
+    bool isDiscrete;
+    bool isBoolean;
+    bool isMetaParameter;
+    juce::String category;
+
+    void print() const
+    {
+        std::cout << "  [" << std::setw(3) << index << "] "
+                  << std::setw(35) << std::left << name.toStdString()
+                  << " = " << std::setw(8) << std::fixed << std::setprecision(4) << value;
+
+        if (!text.isEmpty() && text != juce::String(value))
+        {
+            std::cout << " (\"" << text << "\")";
+        }
+
+        if (isDiscrete && numSteps > 0)
+        {
+            std::cout << " [discrete: " << numSteps << " steps]";
+        }
+
+        if (isBoolean)
+        {
+            std::cout << " [boolean]";
+        }
+
+        if (!label.isEmpty())
+        {
+            std::cout << " {" << label << "}";
+        }
+
+        std::cout << std::endl;
+    }
+};
+
+class PluginParameterManager
+{
+public:
+    static std::vector<ParameterInfo> enumerateParameters(juce::AudioPluginInstance* plugin)
+    {
+        std::vector<ParameterInfo> parameters;
+
+        if (!plugin)
+            return parameters;
+
+        const auto& params = plugin->getParameters();
+        const bool printTable = HostLog::isEnabled(LogLevel::verbose);
+
+        if (printTable)
+        {
+            std::cout << "\n=== PARAMETER ENUMERATION ===" << std::endl;
+            std::cout << "Plugin: " << plugin->getName() << std::endl;
+            std::cout << "Total parameters: " << params.size() << std::endl;
+            std::cout << "Programs available: " << plugin->getNumPrograms() << std::endl;
+
+            if (plugin->getNumPrograms() > 0)
+            {
+                std::cout << "Current program: " << plugin->getCurrentProgram()
+                          << " (\"" << plugin->getProgramName(plugin->getCurrentProgram()) << "\")" << std::endl;
+            }
+
+            std::cout << "\nParameter List:" << std::endl;
+            std::cout << "Index Name                               Value    Text/Label" << std::endl;
+            std::cout << "----- ---------------------------------- -------- -----------" << std::endl;
+        }
+
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto* param = params[i];
+            ParameterInfo info;
+
+            info.index = i;
+            info.name = param->getName(256);
+            info.label = param->getLabel();
+            info.value = param->getValue();
+            info.defaultValue = param->getDefaultValue();
+            info.text = param->getText(param->getValue(), 256);
+            info.numSteps = param->getNumSteps();
+            info.isDiscrete = (info.numSteps > 0 && info.numSteps < 1000);
+            info.isBoolean = param->isBoolean();
+            info.isMetaParameter = param->isMetaParameter();
+			info.category = "Unknown";
+            // Convert category enum to string
+            /*
+            auto category = param->getCategory();
+            switch (category)
+            {
+                case juce::AudioProcessorParameter::genericParameter:
+                    info.category = "Generic";
+                    break;
+                case juce::AudioProcessorParameter::inputGain:
+                    info.category = "Input Gain";
+                    break;
+                case juce::AudioProcessorParameter::outputGain:
+                    info.category = "Output Gain";
+                    break;
+                case juce::AudioProcessorParameter::inputMeter:
+                    info.category = "Input Meter";
+                    break;
+                case juce::AudioProcessorParameter::outputMeter:
+                    info.category = "Output Meter";
+                    break;
+                case juce::AudioProcessorParameter::compressorLimiterGateExpander:
+                    info.category = "Compressor/Limiter/Gate/Expander";
+                    break;
+                case juce::AudioProcessorParameter::colour:
+                    info.category = "Colour";
+                    break;
+                case juce::AudioProcessorParameter::otherParameter:
+                    info.category = "Other";
+                    break;
+                default:
+                    info.category = "Unknown";
+                    break;
+            }
+            */
+
+            parameters.push_back(info);
+
+            if (printTable)
+                info.print();
+        }
+
+        if (printTable)
+        {
+            // Look for common program/preset parameters
+            std::cout << "\n=== PRESET/PROGRAM PARAMETERS ===" << std::endl;
+            findPresetParameters(parameters);
+
+            std::cout << "===========================" << std::endl;
+        }
+
+        return parameters;
+    }
+
+    static void findPresetParameters(const std::vector<ParameterInfo>& parameters)
+    {
+        std::vector<std::string> presetKeywords = {
+            "program", "preset", "patch", "bank", "sound", "voice",
+            "Program", "Preset", "Patch", "Bank", "Sound", "Voice",
+            // Pianoteq-specific keywords
+            "instrument", "piano", "model", "type", "variant", "style"
+        };
+
+        std::cout << "Looking for preset/program-related parameters:" << std::endl;
+
+        bool foundAny = false;
+        for (const auto& param : parameters)
+        {
+            for (const auto& keyword : presetKeywords)
+            {
+                if (param.name.contains(juce::String(keyword)))
+                {
+                    std::cout << "  *** PRESET PARAM: [" << param.index << "] "
+                              << param.name << " = " << param.value
+                              << " (\"" << param.text << "\")";
+
+                    if (param.isDiscrete)
+                    {
+                        std::cout << " [" << param.numSteps << " options]";
+                    }
+                    std::cout << std::endl;
+                    foundAny = true;
+                    break;
+                }
+            }
+        }
+
+        // Look for discrete parameters that might be instrument selectors
+        std::cout << "\nDiscrete parameters that might control instruments/sounds:" << std::endl;
+        for (const auto& param : parameters)
+        {
+            if (param.isDiscrete && param.numSteps > 1 && param.numSteps < 100 &&
+                !param.name.startsWith("MIDI CC"))
+            {
+                // Skip obvious non-instrument parameters
+                juce::String lowerName = param.name.toLowerCase();
+                if (!lowerName.contains("volume") && !lowerName.contains("gain") &&
+                    !lowerName.contains("mix") && !lowerName.contains("level") &&
+                    !lowerName.contains("delay") && !lowerName.contains("reverb") &&
+                    !lowerName.contains("bypass"))
+                {
+                    std::cout << "  [" << param.index << "] " << param.name
+                              << " = " << param.value << " (\"" << param.text << "\") "
+                              << "[" << param.numSteps << " options]" << std::endl;
+                    foundAny = true;
+                }
+            }
+        }
+
+        if (!foundAny)
+        {
+            std::cout << "  No obvious preset/program parameters found." << std::endl;
+            std::cout << "  Try looking for parameters with discrete values or specific names." << std::endl;
+            std::cout << "  For Pianoteq, the instrument selection might be handled via .fxp presets" << std::endl;
+            std::cout << "  or through the plugin's internal preset system rather than parameters." << std::endl;
+        }
+    }
+
+    static bool exportParametersToJson(juce::AudioPluginInstance* plugin, const juce::String& filePath)
+    {
+        if (!plugin)
+            return false;
+
+        auto parameters = enumerateParameters(plugin);
+
+        juce::var jsonRoot = juce::var(new juce::DynamicObject());
+        auto* rootObject = jsonRoot.getDynamicObject();
+
+        rootObject->setProperty("plugin_name", plugin->getName());
+        rootObject->setProperty("plugin_description", plugin->getPluginDescription().descriptiveName);
+        rootObject->setProperty("total_parameters", static_cast<int>(parameters.size()));
+        rootObject->setProperty("num_programs", plugin->getNumPrograms());
+
+        if (plugin->getNumPrograms() > 0)
+        {
+            rootObject->setProperty("current_program", plugin->getCurrentProgram());
+            rootObject->setProperty("current_program_name", plugin->getProgramName(plugin->getCurrentProgram()));
+
+            // Export all program names
+            juce::var programsArray = juce::var(juce::Array<juce::var>());
+            for (int i = 0; i < plugin->getNumPrograms(); ++i)
+            {
+                juce::var program = juce::var(new juce::DynamicObject());
+                program.getDynamicObject()->setProperty("index", i);
+                program.getDynamicObject()->setProperty("name", plugin->getProgramName(i));
+                programsArray.append(program);
+            }
+            rootObject->setProperty("programs", programsArray);
+        }
+
+        // Export parameters
+        juce::var parametersArray = juce::var(juce::Array<juce::var>());
+        for (const auto& param : parameters)
+        {
+            juce::var paramObj = juce::var(new juce::DynamicObject());
+            auto* paramDynObj = paramObj.getDynamicObject();
+
+            paramDynObj->setProperty("index", param.index);
+            paramDynObj->setProperty("name", param.name);
+            paramDynObj->setProperty("value", param.value);
+            paramDynObj->setProperty("text", param.text);
+            paramDynObj->setProperty("default_value", param.defaultValue);
+            paramDynObj->setProperty("label", param.label);
+            paramDynObj->setProperty("num_steps", param.numSteps);
+            paramDynObj->setProperty("is_discrete", param.isDiscrete);
+            paramDynObj->setProperty("is_boolean", param.isBoolean);
+            paramDynObj->setProperty("is_meta_parameter", param.isMetaParameter);
+            paramDynObj->setProperty("category", param.category);
+
+            parametersArray.append(paramObj);
+        }
+        rootObject->setProperty("parameters", parametersArray);
+
+        // Write to file
+        juce::File outputFile(filePath);
+        outputFile.getParentDirectory().createDirectory();
+
+        juce::FileOutputStream fileStream(outputFile);
+        if (!fileStream.openedOk())
+        {
+            std::cerr << "Could not create parameter export file: " << filePath << std::endl;
+            return false;
+        }
+
+        juce::JSON::writeToStream(fileStream, jsonRoot, true);
+
+        std::cout << "Parameters exported to: " << filePath << std::endl;
+        return true;
+    }
+
+    static void monitorProgramChanges(juce::AudioPluginInstance* plugin)
+    {
+        if (plugin->getNumPrograms() > 0 && HostLog::isEnabled(LogLevel::verbose))
+        {
+            std::cout << "\n=== PROGRAM INFORMATION ===" << std::endl;
+            std::cout << "Available programs: " << plugin->getNumPrograms() << std::endl;
+            std::cout << "Current program: " << plugin->getCurrentProgram()
+                      << " (\"" << plugin->getProgramName(plugin->getCurrentProgram()) << "\")" << std::endl;
+
+            std::cout << "\nAll available programs:" << std::endl;
+            for (int i = 0; i < std::min(20, plugin->getNumPrograms()); ++i)
+            {
+                std::cout << "  [" << std::setw(3) << i << "] " << plugin->getProgramName(i) << std::endl;
+            }
+
+            if (plugin->getNumPrograms() > 20)
+            {
+                std::cout << "  ... and " << (plugin->getNumPrograms() - 20) << " more programs" << std::endl;
+            }
+            std::cout << "=========================" << std::endl;
+        }
+    }
+};
+
+//==============================================================================
+// Configuration structures
+//==============================================================================
+
+// The part of a MIDI file one instrument plays, from "midi_tracks" (0-based
+// track indices) and "midi_channels" (1-16). Empty lists take everything;
+// messages without a channel (sysex, meta) always pass, as in
+// MidiUtilities::extractMidiChannels.
+struct MidiRouting
+{
+    std::vector<int> tracks;
+    std::vector<int> channels;
+
+    bool isEmpty() const    { return tracks.empty() && channels.empty(); }
+
+    bool accepts(int trackIndex, const juce::MidiMessage& message) const
+    {
+        if (!tracks.empty() && std::find(tracks.begin(), tracks.end(), trackIndex) == tracks.end())
+            return false;
+
+        auto channel = message.getChannel();
+        return channels.empty() || channel == 0
+            || std::find(channels.begin(), channels.end(), channel) != channels.end();
+    }
+
+    // Stable text for logs and schedule cache keys, e.g. "tracks 1,2 channels 10"
+    juce::String getDescription() const
+    {
+        juce::String description;
+
+        if (!tracks.empty())
+            description << "tracks " << joinNumbers(tracks);
+
+        if (!channels.empty())
+            description << (description.isEmpty() ? "" : " ") << "channels " << joinNumbers(channels);
+
+        return description;
+    }
+
+    static bool fromVar(const juce::var& json, MidiRouting& routing, juce::String& error)
+    {
+        return parseNumbers(json["midi_tracks"], 0, 65535, routing.tracks, "midi_tracks", error)
+            && parseNumbers(json["midi_channels"], 1, 16, routing.channels, "midi_channels", error);
+    }
+
+private:
+    static bool parseNumbers(const juce::var& value, int minValue, int maxValue, std::vector<int>& numbers,
+                             const juce::String& name, juce::String& error)
+    {
+        if (value.isVoid())
+            return true;
+
+        // A single number is accepted as a one-entry list
+        juce::Array<juce::var> single { value };
+        auto* array = value.isArray() ? value.getArray() : &single;
+
+        for (const auto& entry : *array)
+        {
+            auto number = static_cast<int>(entry);
+            if (!(entry.isInt() || entry.isInt64() || entry.isDouble()) || number < minValue || number > maxValue)
+            {
+                error = "\"" + name + "\" entries must be numbers from " + juce::String(minValue) + " to " + juce::String(maxValue);
+                return false;
+            }
+
+            numbers.push_back(number);
+        }
+
+        return true;
+    }
+
+    static juce::String joinNumbers(const std::vector<int>& numbers)
+    {
+        juce::StringArray parts;
+        for (auto number : numbers)
+            parts.add(juce::String(number));
+
+        return parts.joinIntoString(",");
+    }
+};
+
+struct PluginConfig
+{
+    juce::String pluginPath;
+    juce::String pluginName;
+    juce::String presetPath;
+    juce::String parametersBefore;
+    juce::String parametersAfter;
+    juce::var parameters;
+
+    // VSTi-specific configuration
+    bool isInstrument = false;
+    juce::String midiFile;
+    std::shared_ptr<const MidiProbe> midiProbe;    // generated sequence played instead of midiFile
+    std::shared_ptr<const MultisampleCapture> midiCapture;    // continuous multisample capture, likewise
+    MidiRouting midiRouting;
+    double instrumentLength = 0.0;
+    int programNumber = -1;
+
+    // SYSEX patch support:
+    juce::String sysexFile;
+    int sysexPatchNumber = -1;
+
+    // State saving/loading support
+    juce::String saveStateTo;        // Save current state to this file
+    juce::String loadStateFrom;      // Load state from this file
+    bool saveDefaultState = false;   // Save the default state before any changes
+    bool saveStateDumps = false;     // Also write .base64 and .hex dumps next to saved states
+
+    // Parameter automation applied during the render
+    std::vector<AutomationLane> automation;
+};
+
+struct ProcessingConfig
+{
+    juce::String inputFile;
+    juce::String outputFile;
+    std::vector<PluginConfig> plugins;
+    double sampleRate = 0.0;
+    int bitDepth = 0;
+    int bufferSize = 2048;
+
+    // Rate the plugins run at when it differs from the delivered sample_rate;
+    // input and outputs are resampled around the chain
+    double pluginSampleRate = 0.0;
+
+    // VSTi-specific settings
+    bool hasInstrument = false;
+    double renderLength = 0.0;
+    int instrumentChannels = 2;
+
+    // Write <output>.profile.json with per-plugin block timings
+    bool writeProfile = false;
+
+    // Write <output>.analysis.json with loudness and spectral features of the render
+    bool analyze = false;
+    int analysisFftSize = 2048;
+
+    // Split instrument blocks so automation breakpoints land on a block boundary
+    bool splitAutomationBlocks = false;
+
+    // Variable block sizes cut at MIDI events, and the silent pre-roll before the render
+    BlockSchedule blockSchedule;
+
+    // Stop an instrument render once the output stays below tailThresholdDb
+    // for tailHoldBlocks blocks after the last MIDI event
+    bool autoTail = false;
+    float tailThresholdDb = -80.0f;
+    int tailHoldBlocks = 8;
+    double maxTailSeconds = 30.0;
+
+    // Files written from the render; a single entry for outputFile unless the
+    // job lists "outputs"
+    std::vector<OutputSpec> outputs;
+
+    // Routing between the plugins; empty runs them in series
+    GraphConfig graph;
+};
+
+//==============================================================================
+// Simple MIDI sequence for VSTi processing
+//==============================================================================
+
+class SimpleMidiSequence
+{
+public:
+    struct MidiEvent
+    {
+        double timeStamp;
+        juce::MidiMessage message;
+
+        MidiEvent(double time, const juce::MidiMessage& msg)
+            : timeStamp(time), message(msg) {}
+    };
+
+    std::vector<MidiEvent> events;
+    double totalLength = 0.0;
+    bool logNoteDetails = HostLog::isEnabled(LogLevel::debug);
+
+	// Loads the events of midiFilePath that routing accepts
+	bool loadFromFile(const juce::String& midiFilePath, const MidiRouting& routing = {})
+	{
+		juce::File midiFile(midiFilePath);
+		if (!midiFile.existsAsFile())
+		{
+			std::cerr << "MIDI file not found: " << midiFilePath << std::endl;
+			return false;
+		}
+
+		auto parsed = ParsedMidiFile::parse(midiFile);
+		return parsed && loadFrom(*parsed, midiFilePath, routing);
+	}
+
+	// Loads the events of a parsed file that routing accepts. Times are already
+	// resolved against the tempo map of every track, so a filtered part keeps
+	// the file's timing
+	bool loadFrom(const ParsedMidiFile& midi, const juce::String& midiFilePath, const MidiRouting& routing = {})
+	{
+		const bool verbose = HostLog::isEnabled(LogLevel::verbose);
+
+		if (verbose)
+		{
+			std::cout << "=== DETAILED MIDI FILE ANALYSIS ===" << std::endl;
+			std::cout << "File: " << midiFilePath << std::endl;
+			std::cout << "MIDI file loaded successfully:" << std::endl;
+			std::cout << "  Tracks: " << midi.getNumTracks() << std::endl;
+			std::cout << "  Time format: " << midi.getTimeFormat() << std::endl;
+		}
+
+		events.clear();
+		events.reserve(midi.size());
+		totalLength = 0.0;
+
+		int totalNoteOnEvents = 0;
+		int totalNoteOffEvents = 0;
+		int totalOtherEvents = 0;
+
+		if (verbose)
+			std::cout << "\n=== PROCESSING TRACKS ===" << std::endl;
+
+		int currentTrack = -1;
+
+		for (size_t eventIndex = 0; eventIndex < midi.size(); ++eventIndex)
+		{
+			const auto& event = midi.getEvent(eventIndex);
+			const int trackIndex = event.track;
+
+			if (verbose && trackIndex != currentTrack)
+				std::cout << "\nTrack " << trackIndex << std::endl;
+
+			currentTrack = trackIndex;
+			const auto message = midi.getMessage(eventIndex);
+
+			if (!message.isTempoMetaEvent() && !routing.accepts(trackIndex, message))
+				continue;
+
+			const double timeInSeconds = event.timeInSeconds;
+
+			if (logNoteDetails)
+				std::cout << "  Event at " << std::fixed << std::setprecision(3) << timeInSeconds << "s" << std::endl;
+
+			// Tempo changes are already applied to the times; only report them
+			if (message.isTempoMetaEvent())
+			{
+				if (verbose) {
+					double microsecondsPerQuarter = message.getTempoSecondsPerQuarterNote() * 1000000.0;
+					double bpm = 60000000.0 / microsecondsPerQuarter;
+					std::cout << "  TEMPO CHANGE: " << std::fixed << std::setprecision(1) << bpm << " BPM"
+							  << " (" << microsecondsPerQuarter << " us/quarter) at " << timeInSeconds << "s" << std::endl;
+				}
+				totalOtherEvents++;
+			}
+			else if (message.isNoteOn())
+			{
+				if (logNoteDetails) {
+					std::cout << "  NOTE ON:  Note " << message.getNoteNumber()
+							  << " (" << getNoteNameFromNumber(message.getNoteNumber()) << ")"
+							  << ", Vel " << (int)message.getVelocity()
+							  << ", Ch " << message.getChannel()
+							  << " at " << std::fixed << std::setprecision(3) << timeInSeconds << "s" << std::endl;
+				}
+				totalNoteOnEvents++;
+			}
+			else if (message.isNoteOff())
+			{
+				if (logNoteDetails) {
+					std::cout << "  NOTE OFF: Note " << message.getNoteNumber()
+							  << " (" << getNoteNameFromNumber(message.getNoteNumber()) << ")"
+							  << ", Vel " << (int)message.getVelocity()
+							  << ", Ch " << message.getChannel()
+							  << " at " << std::fixed << std::setprecision(3) << timeInSeconds << "s" << std::endl;
+					}
+				totalNoteOffEvents++;
+			}
+			else if (message.isTrackNameEvent())
+			{
+				if (verbose)
+					std::cout << "  TRACK NAME: " << message.getTextFromTextMetaEvent() << std::endl;
+				totalOtherEvents++;
+			}
+			else if (message.isEndOfTrackMetaEvent())
+			{
+				if (verbose)
+					std::cout << "  END OF TRACK at " << timeInSeconds << "s" << std::endl;
+				totalOtherEvents++;
+			}
+			else
+			{
+				totalOtherEvents++;
+			}
+
+			events.emplace_back(timeInSeconds, message);
+			totalLength = juce::jmax(totalLength, timeInSeconds);
+		}
+
+		// Sort events by time - stable, so events on the same tick keep their file order
+		std::stable_sort(events.begin(), events.end(),
+						 [](const MidiEvent& a, const MidiEvent& b) {
+							 return a.timeStamp < b.timeStamp;
+						 });
+
+		if (verbose)
+		{
+			std::cout << "\n=== SUMMARY ===" << std::endl;
+			std::cout << "Note On events: " << totalNoteOnEvents << std::endl;
+			std::cout << "Note Off events: " << totalNoteOffEvents << std::endl;
+			std::cout << "Other events: " << totalOtherEvents << std::endl;
+			std::cout << "Total events loaded: " << events.size() << std::endl;
+			std::cout << "Total duration: " << std::fixed << std::setprecision(3) << totalLength << " seconds" << std::endl;
+		}
+
+		if (totalNoteOnEvents == 0)
+		{
+			std::cerr << "*** ERROR: No Note On events found! ***" << std::endl;
+			return false;
+		}
+
+		if (totalNoteOnEvents != totalNoteOffEvents)
+		{
+			std::cout << "*** WARNING: Mismatched Note On/Off events! ***" << std::endl;
+		}
+
+		if (verbose)
+		{
+			// Find first and last note times
+			double firstNoteTime = -1;
+			double lastNoteTime = -1;
+
+			for (const auto& event : events)
+			{
+				if (event.message.isNoteOn())
+				{
+					if (firstNoteTime < 0)
+						firstNoteTime = event.timeStamp;
+					lastNoteTime = event.timeStamp;
+				}
+			}
+
+			std::cout << "First note at: " << std::fixed << std::setprecision(3) << firstNoteTime << "s" << std::endl;
+			std::cout << "Last note at: " << std::fixed << std::setprecision(3) << lastNoteTime << "s" << std::endl;
+			std::cout << "Actual note span: " << std::fixed << std::setprecision(3) << (lastNoteTime - firstNoteTime) << "s" << std::endl;
+		}
+
+		// Add note-off events for any hanging notes
+		addNoteOffEvents();
+
+		if (verbose)
+		{
+			std::cout << "Events after cleanup: " << events.size() << std::endl;
+			std::cout << "=== END ANALYSIS ===" << std::endl;
+		}
+		else
+		{
+			std::cout << "MIDI: " << totalNoteOnEvents << " notes, " << events.size() << " events, "
+					  << std::fixed << std::setprecision(3) << totalLength << "s" << std::endl;
+		}
+
+		return true;
+	}
+
+	static juce::String getNoteNameFromNumber(int noteNumber)
+	{
+		if (noteNumber < 0 || noteNumber > 127)
+			return "Invalid";
+
+		const char* noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+		int octave = (noteNumber / 12) - 1;
+		int noteIndex = noteNumber % 12;
+
+		return juce::String(noteNames[noteIndex]) + juce::String(octave);
+	}
+
+    // Convert the loaded events to sample positions for one render format
+    std::shared_ptr<MidiSchedule> compile(double sampleRate, int blockSize) const
+    {
+        auto schedule = std::make_shared<MidiSchedule>(sampleRate, blockSize);
+
+        for (const auto& event : events)
+        {
+            schedule->addEvent(event.timeStamp, event.message);
+        }
+
+        schedule->setLengthInSeconds(totalLength);
+        schedule->finalise();
+        return schedule;
+    }
+
+private:
+    void addNoteOffEvents()
+    {
+        std::map<int, double> hangingNotes;
+
+        for (const auto& event : events)
+        {
+            if (event.message.isNoteOn())
+            {
+                hangingNotes[getNoteKey(event.message)] = event.timeStamp;
+            }
+            else if (event.message.isNoteOff())
+            {
+                hangingNotes.erase(getNoteKey(event.message));
+            }
+        }
+
+        // All note-offs go after the last event, so appending keeps the vector sorted
+        auto noteOffTime = totalLength + 0.1;
+
+        for (const auto& note : hangingNotes)
+        {
+            // Sent on the note's own channel, so a part routed by channel is released too
+            auto noteOffMessage = juce::MidiMessage::noteOff(juce::jmax(1, note.first / 128), note.first % 128, (juce::uint8)64);
+            events.emplace_back(noteOffTime, noteOffMessage);
+        }
+
+        if (!hangingNotes.empty())
+        {
+            totalLength = noteOffTime;
+        }
+    }
+
+    static int getNoteKey(const juce::MidiMessage& message)
+    {
+        return message.getChannel() * 128 + message.getNoteNumber();
+    }
+};
+
+//==============================================================================
+// Render engine: one plugin chain plus everything needed to render jobs on it.
+// Batch workers each own an engine, so plugin instances are never shared
+// between threads.
+//==============================================================================
+
+class RenderEngine
+{
+public:
+    explicit RenderEngine(PluginScanCache* sharedScanCache = nullptr,
+                          MidiScheduleCache* sharedScheduleCache = nullptr,
+                          SysExBankCache* sharedBankCache = nullptr)
+        : scanCache(sharedScanCache),
+          scheduleCache(sharedScheduleCache != nullptr ? sharedScheduleCache : &ownScheduleCache),
+          bankCache(sharedBankCache != nullptr ? sharedBankCache : &ownBankCache)
+    {
+    }
+
+    // Scans and instantiates the chain for a job without applying its settings.
+    // Called on the main thread before workers start, because plugin creation
+    // is not guaranteed to be thread-safe; the host loads every engine again
+    // for each chain format of the batch (see getFormatGroups()).
+    bool loadPlugins(const ProcessingConfig& job)
+    {
+        config = job;
+
+        double sampleRate = 0.0;
+        int numChannels = 0;
+
+        if (!getChainFormat(config, sampleRate, numChannels))
+            return false;
+
+        // A pooled engine only ever holds one chain, so a loaded chain in the same format is already warm
+        if (!pluginChain.empty() && isChainPreparedFor(sampleRate, numChannels))
+            return true;
+
+        releasePlugins();
+
+        if (!initializePlugins(sampleRate, numChannels))
+        {
+            releasePlugins();
+            return false;
+        }
+
+        chainSampleRate = sampleRate;
+        chainNumChannels = numChannels;
+        chainBlockSize = getPreparedBlockSize();
+        return true;
+    }
+
+    // Identifies the format a job's chain is prepared in: a chain loaded for
+    // one job renders any job with the same key without being re-instantiated.
+    // Empty when the input can't be read; such a job fails when it renders.
+    static juce::String getChainFormatKey(const ProcessingConfig& job)
+    {
+        double sampleRate = 0.0;
+        int numChannels = 0;
+
+        if (!getChainFormat(job, sampleRate, numChannels))
+            return {};
+
+        return juce::String(sampleRate) + "/" + juce::String(numChannels) + "/"
+               + juce::String(job.blockSchedule.getPreparedBlockSize(job.bufferSize));
+    }
+
+    // Batch workers render with this off: a job whose format doesn't match the
+    // loaded chain then fails instead of instantiating plugins off the main thread
+    void setChainLoadAllowed(bool shouldAllow)
+    {
+        chainLoadAllowed = shouldAllow;
+    }
+
+    // Times the chain loaded by loadPlugins() for "max_block_size": "auto" and
+    // returns the size to render at, with the timings for the profile in report.
+    // The host calls this on the main thread before the workers start, so every
+    // engine of a batch renders at one size whatever the load on the machine.
+    // The timings belong to the loaded plugins and are reused by later batches.
+    int tuneBlockSize(juce::var& report)
+    {
+        if (blockTuning.empty())
+        {
+            auto candidates = BlockSizeTuner::getCandidates(config.bufferSize, getPreparedBlockSize());
+
+            for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+            {
+                blockTuning.push_back(BlockSizeTuner::measure(*pluginChain[pluginIndex], chainNumChannels,
+                                                              config.plugins[pluginIndex].isInstrument, candidates));
+
+                std::cout << "Block size tuning: " << blockTuning.back().name << " -> "
+                          << blockTuning.back().blockSize << " samples" << std::endl;
+            }
+
+            // Clear what the timing blocks left in delay lines and filters
+            for (auto& plugin : pluginChain)
+                plugin->reset();
+        }
+
+        auto blockSize = BlockSizeTuner::getChainBlockSize(blockTuning, config.bufferSize);
+        report = BlockSizeTuner::toVar(blockTuning, blockSize);
+        return blockSize;
+    }
+
+    bool renderJob(const ProcessingConfig& job)
+    {
+        config = job;
+
+        lastStats = RenderStats();
+        lastStats.outputFile = job.outputFile;
+
+        profiler.clear();
+        chainLoadedForJob = false;
+        renderCacheKey = {};
+
+        auto startTime = juce::Time::getMillisecondCounterHiRes();
+        lastStats.success = processCurrentJob();
+        lastStats.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        if (job.blockSchedule.isTuned())
+            lastStats.tunedBlockSize = job.blockSchedule.tunedBlockSize;
+
+        if (lastStats.success && renderCache != nullptr && renderCacheKey.isNotEmpty() && !lastStats.cacheHit)
+            renderCache->store(renderCacheKey, juce::File(config.outputFile), lastStats);
+
+        if (lastStats.success && config.analyze && lastStats.analysis.isObject())
+        {
+            auto analysisFile = AudioAnalyzer::getAnalysisFileFor(juce::File(config.outputFile));
+
+            if (AudioAnalyzer::writeToFile(lastStats.analysis, analysisFile, config.outputFile))
+                std::cout << "Analysis written to: " << analysisFile.getFullPathName() << std::endl;
+        }
+
+        if (isProfiling() && lastStats.success)
+        {
+            profiler.setChainLoad(chainLoadPhases, chainLoadedForJob);
+
+            if (reportProfile)
+                lastStats.profile = profiler.toVar(config.outputFile);
+
+            if (config.writeProfile)
+            {
+                auto profileFile = RenderProfiler::getProfileFileFor(juce::File(config.outputFile));
+
+                if (profiler.writeToFile(profileFile, config.outputFile))
+                    std::cout << "Render profile written to: " << profileFile.getFullPathName() << std::endl;
+            }
+        }
+
+        return lastStats.success;
+    }
+
+    // Profile every job and return it in RenderStats::profile, without writing a sidecar file
+    void setReportProfile(bool shouldReport)
+    {
+        reportProfile = shouldReport;
+    }
+
+    // Finished renders are looked up in and added to this cache; null disables it
+    void setRenderCache(RenderCache* cacheToUse)
+    {
+        renderCache = cacheToUse;
+    }
+
+    // Preset states are restored from and recorded in this store; null disables it
+    void setSnapshotStore(StateSnapshotStore* storeToUse)
+    {
+        snapshotStore = storeToUse;
+    }
+
+    // Parameter names are resolved through this cache; null keeps the indexes in memory
+    void setParameterIndexCache(ParameterIndexCache* cacheToUse)
+    {
+        parameterCache = cacheToUse != nullptr ? cacheToUse : &ownParameterCache;
+    }
+
+    // MIDI files are parsed through this cache; null parses into an engine-local one
+    void setMidiIngestCache(MidiIngestCache* cacheToUse)
+    {
+        ingestCache = cacheToUse != nullptr ? cacheToUse : &ownIngestCache;
+    }
+
+    // Diagnostics for the most recent renderJob() call
+    const RenderStats& getLastStats() const
+    {
+        return lastStats;
+    }
+
+    void releasePlugins()
+    {
+        pluginChain.clear();
+        pristineStates.clear();
+        parameterIndexes.clear();
+        blockTuning.clear();
+        chainSampleRate = 0.0;
+        chainNumChannels = 0;
+        chainBlockSize = 0;
+    }
+
+private:
+    ProcessingConfig config;
+    std::vector<std::unique_ptr<juce::AudioPluginInstance>> pluginChain;
+    juce::AudioPluginFormatManager pluginFormatManager;
+    PluginScanCache* scanCache = nullptr;
+    PluginLoader loader { pluginFormatManager, scanCache };
+
+    // Compiled MIDI for the current job, one schedule per instrument (null for
+    // effects); shared with other engines through the cache
+    MidiScheduleCache ownScheduleCache;
+    MidiScheduleCache* scheduleCache = nullptr;
+    MidiIngestCache ownIngestCache;
+    MidiIngestCache* ingestCache = &ownIngestCache;
+    std::vector<std::shared_ptr<const MidiSchedule>> instrumentSchedules;
+    juce::MidiBuffer blockMidi;
+
+    // Parsed sysex banks, shared the same way
+    SysExBankCache ownBankCache;
+    SysExBankCache* bankCache = nullptr;
+
+    // Longest time to wait for a plugin to show a sysex voice in its state
+    static constexpr double sysexConfirmTimeoutMs = 100.0;
+
+    RenderStats lastStats;
+
+    RenderCache* renderCache = nullptr;
+    juce::String renderCacheKey;
+    StateSnapshotStore* snapshotStore = nullptr;
+
+    // Automation lanes of the current job, bound to parameter objects once per job
+    AutomationPlayer automation;
+
+    // Timings for the current job; the chain load phases come from the last initializePlugins()
+    RenderProfiler profiler;
+    std::vector<RenderProfiler::Phase> chainLoadPhases;
+    bool chainLoadedForJob = false;
+    bool reportProfile = false;
+    bool chainLoadAllowed = true;
+
+    // Features of the current job's output, fed block by block while it renders
+    AudioAnalyzer analyzer;
+
+    // Parallel routing for jobs with a "graph"; each instrument node fills its
+    // own MIDI buffer from its schedule for the segment at graphSegmentPosition
+    ChainGraph chainGraph;
+    std::vector<juce::MidiBuffer> nodeMidi;
+    juce::int64 graphSegmentPosition = 0;
+
+    // State captured right after each plugin was instantiated, restored between batch jobs
+    std::vector<juce::MemoryBlock> pristineStates;
+
+    // Name -> index lookups for each plugin of the chain, shared through the cache
+    ParameterIndexCache ownParameterCache;
+    ParameterIndexCache* parameterCache = &ownParameterCache;
+    std::vector<std::shared_ptr<const ParameterIndex>> parameterIndexes;
+    double chainSampleRate = 0.0;
+    int chainNumChannels = 0;
+    int chainBlockSize = 0;
+
+    // Adaptive blocks: per-plugin timings from the first tuneBlockSize() on this
+    // chain, and the largest block of the current job
+    std::vector<BlockSizeTuner::PluginResult> blockTuning;
+    int renderBlockSize = 0;
+
+    bool isProfiling() const
+    {
+        return config.writeProfile || reportProfile;
+    }
+
+    int getPreparedBlockSize() const
+    {
+        return config.blockSchedule.getPreparedBlockSize(config.bufferSize);
+    }
+
+    bool isChainPreparedFor(double sampleRate, int numChannels) const
+    {
+        return sampleRate == chainSampleRate && numChannels == chainNumChannels && getPreparedBlockSize() == chainBlockSize;
+    }
+
+    // Sample rate and channel count the chain is prepared with for a job
+    static bool getChainFormat(const ProcessingConfig& job, double& sampleRate, int& numChannels)
+    {
+        if (job.hasInstrument)
+        {
+            sampleRate = (job.pluginSampleRate > 0) ? job.pluginSampleRate
+                                                    : (job.sampleRate > 0) ? job.sampleRate : 44100.0;
+            numChannels = job.instrumentChannels;
+            return true;
+        }
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(juce::File(job.inputFile)));
+        if (!reader)
+        {
+            std::cerr << "Could not read input file: " << job.inputFile << std::endl;
+            return false;
+        }
+
+        sampleRate = (job.pluginSampleRate > 0) ? job.pluginSampleRate
+                                                : (job.sampleRate > 0) ? job.sampleRate : reader->sampleRate;
+        numChannels = static_cast<int>(reader->numChannels);
+        return true;
+    }
+
+    bool processCurrentJob()
+    {
+        if (config.hasInstrument)
+        {
+            return processWithInstrument();
+        }
+        else
+        {
+            return processAudioFile();
+        }
+    }
+
+    bool processWithInstrument()
+    {
+        std::cout << "=== Processing with Virtual Instrument ===" << std::endl;
+
+        double finalSampleRate = (config.sampleRate > 0) ? config.sampleRate : 44100.0;
+        double pluginSampleRate = (config.pluginSampleRate > 0) ? config.pluginSampleRate : finalSampleRate;
+        int finalBitDepth = (config.bitDepth > 0) ? config.bitDepth : 24;
+
+        std::cout << "Processing settings:" << std::endl;
+        std::cout << "  Sample rate: " << finalSampleRate << " Hz" << std::endl;
+        if (pluginSampleRate != finalSampleRate)
+            std::cout << "  Plugin sample rate: " << pluginSampleRate << " Hz" << std::endl;
+        std::cout << "  Bit depth: " << finalBitDepth << " bits" << std::endl;
+        std::cout << "  Buffer size: " << config.bufferSize << " samples" << std::endl;
+        std::cout << "  Instrument channels: " << config.instrumentChannels << std::endl;
+
+        if (!preparePluginChain(pluginSampleRate, config.instrumentChannels))
+        {
+            std::cerr << "Failed to initialize plugin chain" << std::endl;
+            return false;
+        }
+
+        resolveAutomation(pluginSampleRate);
+
+        // One compiled schedule per instrument, for the part of its file it is routed
+        // (compiled once per file, routing and format)
+        auto midiLoadStart = RenderProfiler::now();
+        instrumentSchedules.assign(config.plugins.size(), nullptr);
+
+        for (size_t pluginIndex = 0; pluginIndex < config.plugins.size(); ++pluginIndex)
+        {
+            const auto& pluginConfig = config.plugins[pluginIndex];
+
+            if (pluginConfig.isInstrument && pluginConfig.midiProbe)
+            {
+                // Generated in memory; a probe is a handful of events, so it is compiled per job
+                instrumentSchedules[pluginIndex] = pluginConfig.midiProbe->compile(pluginSampleRate, config.bufferSize);
+            }
+            else if (pluginConfig.isInstrument && pluginConfig.midiCapture)
+            {
+                instrumentSchedules[pluginIndex] = pluginConfig.midiCapture->compileContinuous(pluginSampleRate, config.bufferSize);
+            }
+            else if (pluginConfig.isInstrument && !pluginConfig.midiFile.isEmpty())
+            {
+                auto midiFilePath = pluginConfig.midiFile;
+                auto routing = pluginConfig.midiRouting;
+                auto blockSize = config.bufferSize;
+                auto* ingest = ingestCache;
+
+                auto schedule = scheduleCache->getOrCompile(juce::File(midiFilePath), routing.getDescription(),
+                                                            pluginSampleRate, blockSize,
+                    [midiFilePath, routing, pluginSampleRate, blockSize, ingest]() -> std::shared_ptr<MidiSchedule>
+                    {
+                        std::cout << "Loading MIDI sequence: " << midiFilePath;
+                        if (!routing.isEmpty())
+                            std::cout << " (" << routing.getDescription() << ")";
+                        std::cout << std::endl;
+
+                        // One parse of the file serves validation and every part compiled from it
+                        auto parsed = ingest->get(juce::File(midiFilePath));
+                        if (!parsed)
+                            return nullptr;
+
+                        if (HostLog::isEnabled(LogLevel::verbose))
+                        {
+                            juce::String problem;
+                            if (!MidiUtilities::validateMidiForVsti(*parsed, problem))
+                                std::cout << "MIDI validation: " << problem << std::endl;
+                        }
+
+                        SimpleMidiSequence sequence;
+                        if (!sequence.loadFrom(*parsed, midiFilePath, routing))
+                            return nullptr;
+
+                        return sequence.compile(pluginSampleRate, blockSize);
+                    });
+
+                if (!schedule)
+                {
+                    std::cerr << "Failed to load MIDI sequence for plugin " << pluginIndex << std::endl;
+                    return false;
+                }
+
+                instrumentSchedules[pluginIndex] = schedule;
+            }
+        }
+
+        profiler.addPhaseSince("midi_load", midiLoadStart);
+
+        // With auto tail the length is only an upper bound; the render stops once the chain falls silent
+        double renderLength = config.renderLength;
+        if (renderLength <= 0.0)
+        {
+            double midiLength = 0.0;
+            for (const auto& schedule : instrumentSchedules)
+                midiLength = schedule ? juce::jmax(midiLength, schedule->getLengthInSeconds()) : midiLength;
+
+            renderLength = midiLength + (config.autoTail ? config.maxTailSeconds : 2.0);
+        }
+
+        std::cout << "Render length: " << renderLength << " seconds" << std::endl;
+
+        auto totalSamples = static_cast<juce::int64>(renderLength * pluginSampleRate);
+        std::cout << "Total samples to render: " << totalSamples << std::endl;
+
+        if (fetchFromRenderCache(finalSampleRate, config.instrumentChannels, finalBitDepth, renderLength))
+            return true;
+
+        RenderOutputs outputs;
+        if (!outputs.open(config.outputs, pluginSampleRate, finalSampleRate, config.instrumentChannels,
+                          finalBitDepth, getWriterFifoSize()))
+        {
+            return false;
+        }
+
+        renderInstrumentChain(outputs, pluginSampleRate, totalSamples, renderLength);
+
+        bool rc = finishAudioFile(outputs);
+        std::cout << "Audio processing completed!" << std::endl;
+        return rc;
+    }
+
+    bool processAudioFile()
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        juce::File inputFile(config.inputFile);
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+
+        if (!reader)
+        {
+            std::cerr << "Could not read input file: " << config.inputFile << std::endl;
+            return false;
+        }
+
+        auto numChannels = static_cast<int>(reader->numChannels);
+        auto numSamples = reader->lengthInSamples;
+
+        double finalSampleRate = (config.sampleRate > 0) ? config.sampleRate : reader->sampleRate;
+        double pluginSampleRate = (config.pluginSampleRate > 0) ? config.pluginSampleRate : finalSampleRate;
+        int finalBitDepth = (config.bitDepth > 0) ? config.bitDepth : static_cast<int>(reader->bitsPerSample);
+
+        std::cout << "Input file info:" << std::endl;
+        std::cout << "  Sample rate: " << reader->sampleRate << " Hz" << std::endl;
+        std::cout << "  Bit depth: " << reader->bitsPerSample << " bits" << std::endl;
+        std::cout << "  Channels: " << numChannels << std::endl;
+        std::cout << "  Samples: " << numSamples << std::endl;
+
+        if (pluginSampleRate != finalSampleRate)
+            std::cout << "  Plugin sample rate: " << pluginSampleRate << " Hz" << std::endl;
+
+        if (!preparePluginChain(pluginSampleRate, numChannels))
+        {
+            std::cerr << "Failed to initialize plugin chain" << std::endl;
+            return false;
+        }
+
+        resolveAutomation(pluginSampleRate);
+        instrumentSchedules.clear();
+
+        if (fetchFromRenderCache(finalSampleRate, numChannels, finalBitDepth, 0.0))
+            return true;
+
+        RenderOutputs outputs;
+        if (!outputs.open(config.outputs, pluginSampleRate, finalSampleRate, numChannels,
+                          finalBitDepth, getWriterFifoSize()))
+        {
+            return false;
+        }
+
+        processAudioStream(*reader, pluginSampleRate, outputs);
+
+        bool rc = finishAudioFile(outputs);
+        std::cout << "Audio file processing completed!" << std::endl;
+        return rc;
+    }
+
+    // Looks the job up once the chain is configured, so the key sees the final
+    // plugin state. On a miss the key is kept and the finished render stored.
+    bool fetchFromRenderCache(double sampleRate, int numChannels, int bitDepth, double renderLength)
+    {
+        // Entries hold one file, so jobs with several outputs or stems always render
+        if (renderCache == nullptr || config.outputs.size() != 1)
+            return false;
+
+        const auto& output = config.outputs.front();
+        if (!output.isPlainMaster() || output.bitDepth > 0 || output.file != config.outputFile)
+            return false;
+
+        RenderProfiler::ScopedPhase lookupPhase(profiler, "render_cache");
+        renderCacheKey = computeRenderCacheKey(sampleRate, numChannels, bitDepth, renderLength);
+
+        RenderStats cachedStats;
+        if (!renderCache->fetch(renderCacheKey, juce::File(config.outputFile), cachedStats))
+            return false;
+
+        // An entry rendered without the requested analysis is rendered again;
+        // the writer replaces the placed file and the entry is stored anew
+        if (config.analyze && static_cast<int>(cachedStats.analysis["spectrum"]["fft_size"]) != config.analysisFftSize)
+            return false;
+
+        cachedStats.outputFile = config.outputFile;
+        cachedStats.cacheHit = true;
+        lastStats = cachedStats;
+
+        std::cout << "Render cache hit (" << renderCacheKey.substring(0, 16) << ") - skipping render" << std::endl;
+        return true;
+    }
+
+    juce::String computeRenderCacheKey(double sampleRate, int numChannels, int bitDepth, double renderLength) const
+    {
+        juce::MemoryOutputStream key;
+        key.writeString("VSTPluginHost render 2");
+
+        key.writeDouble(sampleRate);
+        key.writeDouble(config.pluginSampleRate);
+        key.writeInt(numChannels);
+        key.writeInt(bitDepth);
+        key.writeInt(config.bufferSize);
+        key.writeDouble(renderLength);
+        key.writeBool(config.splitAutomationBlocks);
+
+        if (config.blockSchedule.adaptive || config.blockSchedule.preRollSeconds > 0.0)
+            config.blockSchedule.writeTo(key);
+
+        key.writeBool(config.autoTail);
+        key.writeFloat(config.tailThresholdDb);
+        key.writeInt(config.tailHoldBlocks);
+        key.writeDouble(config.maxTailSeconds);
+        key.writeString(juce::File(config.outputFile).getFileExtension().toLowerCase());
+
+        if (config.outputs.front().processing.isActive())
+            config.outputs.front().processing.writeTo(key);
+
+        for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+        {
+            const auto& pluginConfig = config.plugins[pluginIndex];
+
+            RenderCache::writeFileIdentity(key, juce::File(pluginConfig.pluginPath));
+            key.writeString(pluginChain[pluginIndex]->getPluginDescription().createIdentifierString());
+            key.writeBool(pluginConfig.isInstrument);
+
+            if (config.hasInstrument && pluginIndex < instrumentSchedules.size() && instrumentSchedules[pluginIndex])
+                instrumentSchedules[pluginIndex]->writeTo(key);
+
+            juce::MemoryBlock state;
+            pluginChain[pluginIndex]->getStateInformation(state);
+            key.writeInt64(static_cast<juce::int64>(state.getSize()));
+            key << state;
+
+            for (const auto& lane : pluginConfig.automation)
+            {
+                key.writeString(lane.getDescription());
+                key.writeInt(static_cast<int>(lane.interpolation));
+
+                for (const auto& breakpoint : lane.breakpoints)
+                {
+                    key.writeDouble(breakpoint.time);
+                    key.writeFloat(breakpoint.value);
+                }
+            }
+        }
+
+        for (const auto& edge : config.graph.edges)
+        {
+            key.writeInt(edge.from);
+            key.writeInt(edge.to);
+            key.writeFloat(edge.gain);
+        }
+
+        if (!config.hasInstrument && config.inputFile.isNotEmpty())
+            RenderCache::writeFileIdentity(key, juce::File(config.inputFile));
+
+        return RenderCache::createKey(key);
+    }
+
+    // Renders block by block straight into the output writers; only one block of
+    // audio is held by the host regardless of the render length.
+    void renderInstrumentChain(RenderOutputs& outputs, double sampleRate, juce::int64 totalSamples, double renderLength)
+    {
+        auto numChannels = config.instrumentChannels;
+        auto blockSize = startBlockSchedule(sampleRate, numChannels);
+        const bool adaptive = config.blockSchedule.adaptive;
+        const bool verbose = HostLog::isEnabled(LogLevel::verbose);
+
+        if (verbose)
+        {
+            std::cout << "\n=== RENDER DEBUG INFO ===" << std::endl;
+            std::cout << "Rendering instrument chain..." << std::endl;
+            std::cout << "  Total samples: " << totalSamples << std::endl;
+            std::cout << "  Block size: " << blockSize << std::endl;
+            std::cout << "  Channels: " << numChannels << std::endl;
+            std::cout << "  Sample rate: " << sampleRate << " Hz" << std::endl;
+            std::cout << "  Render length: " << renderLength << " seconds" << std::endl;
+            std::cout << "  Total MIDI events: " << countMidiEventsBefore(totalSamples).total << std::endl;
+        }
+
+        int blocksWithAudio = 0;
+        int totalBlocks = 0;
+
+        juce::AudioBuffer<float> blockStorage(numChannels, blockSize);
+        std::vector<double> channelSumSquares(static_cast<size_t>(numChannels), 0.0);
+
+        // With tapped stems the outputs get one wide block: the chain output
+        // followed by a copy of each tapped plugin's output
+        const bool tapping = outputs.hasTaps();
+        auto streamChannels = outputs.getNumStreamChannels();
+        juce::AudioBuffer<float> streamStorage(tapping ? streamChannels : 0, tapping ? blockSize : 0);
+
+        // Reserved once so copying a block's events never allocates
+        size_t midiBlockBytes = 0;
+        juce::int64 lastMidiSample = 0;
+
+        for (const auto& schedule : instrumentSchedules)
+        {
+            if (schedule)
+            {
+                midiBlockBytes = juce::jmax(midiBlockBytes, schedule->getMaxBlockBytes());
+                lastMidiSample = juce::jmax(lastMidiSample, schedule->getLastEventPosition());
+            }
+        }
+
+        // An adaptive segment can straddle two compiled blocks
+        if (adaptive)
+            midiBlockBytes *= 2;
+
+        auto& midiBuffer = blockMidi;
+        midiBuffer.clear();
+        midiBuffer.ensureSize(midiBlockBytes);
+
+        juce::MidiBuffer emptyMidi;
+
+        const bool profiling = isProfiling();
+        if (profiling)
+        {
+            profiler.reset(pluginChain.size(), getExpectedBlocks(totalSamples, blockSize), sampleRate);
+            for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+                profiler.setPluginName(pluginIndex, pluginChain[pluginIndex]->getName());
+        }
+
+        const bool useGraph = !config.graph.isEmpty();
+        auto processGraphNode = prepareGraph(numChannels, midiBlockBytes, profiling);
+
+        juce::int64 samplesWritten = 0;
+
+        // Analysis sees exactly what is written: after auto tail, before any output resampling
+        if (config.analyze)
+            analyzer.prepare(sampleRate, numChannels, config.analysisFftSize);
+
+        auto writeBlock = [&](const juce::AudioBuffer<float>& buffer, int numSamples)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto channelRMS = static_cast<double>(buffer.getRMSLevel(ch, 0, numSamples));
+                channelSumSquares[static_cast<size_t>(ch)] += channelRMS * channelRMS * numSamples;
+            }
+
+            if (config.analyze)
+                analyzer.process(buffer, numSamples);
+
+            outputs.write(buffer, numSamples);
+            samplesWritten += numSamples;
+        };
+
+        // The hold is counted in buffer_size blocks, so it lasts as long whatever size the blocks grow to
+        auto tailThresholdGain = juce::Decibels::decibelsToGain(config.tailThresholdDb);
+        juce::AudioBuffer<float> tailStorage(streamChannels, config.autoTail ? config.bufferSize * config.tailHoldBlocks + blockSize : 0);
+        int pendingTailSamples = 0;
+        int pendingTailBlocks = 0;
+        bool autoTailStopped = false;
+
+        auto renderStart = RenderProfiler::now();
+
+        for (juce::int64 startSample = 0; startSample < totalSamples; startSample += blockSize)
+        {
+            auto samplesToProcess = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize), totalSamples - startSample));
+
+            // Cleared through the storage: clear() on the alias would flag it as silent,
+            // and the plugins write through segment aliases that never reset that flag
+            blockStorage.clear(0, samplesToProcess);
+
+            juce::AudioBuffer<float> blockBuffer(blockStorage.getArrayOfWritePointers(),
+                                               numChannels,
+                                               0,
+                                               samplesToProcess);
+
+            float postInstrumentLevel = 0.0f;
+
+            // A block is one segment unless automation_split_blocks cuts it at
+            // breakpoints, or adaptive blocks cut it at MIDI events
+            for (int segmentStart = 0; segmentStart < samplesToProcess;)
+            {
+                auto segmentPosition = startSample + segmentStart;
+                auto segmentLength = samplesToProcess - segmentStart;
+
+                if (adaptive)
+                    segmentLength = getSamplesUntilNextEvent(segmentPosition, segmentLength);
+
+                if (!automation.isEmpty())
+                {
+                    automation.apply(segmentPosition / sampleRate);
+
+                    if (config.splitAutomationBlocks)
+                        segmentLength = automation.getSamplesUntilNextBreakpoint(segmentPosition, segmentLength);
+                }
+
+                juce::AudioBuffer<float> segmentBuffer(blockStorage.getArrayOfWritePointers(),
+                                                     numChannels,
+                                                     segmentStart,
+                                                     segmentLength);
+
+                if (useGraph)
+                {
+                    graphSegmentPosition = segmentPosition;
+                    chainGraph.process(segmentBuffer, segmentLength, processGraphNode);
+
+                    for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+                    {
+                        const auto& nodeOutput = chainGraph.getNodeOutput(pluginIndex);
+
+                        if (config.plugins[pluginIndex].isInstrument)
+                            postInstrumentLevel = juce::jmax(postInstrumentLevel, nodeOutput.getRMSLevel(0, 0, segmentLength));
+
+                        if (tapping)
+                            copyToTap(streamStorage, outputs.getTapGroup(pluginIndex), nodeOutput, segmentStart, segmentLength);
+                    }
+                }
+
+                for (size_t pluginIndex = 0; !useGraph && pluginIndex < pluginChain.size(); ++pluginIndex)
+                {
+                    auto& plugin = pluginChain[pluginIndex];
+                    auto blockStart = profiling ? RenderProfiler::now() : 0;
+
+                    if (config.plugins[pluginIndex].isInstrument)
+                    {
+                        if (const auto& schedule = instrumentSchedules[pluginIndex])
+                            schedule->fillBlock(midiBuffer, segmentPosition, segmentLength);
+                        else
+                            midiBuffer.clear();
+
+                        plugin->processBlock(segmentBuffer, midiBuffer);
+
+                        if (profiling)
+                            profiler.addBlock(pluginIndex, blockStart, RenderProfiler::now(), segmentLength);
+
+                        postInstrumentLevel = juce::jmax(postInstrumentLevel, segmentBuffer.getRMSLevel(0, 0, segmentLength));
+
+                        midiBuffer.clear();
+                    }
+                    else
+                    {
+                        emptyMidi.clear();
+                        plugin->processBlock(segmentBuffer, emptyMidi);
+
+                        if (profiling)
+                            profiler.addBlock(pluginIndex, blockStart, RenderProfiler::now(), segmentLength);
+                    }
+
+                    if (tapping)
+                        copyToTap(streamStorage, outputs.getTapGroup(pluginIndex), segmentBuffer, segmentStart, segmentLength);
+                }
+
+                segmentStart += segmentLength;
+            }
+
+            if (postInstrumentLevel > 0.001f)
+            {
+                blocksWithAudio++;
+            }
+
+            totalBlocks++;
+
+            juce::AudioBuffer<float> streamBlock(tapping ? streamStorage.getArrayOfWritePointers() : blockStorage.getArrayOfWritePointers(),
+                                                 streamChannels,
+                                                 0,
+                                                 samplesToProcess);
+            if (tapping)
+                copyToTap(streamStorage, 0, blockBuffer, 0, samplesToProcess);
+
+            // Auto tail: silent blocks after the last MIDI event are held back,
+            // and the render ends when holdBlocks of them arrive in a row
+            if (config.autoTail && startSample > lastMidiSample)
+            {
+                if (isBelowTailThreshold(blockBuffer, samplesToProcess, tailThresholdGain))
+                {
+                    for (int ch = 0; ch < streamChannels; ++ch)
+                        tailStorage.copyFrom(ch, pendingTailSamples, streamBlock, ch, 0, samplesToProcess);
+
+                    pendingTailSamples += samplesToProcess;
+                    pendingTailBlocks += (samplesToProcess + config.bufferSize - 1) / config.bufferSize;
+
+                    // The held blocks are never written, which trims the file at the start of the silence
+                    if (pendingTailBlocks >= config.tailHoldBlocks)
+                    {
+                        autoTailStopped = true;
+                        break;
+                    }
+
+                    continue;
+                }
+
+                if (pendingTailSamples > 0)
+                {
+                    juce::AudioBuffer<float> pending(tailStorage.getArrayOfWritePointers(), streamChannels, 0, pendingTailSamples);
+                    writeBlock(pending, pendingTailSamples);
+                    pendingTailSamples = 0;
+                    pendingTailBlocks = 0;
+                }
+            }
+
+            writeBlock(streamBlock, samplesToProcess);
+
+            if (verbose && startSample % (static_cast<juce::int64>(blockSize) * 200) == 0)
+            {
+                double progress = (double)startSample / totalSamples * 100.0;
+                std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress << "%\n";
+            }
+        }
+
+        // Reached the length limit while holding quiet blocks: keep them, the tail never settled
+        if (!autoTailStopped && pendingTailSamples > 0)
+        {
+            juce::AudioBuffer<float> pending(tailStorage.getArrayOfWritePointers(), streamChannels, 0, pendingTailSamples);
+            writeBlock(pending, pendingTailSamples);
+        }
+
+        profiler.addPhaseSince("render", renderStart);
+
+        auto sentEvents = countMidiEventsBefore(totalSamples);
+
+        lastStats.sampleRate = sampleRate;
+        lastStats.samplesRendered = samplesWritten;
+
+        if (config.analyze)
+            lastStats.analysis = analyzer.toVar();
+        lastStats.totalBlocks = totalBlocks;
+        lastStats.blockSize = blockSize;
+        lastStats.blocksWithAudio = blocksWithAudio;
+        lastStats.midiEvents = sentEvents.total;
+        lastStats.noteOns = sentEvents.noteOns;
+        lastStats.noteOffs = sentEvents.noteOffs;
+        lastStats.channelRms = getChannelRms(channelSumSquares, samplesWritten);
+        lastStats.autoTailStopped = autoTailStopped;
+
+        if (autoTailStopped)
+        {
+            std::cout << "Auto tail: output below " << config.tailThresholdDb << " dBFS for " << config.tailHoldBlocks
+                      << " blocks - stopped at " << std::fixed << std::setprecision(3) << (samplesWritten / sampleRate)
+                      << "s of " << (totalSamples / sampleRate) << "s" << std::endl;
+        }
+
+        if (verbose)
+        {
+            std::cout << "\n=== RENDER SUMMARY ===" << std::endl;
+            std::cout << "Total MIDI events processed: " << sentEvents.total << std::endl;
+            std::cout << "Note On events sent: " << sentEvents.noteOns << std::endl;
+            std::cout << "Note Off events sent: " << sentEvents.noteOffs << std::endl;
+            std::cout << "Blocks with audio content: " << blocksWithAudio << std::endl;
+            std::cout << "Plugins in chain: " << pluginChain.size() << std::endl;
+
+            for (size_t ch = 0; ch < lastStats.channelRms.size(); ++ch)
+            {
+                std::cout << "Channel " << ch << " RMS level: " << std::fixed << std::setprecision(4) << lastStats.channelRms[ch] << std::endl;
+            }
+
+            std::cout << "=== END RENDER ===" << std::endl;
+        }
+
+        if (!lastStats.hasAudio())
+        {
+            std::cout << "*** PROBLEM: No audio content in final buffer! ***" << std::endl;
+        }
+    }
+
+    static bool isBelowTailThreshold(const juce::AudioBuffer<float>& buffer, int numSamples, float thresholdGain)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            if (buffer.getMagnitude(ch, 0, numSamples) >= thresholdGain)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Channel group 0 of the output stream is the chain output, group n the nth tap
+    static void copyToTap(juce::AudioBuffer<float>& stream, int group, const juce::AudioBuffer<float>& source,
+                          int destStartSample, int numSamples)
+    {
+        if (group < 0)
+            return;
+
+        for (int ch = 0; ch < source.getNumChannels(); ++ch)
+            stream.copyFrom(group * source.getNumChannels() + ch, destStartSample, source, ch, 0, numSamples);
+    }
+
+    // Blocks the profiler reserves for: adaptive blocks are also cut at every
+    // MIDI event, so a render can have up to one segment more per event
+    size_t getExpectedBlocks(juce::int64 numSamples, int blockSize) const
+    {
+        auto blocks = static_cast<size_t>(numSamples / blockSize + 1);
+
+        if (config.blockSchedule.adaptive)
+            blocks += static_cast<size_t>(countMidiEventsBefore(numSamples).total);
+
+        return blocks;
+    }
+
+    // Events of every instrument's schedule that land before endSample
+    MidiSchedule::EventCounts countMidiEventsBefore(juce::int64 endSample) const
+    {
+        MidiSchedule::EventCounts counts;
+
+        for (const auto& schedule : instrumentSchedules)
+        {
+            if (schedule)
+            {
+                auto scheduleCounts = schedule->countEventsBefore(endSample);
+                counts.total += scheduleCounts.total;
+                counts.noteOns += scheduleCounts.noteOns;
+                counts.noteOffs += scheduleCounts.noteOffs;
+            }
+        }
+
+        return counts;
+    }
+
+    // Sets the graph up for the current job and returns the per-node callback.
+    // Each instrument fills its own MIDI buffer, so nodes of one level can run at once.
+    ChainGraph::NodeProcessor prepareGraph(int numChannels, size_t midiBytes, bool profiling)
+    {
+        if (config.graph.isEmpty())
+            return {};
+
+        chainGraph.prepare(config.graph, pluginChain.size(), numChannels, renderBlockSize);
+
+        nodeMidi.resize(pluginChain.size());
+        for (auto& midi : nodeMidi)
+            midi.ensureSize(midiBytes);
+
+        std::cout << "Plugin graph: " << config.graph.edges.size() << " edges in "
+                  << chainGraph.getNumLevels() << " levels" << std::endl;
+
+        return [this, profiling](size_t pluginIndex, juce::AudioBuffer<float>& buffer)
+        {
+            auto& midi = nodeMidi[pluginIndex];
+            midi.clear();
+
+            if (config.plugins[pluginIndex].isInstrument && instrumentSchedules[pluginIndex])
+                instrumentSchedules[pluginIndex]->fillBlock(midi, graphSegmentPosition, buffer.getNumSamples());
+
+            auto blockStart = profiling ? RenderProfiler::now() : 0;
+            pluginChain[pluginIndex]->processBlock(buffer, midi);
+
+            if (profiling)
+                profiler.addBlock(pluginIndex, blockStart, RenderProfiler::now(), buffer.getNumSamples());
+        };
+    }
+
+    static std::vector<float> getChannelRms(const std::vector<double>& channelSumSquares, juce::int64 numSamples)
+    {
+        std::vector<float> channelRms;
+
+        for (auto sumSquares : channelSumSquares)
+            channelRms.push_back(numSamples > 0 ? static_cast<float>(std::sqrt(sumSquares / static_cast<double>(numSamples))) : 0.0f);
+
+        return channelRms;
+    }
+
+    // Makes the chain ready for the current job. The first job scans and
+    // instantiates the plugins; later jobs in a batch reuse the warm instances,
+    // restoring the state captured at load time before the job's own settings
+    // are applied.
+    bool preparePluginChain(double sampleRate, int numChannels)
+    {
+        if (!pluginChain.empty() && isChainPreparedFor(sampleRate, numChannels))
+        {
+            RenderProfiler::ScopedPhase resetPhase(profiler, "chain_reset");
+            resetPluginChain();
+        }
+        else
+        {
+            if (!chainLoadAllowed)
+            {
+                std::cerr << "Plugin chain is not loaded for this job's channel layout, sample rate and block size" << std::endl;
+                return false;
+            }
+
+            if (!pluginChain.empty())
+            {
+                std::cout << "Channel layout, sample rate or block size changed - reloading plugin chain" << std::endl;
+                releasePlugins();
+            }
+
+            if (!initializePlugins(sampleRate, numChannels))
+            {
+                releasePlugins();
+                return false;
+            }
+
+            chainSampleRate = sampleRate;
+            chainNumChannels = numChannels;
+            chainBlockSize = getPreparedBlockSize();
+            chainLoadedForJob = true;
+        }
+
+        for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+        {
+            std::cout << "=== Configuring Plugin " << (pluginIndex + 1) << " ===" << std::endl;
+            applyPluginSettings(pluginChain[pluginIndex].get(), config.plugins[pluginIndex], *parameterIndexes[pluginIndex]);
+
+            std::cout << "=========================" << std::endl << std::endl;
+        }
+
+        return true;
+    }
+
+    // Binds every automation lane to its parameter object up front, so the
+    // render loop never matches names. Lanes that match nothing are skipped.
+    void resolveAutomation(double sampleRate)
+    {
+        automation.clear();
+
+        for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+        {
+            const auto& params = pluginChain[pluginIndex]->getParameters();
+
+            for (const auto& lane : config.plugins[pluginIndex].automation)
+            {
+                auto parameterIndex = findParameterIndex(*parameterIndexes[pluginIndex], lane);
+
+                if (parameterIndex < 0)
+                {
+                    std::cerr << "Automation: parameter '" << lane.getDescription() << "' not found in "
+                              << pluginChain[pluginIndex]->getName() << " - lane skipped" << std::endl;
+                    continue;
+                }
+
+                std::cout << "Automation: " << lane.getDescription() << " -> [" << parameterIndex << "] "
+                          << parameterIndexes[pluginIndex]->getName(parameterIndex) << " (" << lane.breakpoints.size() << " points)" << std::endl;
+
+                automation.addTarget(params[parameterIndex], lane);
+            }
+        }
+
+        automation.prepare(sampleRate);
+    }
+
+    // Index lanes are taken as-is; names prefer an exact match over a partial one
+    static int findParameterIndex(const ParameterIndex& parameterIndex, const AutomationLane& lane)
+    {
+        if (lane.parameterIndex >= 0)
+            return lane.parameterIndex < parameterIndex.size() ? lane.parameterIndex : -1;
+
+        return parameterIndex.find(lane.parameterName);
+    }
+
+    void resetPluginChain()
+    {
+        std::cout << "Reusing " << pluginChain.size() << " loaded plugin(s) - restoring initial state" << std::endl;
+
+        for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+        {
+            auto& plugin = pluginChain[pluginIndex];
+            const auto& pristineState = pristineStates[pluginIndex];
+
+            if (pristineState.getSize() > 0)
+                plugin->setStateInformation(pristineState.getData(), static_cast<int>(pristineState.getSize()));
+
+            plugin->reset();
+        }
+    }
+
+    bool initializePlugins(double sampleRate, int numChannels)
+    {
+        chainLoadPhases.clear();
+
+        if (pluginFormatManager.getNumFormats() == 0)
+            pluginFormatManager.addDefaultFormats();
+
+        std::cout << "Found " << pluginFormatManager.getFormats().size() << " plugin formats:" << std::endl;
+        for (auto* format : pluginFormatManager.getFormats())
+        {
+            std::cout << "  - " << format->getName() << std::endl;
+        }
+        std::cout << std::endl;
+
+        for (size_t configIndex = 0; configIndex < config.plugins.size(); ++configIndex)
+        {
+            const auto& pluginConfig = config.plugins[configIndex];
+
+            std::cout << "=== Loading Plugin " << (configIndex + 1) << " ===" << std::endl;
+            std::cout << "Plugin path: " << pluginConfig.pluginPath << std::endl;
+            std::cout << "Is instrument: " << (pluginConfig.isInstrument ? "YES" : "NO") << std::endl;
+
+            auto pluginFile = PluginLoader::resolvePluginFile(pluginConfig.pluginPath);
+            if (!pluginFile.exists())
+            {
+                std::cerr << "Plugin path not found: " << pluginConfig.pluginPath << std::endl;
+                return false;
+            }
+
+            juce::OwnedArray<juce::PluginDescription> descriptions;
+            bool usedScanCache = false;
+            auto scanStart = RenderProfiler::now();
+
+            if (!loader.findDescriptions(pluginFile, descriptions, usedScanCache))
+            {
+                std::cerr << "No valid plugin found in file: " << pluginConfig.pluginPath << std::endl;
+                return false;
+            }
+
+            RenderProfiler::addPhase(chainLoadPhases, usedScanCache ? "scan_cached" : "scan", RenderProfiler::secondsSince(scanStart));
+
+            auto* selectedDescription = PluginLoader::selectDescription(descriptions, pluginConfig.pluginName,
+                                                                        pluginConfig.isInstrument);
+            if (!selectedDescription)
+            {
+                std::cerr << "Could not select appropriate plugin" << std::endl;
+                return false;
+            }
+
+            std::cout << "Selected plugin: " << selectedDescription->name << std::endl;
+
+            juce::String errorMessage;
+            auto instantiateStart = RenderProfiler::now();
+            auto plugin = loader.createInstance(*selectedDescription, sampleRate, getPreparedBlockSize(), errorMessage);
+
+            if (!plugin)
+            {
+                std::cerr << "Failed to load plugin: " << errorMessage << std::endl;
+                return false;
+            }
+
+            std::cout << "Successfully created plugin instance!" << std::endl;
+            std::cout << "  Accepts MIDI: " << (plugin->acceptsMidi() ? "YES" : "NO") << std::endl;
+
+            plugin->prepareToPlay(sampleRate, getPreparedBlockSize());
+
+            int inputChannels = pluginConfig.isInstrument ? 0 : numChannels;
+            int outputChannels = pluginConfig.isInstrument ? config.instrumentChannels : numChannels;
+            plugin->setPlayConfigDetails(inputChannels, outputChannels, sampleRate, getPreparedBlockSize());
+
+            juce::MemoryBlock pristineState;
+            plugin->getStateInformation(pristineState);
+            pristineStates.push_back(std::move(pristineState));
+            parameterIndexes.push_back(parameterCache->getIndex(*plugin));
+
+            pluginChain.push_back(std::move(plugin));
+            RenderProfiler::addPhase(chainLoadPhases, "instantiate", RenderProfiler::secondsSince(instantiateStart));
+
+            std::cout << "Plugin added to chain successfully!" << std::endl;
+            std::cout << "=========================" << std::endl << std::endl;
+        }
+
+        loader.saveScanCache();
+        parameterCache->save();
+
+        std::cout << "Total plugins in chain: " << pluginChain.size() << std::endl;
+        return true;
+    }
+
+    void applyPluginSettings(juce::AudioPluginInstance* plugin, const PluginConfig& pluginConfig,
+                             const ParameterIndex& parameterIndex)
+    {
+        // *** ENUMERATE PARAMETERS BEFORE ANY CHANGES ***
+        if (HostLog::isEnabled(LogLevel::verbose))
+        {
+            std::cout << "\n=== INITIAL PLUGIN STATE ===" << std::endl;
+            PluginParameterManager::enumerateParameters(plugin);
+        }
+
+        // Save default state if requested
+        if (pluginConfig.saveDefaultState || !pluginConfig.saveStateTo.isEmpty())
+        {
+            juce::String defaultStatePath = pluginConfig.saveStateTo.isEmpty() ?
+                ("/tmp/" + plugin->getName().replace(" ", "_") + "_default_state.bin") :
+                pluginConfig.saveStateTo + "_default";
+
+            savePluginState(plugin, defaultStatePath, pluginConfig.saveStateDumps);
+        }
+
+        // Export parameters if requested (before changes)
+        if (!pluginConfig.parametersBefore.isEmpty())
+        {
+            PluginParameterManager::exportParametersToJson(plugin, pluginConfig.parametersBefore);
+        }
+
+        // Show program information
+        PluginParameterManager::monitorProgramChanges(plugin);
+
+        // Load state from file if specified (this is our new primary method)
+        if (!pluginConfig.loadStateFrom.isEmpty())
+        {
+            RenderProfiler::ScopedPhase statePhase(profiler, "state_load");
+            std::cout << "\n=== LOADING STATE FROM FILE ===" << std::endl;
+            juce::File stateFile(pluginConfig.loadStateFrom);
+            if (stateFile.existsAsFile())
+            {
+                juce::MemoryBlock stateData;
+                if (stateFile.loadFileAsData(stateData))
+                {
+                    std::cout << "Loading state from: " << pluginConfig.loadStateFrom << std::endl;
+                    std::cout << "State file size: " << stateData.getSize() << " bytes" << std::endl;
+
+                    try
+                    {
+                        plugin->setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+                        std::cout << "State loaded successfully from binary file!" << std::endl;
+
+                        // Re-enumerate parameters after state change
+                        if (HostLog::isEnabled(LogLevel::verbose))
+                        {
+                            std::cout << "\n--- Parameters after state loading ---" << std::endl;
+                            PluginParameterManager::enumerateParameters(plugin);
+                        }
+                    }
+                    catch (...)
+                    {
+                        std::cout << "Failed to load state from file" << std::endl;
+                    }
+                }
+                else
+                {
+                    std::cout << "Could not read state file data" << std::endl;
+                }
+            }
+            else
+            {
+                std::cout << "State file does not exist: " << pluginConfig.loadStateFrom << std::endl;
+            }
+            std::cout << "===============================" << std::endl;
+        }
+
+        // Set program if specified
+        if (pluginConfig.programNumber >= 0)
+        {
+            if (plugin->getNumPrograms() > pluginConfig.programNumber)
+            {
+                RenderProfiler::ScopedPhase programPhase(profiler, "program_change");
+                int oldProgram = plugin->getCurrentProgram();
+                plugin->setCurrentProgram(pluginConfig.programNumber);
+
+                std::cout << "\n=== PROGRAM CHANGE ===" << std::endl;
+                std::cout << "Changed from program " << oldProgram
+                          << " (\"" << plugin->getProgramName(oldProgram) << "\")" << std::endl;
+                std::cout << "             to program " << pluginConfig.programNumber
+                          << " (\"" << plugin->getProgramName(pluginConfig.programNumber) << "\")" << std::endl;
+                std::cout << "====================" << std::endl;
+
+                // Save state after program change if requested
+                if (!pluginConfig.saveStateTo.isEmpty())
+                {
+                    juce::String programStatePath = pluginConfig.saveStateTo + "_program_" + juce::String(pluginConfig.programNumber);
+                    savePluginState(plugin, programStatePath, pluginConfig.saveStateDumps);
+                }
+            }
+            else
+            {
+                std::cout << "Warning: Program " << pluginConfig.programNumber
+                          << " not available (max: " << (plugin->getNumPrograms() - 1) << ")" << std::endl;
+            }
+        }
+
+        // Handle SysEx if specified
+        if (!pluginConfig.sysexFile.isEmpty())
+        {
+            RenderProfiler::ScopedPhase sysexPhase(profiler, "sysex_load");
+            std::cout << "Loading SysEx file: " << pluginConfig.sysexFile << std::endl;
+            if (loadSysExPatch(plugin, pluginConfig.sysexFile, pluginConfig.sysexPatchNumber))
+            {
+                std::cout << "SysEx patch loaded successfully" << std::endl;
+
+                // Save state after SysEx loading if requested
+                if (!pluginConfig.saveStateTo.isEmpty())
+                {
+                    juce::String sysexStatePath = pluginConfig.saveStateTo + "_sysex_" + juce::String(pluginConfig.sysexPatchNumber);
+                    savePluginState(plugin, sysexStatePath, pluginConfig.saveStateDumps);
+                }
+            }
+            else
+            {
+                std::cout << "Warning: Could not load SysEx patch" << std::endl;
+            }
+        }
+
+        // Load preset if specified (fallback method)
+        if (!pluginConfig.presetPath.isEmpty())
+        {
+            RenderProfiler::ScopedPhase presetPhase(profiler, "preset_load");
+            bool presetLoaded = loadPresetWithSnapshots(plugin, pluginConfig.presetPath);
+            if (presetLoaded)
+            {
+                if (HostLog::isEnabled(LogLevel::verbose))
+                {
+                    std::cout << "Preset loaded - checking parameter changes..." << std::endl;
+                    PluginParameterManager::enumerateParameters(plugin);
+                }
+
+                // Save state after preset loading if requested
+                if (!pluginConfig.saveStateTo.isEmpty())
+                {
+                    juce::String presetStatePath = pluginConfig.saveStateTo + "_preset";
+                    savePluginState(plugin, presetStatePath, pluginConfig.saveStateDumps);
+                }
+            }
+        }
+
+        // Set individual parameters if specified
+        if (pluginConfig.parameters.isObject())
+        {
+            RenderProfiler::ScopedPhase parameterPhase(profiler, "parameters");
+            std::cout << "\n=== APPLYING INDIVIDUAL PARAMETERS ===" << std::endl;
+            setPluginParameters(plugin, parameterIndex, pluginConfig.parameters);
+            std::cout << "=====================================" << std::endl;
+
+            // Save state after parameter changes if requested
+            if (!pluginConfig.saveStateTo.isEmpty())
+            {
+                juce::String paramStatePath = pluginConfig.saveStateTo + "_after_params";
+                savePluginState(plugin, paramStatePath, pluginConfig.saveStateDumps);
+            }
+        }
+
+        // *** SHOW FINAL STATE ***
+        if (HostLog::isEnabled(LogLevel::verbose))
+        {
+            std::cout << "\n=== FINAL PLUGIN STATE ===" << std::endl;
+            PluginParameterManager::monitorProgramChanges(plugin);
+        }
+
+        // Export parameters if requested (after changes)
+        if (!pluginConfig.parametersAfter.isEmpty())
+        {
+            PluginParameterManager::exportParametersToJson(plugin, pluginConfig.parametersAfter);
+        }
+
+        // Save final state if requested
+        if (!pluginConfig.saveStateTo.isEmpty())
+        {
+            savePluginState(plugin, pluginConfig.saveStateTo + "_final", pluginConfig.saveStateDumps);
+        }
+    }
+
+    // Restores a preset from the snapshot store when it has been loaded before;
+    // otherwise probes the loading strategies and records the resulting state
+    bool loadPresetWithSnapshots(juce::AudioPluginInstance* plugin, const juce::String& presetPath)
+    {
+        if (snapshotStore == nullptr)
+        {
+            int strategyUsed = 0;
+            return loadPreset(plugin, presetPath, strategyUsed);
+        }
+
+        juce::File presetFile(presetPath);
+        if (!presetFile.existsAsFile())
+        {
+            std::cout << "Preset file does not exist: " << presetPath << std::endl;
+            return false;
+        }
+
+        juce::MemoryBlock stateBefore;
+        plugin->getStateInformation(stateBefore);
+
+        auto key = StateSnapshotStore::createKey(*plugin, presetFile, stateBefore);
+
+        if (auto strategy = snapshotStore->restore(key, *plugin))
+        {
+            std::cout << "Preset restored from snapshot store: " << presetPath
+                      << " (strategy " << strategy << ")" << std::endl;
+            return true;
+        }
+
+        int strategyUsed = 0;
+        if (!loadPreset(plugin, presetPath, strategyUsed))
+            return false;
+
+        juce::MemoryBlock stateAfter;
+        plugin->getStateInformation(stateAfter);
+
+        if (snapshotStore->add(key, strategyUsed, stateAfter))
+            std::cout << "Preset state recorded in snapshot store" << std::endl;
+
+        return true;
+    }
+
+    // Tries the loading strategies in turn; strategyUsed reports the one that worked (1, 2 or 4)
+    bool loadPreset(juce::AudioPluginInstance* plugin, const juce::String& presetPath, int& strategyUsed)
+    {
+        return PluginStateIO::loadPreset(*plugin, presetPath, strategyUsed,
+                                         HostLog::isEnabled(LogLevel::verbose), HostLog::isEnabled(LogLevel::debug));
+    }
+
+    // Add state saving utilities
+    bool savePluginState(juce::AudioPluginInstance* plugin, const juce::String& outputPath, bool writeDumps)
+    {
+        return PluginStateIO::saveState(*plugin, juce::File(outputPath), writeDumps);
+    }
+
+    // Names resolve through the plugin's cached index; the plugin is only asked
+    // for names again to print suggestions when one doesn't match
+    void setPluginParameters(juce::AudioPluginInstance* plugin, const ParameterIndex& parameterIndex,
+                             const juce::var& parameters)
+    {
+        if (!parameters.isObject())
+            return;
+
+        auto* paramObject = parameters.getDynamicObject();
+        if (!paramObject)
+            return;
+
+        auto& properties = paramObject->getProperties();
+        const bool verbose = HostLog::isEnabled(LogLevel::verbose);
+
+        std::cout << "Attempting to set " << properties.size() << " parameters:" << std::endl;
+
+        const auto& pluginParams = plugin->getParameters();
+
+        for (auto& prop : properties)
+        {
+            auto paramName = prop.name.toString();
+            auto requestedValue = static_cast<float>(prop.value);
+
+            if (verbose)
+                std::cout << "  Setting: " << paramName << " = " << requestedValue << std::endl;
+
+            // "#12" addresses a parameter by index, as in automation lanes and sweeps
+            int index = -1;
+            if (paramName.startsWithChar('#') && paramName.length() > 1 && paramName.substring(1).containsOnly("0123456789"))
+                index = paramName.substring(1).getIntValue();
+            else
+                index = parameterIndex.find(paramName);
+
+            if (index < 0 || index >= pluginParams.size())
+            {
+                std::cout << "    ✗ Parameter '" << paramName << "' not found" << std::endl;
+                std::cout << "      Suggestions:" << std::endl;
+
+                for (int i = 0; i < parameterIndex.size(); ++i)
+                {
+                    const auto& currentName = parameterIndex.getName(i);
+
+                    if (currentName.toLowerCase().contains(paramName.toLowerCase()) ||
+                        paramName.toLowerCase().contains(currentName.toLowerCase()))
+                    {
+                        std::cout << "        - \"" << currentName << "\" (index " << i << ")" << std::endl;
+                    }
+                }
+
+                continue;
+            }
+
+            auto* param = pluginParams[index];
+            const auto& currentName = parameterIndex.getName(index);
+            float oldValue = param->getValue();
+            param->setValue(requestedValue);
+            float newValue = param->getValue();
+
+            if (verbose)
+            {
+                std::cout << "    ✓ Parameter found: " << currentName << std::endl;
+                std::cout << "      Index: " << index << std::endl;
+                std::cout << "      Old value: " << oldValue << " (\"" << param->getText(oldValue, 256) << "\")" << std::endl;
+                std::cout << "      New value: " << newValue << " (\"" << param->getText(newValue, 256) << "\")" << std::endl;
+            }
+
+            // Special handling for program parameters
+            if (verbose && currentName.containsIgnoreCase("program") && plugin->getNumPrograms() > 0)
+            {
+                int oldProgram = static_cast<int>(oldValue * (plugin->getNumPrograms() - 1));
+                int newProgram = static_cast<int>(newValue * (plugin->getNumPrograms() - 1));
+
+                std::cout << "      OLD PROGRAM: [" << oldProgram << "] \"" << plugin->getProgramName(oldProgram) << "\"" << std::endl;
+                std::cout << "      NEW PROGRAM: [" << newProgram << "] \"" << plugin->getProgramName(newProgram) << "\"" << std::endl;
+            }
+        }
+    }
+
+    // Pulls the input file one block at a time, runs it through the chain and
+    // pushes it to the writers, so memory use is independent of the file length.
+    // Input at another rate than the chain's is converted on the way in.
+    void processAudioStream(juce::AudioFormatReader& reader, double sampleRate, RenderOutputs& outputs)
+    {
+        auto numChannels = static_cast<int>(reader.numChannels);
+        auto blockSize = startBlockSchedule(sampleRate, numChannels);
+
+        std::unique_ptr<ResamplingReader> resampledInput;
+        if (reader.sampleRate != sampleRate)
+        {
+            std::cout << "Resampling input: " << reader.sampleRate << " Hz -> " << sampleRate << " Hz" << std::endl;
+            resampledInput = std::make_unique<ResamplingReader>(reader, sampleRate, blockSize);
+        }
+
+        auto numSamples = resampledInput ? resampledInput->getLengthInSamples() : reader.lengthInSamples;
+
+        if (config.analyze)
+            analyzer.prepare(sampleRate, numChannels, config.analysisFftSize);
+
+        juce::AudioBuffer<float> blockStorage(numChannels, blockSize);
+        const bool tapping = outputs.hasTaps();
+        juce::AudioBuffer<float> streamStorage(tapping ? outputs.getNumStreamChannels() : 0, tapping ? blockSize : 0);
+        juce::MidiBuffer midiBuffer;
+        std::vector<double> channelSumSquares(static_cast<size_t>(numChannels), 0.0);
+        int totalBlocks = 0;
+
+        const bool profiling = isProfiling();
+        if (profiling)
+        {
+            profiler.reset(pluginChain.size(), getExpectedBlocks(numSamples, blockSize), sampleRate);
+            for (size_t pluginIndex = 0; pluginIndex < pluginChain.size(); ++pluginIndex)
+                profiler.setPluginName(pluginIndex, pluginChain[pluginIndex]->getName());
+        }
+
+        const bool useGraph = !config.graph.isEmpty();
+        auto processGraphNode = prepareGraph(numChannels, 0, profiling);
+
+        auto renderStart = RenderProfiler::now();
+
+        for (juce::int64 startSample = 0; startSample < numSamples; startSample += blockSize)
+        {
+            auto samplesToProcess = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize), numSamples - startSample));
+
+            juce::AudioBuffer<float> blockBuffer(blockStorage.getArrayOfWritePointers(),
+                                               numChannels,
+                                               0,
+                                               samplesToProcess);
+
+            if (resampledInput)
+                resampledInput->read(blockBuffer, samplesToProcess);
+            else
+                reader.read(&blockBuffer, 0, samplesToProcess, startSample, true, true);
+
+            if (!automation.isEmpty())
+                automation.apply(startSample / sampleRate);
+
+            if (useGraph)
+            {
+                chainGraph.process(blockBuffer, samplesToProcess, processGraphNode);
+
+                for (size_t pluginIndex = 0; tapping && pluginIndex < pluginChain.size(); ++pluginIndex)
+                    copyToTap(streamStorage, outputs.getTapGroup(pluginIndex), chainGraph.getNodeOutput(pluginIndex), 0, samplesToProcess);
+            }
+
+            for (size_t pluginIndex = 0; !useGraph && pluginIndex < pluginChain.size(); ++pluginIndex)
+            {
+                auto blockStart = profiling ? RenderProfiler::now() : 0;
+
+                midiBuffer.clear();
+                pluginChain[pluginIndex]->processBlock(blockBuffer, midiBuffer);
+
+                if (profiling)
+                    profiler.addBlock(pluginIndex, blockStart, RenderProfiler::now(), samplesToProcess);
+
+                if (tapping)
+                    copyToTap(streamStorage, outputs.getTapGroup(pluginIndex), blockBuffer, 0, samplesToProcess);
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto channelRMS = static_cast<double>(blockBuffer.getRMSLevel(ch, 0, samplesToProcess));
+                channelSumSquares[static_cast<size_t>(ch)] += channelRMS * channelRMS * samplesToProcess;
+            }
+
+            if (config.analyze)
+                analyzer.process(blockBuffer, samplesToProcess);
+
+            if (tapping)
+            {
+                copyToTap(streamStorage, 0, blockBuffer, 0, samplesToProcess);
+                outputs.write(streamStorage, samplesToProcess);
+            }
+            else
+            {
+                outputs.write(blockBuffer, samplesToProcess);
+            }
+
+            totalBlocks++;
+        }
+
+        profiler.addPhaseSince("render", renderStart);
+
+        lastStats.sampleRate = sampleRate;
+        lastStats.samplesRendered = numSamples;
+
+        if (config.analyze)
+            lastStats.analysis = analyzer.toVar();
+        lastStats.totalBlocks = totalBlocks;
+        lastStats.blockSize = blockSize;
+        lastStats.channelRms = getChannelRms(channelSumSquares, numSamples);
+
+        std::cout << "Processed " << numSamples << " samples through "
+                  << pluginChain.size() << " plugins" << std::endl;
+    }
+
+    // The FIFO holds a few blocks so the plugin chain never waits on disk I/O
+    int getWriterFifoSize() const
+    {
+        return juce::jmax(32768, getPreparedBlockSize() * 16);
+    }
+
+    // Picks the job's largest block, then runs the pre-roll. Called right before the first block is rendered.
+    int startBlockSchedule(double sampleRate, int numChannels)
+    {
+        renderBlockSize = chooseRenderBlockSize();
+
+        if (config.blockSchedule.adaptive)
+            std::cout << "Adaptive blocks: up to " << renderBlockSize << " samples" << std::endl;
+
+        runPreRoll(sampleRate, numChannels, renderBlockSize);
+        return renderBlockSize;
+    }
+
+    int chooseRenderBlockSize()
+    {
+        const auto& schedule = config.blockSchedule;
+
+        // Automation is applied per block, so its steps stay at buffer_size
+        if (!schedule.adaptive || !automation.isEmpty())
+            return config.bufferSize;
+
+        if (!schedule.isTuned())
+            return schedule.maxBlockSize;
+
+        if (!schedule.tuning.isVoid())
+            profiler.setBlockTuning(schedule.tuning);
+
+        // The host tunes before rendering; a job it didn't reach plays safe
+        return schedule.tunedBlockSize > 0 ? schedule.tunedBlockSize : config.bufferSize;
+    }
+
+    // Silence through every plugin, without MIDI, so the chain settles after its
+    // state load before the first block that is written
+    void runPreRoll(double sampleRate, int numChannels, int blockSize)
+    {
+        auto remaining = static_cast<juce::int64>(config.blockSchedule.preRollSeconds * sampleRate);
+        if (remaining <= 0)
+            return;
+
+        RenderProfiler::ScopedPhase preRollPhase(profiler, "pre_roll");
+        std::cout << "Pre-roll: " << config.blockSchedule.preRollSeconds << " seconds" << std::endl;
+
+        // Automated parameters settle on their starting values, not the preset's
+        if (!automation.isEmpty())
+            automation.apply(0.0);
+
+        juce::AudioBuffer<float> storage(numChannels, blockSize);
+        juce::MidiBuffer emptyMidi;
+
+        while (remaining > 0)
+        {
+            auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize), remaining));
+
+            // Each plugin gets silence of its own, so the graph and the series chain pre-roll alike
+            for (auto& plugin : pluginChain)
+            {
+                storage.clear();
+                juce::AudioBuffer<float> block(storage.getArrayOfWritePointers(), numChannels, 0, numSamples);
+                emptyMidi.clear();
+                plugin->processBlock(block, emptyMidi);
+            }
+
+            remaining -= numSamples;
+        }
+    }
+
+    // Adaptive blocks end where the next MIDI event of any instrument starts, so
+    // each event lands less than min_block_size into its segment
+    int getSamplesUntilNextEvent(juce::int64 position, int maxSamples) const
+    {
+        auto end = position + maxSamples;
+
+        for (const auto& schedule : instrumentSchedules)
+        {
+            if (!schedule)
+                continue;
+
+            auto next = schedule->getNextEventPosition(position + config.blockSchedule.minBlockSize);
+            if (next >= 0)
+                end = juce::jmin(end, next);
+        }
+
+        return static_cast<int>(end - position);
+    }
+
+    bool finishAudioFile(RenderOutputs& outputs)
+    {
+        bool allWritten;
+
+        {
+            RenderProfiler::ScopedPhase finalisePhase(profiler, "file_finalise");
+            allWritten = outputs.close();
+        }
+
+        // Levels were measured before the writer's gain and normalisation; report those of the file
+        auto gain = outputs.getAppliedGain(juce::File(config.outputFile));
+        if (gain != 1.0f)
+        {
+            for (auto& rms : lastStats.channelRms)
+                rms *= gain;
+
+            AudioAnalyzer::applyGain(lastStats.analysis, gain);
+        }
+
+        outputs.printSummary();
+        return allWritten;
+    }
+
+    bool loadSysExPatch(juce::AudioPluginInstance* plugin, const juce::String& sysexPath, int patchNumber)
+    {
+        auto bank = bankCache->getBank(juce::File(sysexPath));
+        if (!bank)
+            return false;
+
+        const auto& patches = bank->getPatches();
+
+        int targetPatch = (patchNumber >= 0) ? patchNumber : 0;
+        if (targetPatch >= static_cast<int>(patches.size()))
+        {
+            std::cout << "Warning: Patch " << targetPatch << " not available, using patch 0" << std::endl;
+            targetPatch = 0;
+        }
+
+        const auto& patch = patches[static_cast<size_t>(targetPatch)];
+        std::cout << "Loading patch " << targetPatch << ": " << patch.name << std::endl;
+
+        return sendSysExToPlugin(plugin, patch.data, patch.size);
+    }
+
+    bool sendSysExToPlugin(juce::AudioPluginInstance* plugin, const uint8_t* patchData, size_t patchSize)
+    {
+        if (!plugin || patchData == nullptr || patchSize == 0)
+            return false;
+
+        std::cout << "Sending SysEx patch to plugin (" << patchSize << " bytes)" << std::endl;
+
+        try
+        {
+            std::vector<uint8_t> sysexMessage;
+            sysexMessage.push_back(0xF0);
+            sysexMessage.push_back(0x43);
+            sysexMessage.push_back(0x00);
+            sysexMessage.push_back(0x00);
+            sysexMessage.push_back(0x01);
+            sysexMessage.push_back(0x1B);
+
+            size_t dataSize = std::min(static_cast<size_t>(128), patchSize);
+            for (size_t i = 0; i < dataSize; ++i)
+            {
+                sysexMessage.push_back(patchData[i]);
+            }
+
+            while (sysexMessage.size() < 134)
+            {
+                sysexMessage.push_back(0x00);
+            }
+
+            uint8_t checksum = 0;
+            for (size_t i = 6; i < sysexMessage.size(); ++i)
+            {
+                checksum += sysexMessage[i];
+            }
+            checksum = (~checksum + 1) & 0x7F;
+            sysexMessage.push_back(checksum);
+            sysexMessage.push_back(0xF7);
+
+            juce::MidiMessage midiSysEx(sysexMessage.data(), static_cast<int>(sysexMessage.size()));
+            juce::MidiBuffer midiBuffer;
+            midiBuffer.addEvent(midiSysEx, 0);
+
+            juce::AudioBuffer<float> audioBuffer(2, 512);
+            audioBuffer.clear();
+
+            juce::MemoryBlock stateBefore;
+            plugin->getStateInformation(stateBefore);
+
+            plugin->processBlock(audioBuffer, midiBuffer);
+
+            // Instead of a fixed sleep, keep processing empty blocks until the
+            // plugin's state shows the new voice. A voice identical to the
+            // current one never changes the state and simply runs to the timeout.
+            auto pollStart = juce::Time::getMillisecondCounterHiRes();
+            bool confirmed = false;
+
+            for (;;)
+            {
+                juce::MemoryBlock stateNow;
+                plugin->getStateInformation(stateNow);
+
+                if (stateNow != stateBefore)
+                {
+                    confirmed = true;
+                    break;
+                }
+
+                if (juce::Time::getMillisecondCounterHiRes() - pollStart >= sysexConfirmTimeoutMs)
+                    break;
+
+                juce::MidiBuffer emptyMidi;
+                audioBuffer.clear();
+                plugin->processBlock(audioBuffer, emptyMidi);
+                juce::Thread::sleep(1);
+            }
+
+            if (confirmed)
+                std::cout << "SysEx sent successfully (confirmed after " << std::fixed << std::setprecision(1)
+                          << (juce::Time::getMillisecondCounterHiRes() - pollStart) << " ms)" << std::endl;
+            else
+                std::cout << "SysEx sent - plugin state unchanged after " << sysexConfirmTimeoutMs << " ms" << std::endl;
+
+            return true;
+        }
+        catch (...)
+        {
+            std::cout << "Error sending SysEx to plugin" << std::endl;
+            return false;
+        }
+    }
+};
+
+//==============================================================================
+// Warm engine pool for server mode: engines keep their loaded plugin chains
+// between requests, keyed by the chain they hold. Once the pool is full the
+// least recently used engines release their plugins.
+//==============================================================================
+
+class RenderEnginePool
+{
+public:
+    void setMaxEngines(size_t newMaxEngines)
+    {
+        maxEngines = juce::jmax(static_cast<size_t>(1), newMaxEngines);
+        evictToLimit();
+    }
+
+    // Identifies a plugin chain. Plugin state is not part of the key: an engine
+    // restores each plugin's load-time state before applying a job's settings,
+    // so any job with the same plugins, rate and layout can reuse it.
+    static juce::String getChainKey(const ProcessingConfig& job)
+    {
+        juce::StringArray parts;
+        parts.add(juce::String(job.sampleRate) + "/" + juce::String(job.pluginSampleRate) + "/" + juce::String(job.instrumentChannels));
+
+        for (const auto& plugin : job.plugins)
+            parts.add(plugin.pluginPath + "|" + plugin.pluginName + (plugin.isInstrument ? "|i" : "|e"));
+
+        return parts.joinIntoString("\n");
+    }
+
+    // Removes and returns every pooled engine holding this chain, most recently used first
+    std::vector<std::unique_ptr<RenderEngine>> checkOut(const juce::String& chainKey)
+    {
+        std::vector<std::unique_ptr<RenderEngine>> result;
+
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->chainKey == chainKey)
+            {
+                result.push_back(std::move(it->engine));
+                it = entries.erase(it);
+                hits++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (result.empty())
+            misses++;
+
+        return result;
+    }
+
+    void checkIn(const juce::String& chainKey, std::vector<std::unique_ptr<RenderEngine>> engines)
+    {
+        for (auto it = engines.rbegin(); it != engines.rend(); ++it)
+            entries.push_front({ chainKey, std::move(*it) });
+
+        evictToLimit();
+    }
+
+    void clear()
+    {
+        for (auto& entry : entries)
+            entry.engine->releasePlugins();
+
+        entries.clear();
+    }
+
+    juce::var toVar() const
+    {
+        juce::var result(new juce::DynamicObject());
+        auto* object = result.getDynamicObject();
+
+        juce::Array<juce::var> chains;
+        for (const auto& entry : entries)
+            chains.add(entry.chainKey);
+
+        object->setProperty("engines", static_cast<int>(entries.size()));
+        object->setProperty("max_engines", static_cast<int>(maxEngines));
+        object->setProperty("hits", hits);
+        object->setProperty("misses", misses);
+        object->setProperty("evictions", evictions);
+        object->setProperty("chains", chains);
+        return result;
+    }
+
+private:
+    struct Entry
+    {
+        juce::String chainKey;
+        std::unique_ptr<RenderEngine> engine;
+    };
+
+    void evictToLimit()
+    {
+        while (entries.size() > maxEngines)
+        {
+            std::cout << "Engine pool full - releasing least recently used chain" << std::endl;
+            entries.back().engine->releasePlugins();
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    std::list<Entry> entries;   // most recently used first
+    size_t maxEngines = 4;
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+};
+
+//==============================================================================
+// Audio Plugin Host
+//==============================================================================
+
+class AudioPluginHost
+{
+public:
+    AudioPluginHost()
+    {
+        g_hostInstance = this;
+        std::cout << "[HOST] Constructor called" << std::endl;
+    }
+
+    // Skip destructor to avoid segfault
+    // ~AudioPluginHost() { }
+
+    // --rescan: ignore cached plugin scan results and refresh them
+    void setForceRescan(bool shouldRescan)
+    {
+        forceRescan = shouldRescan;
+    }
+
+    bool loadConfiguration(const juce::String& configPath)
+    {
+        juce::File configFile(configPath);
+        if (!configFile.existsAsFile())
+        {
+            std::cerr << "Configuration file not found: " << configPath << std::endl;
+            return false;
+        }
+
+        auto jsonText = configFile.loadFileAsString();
+        auto json = juce::JSON::parse(jsonText);
+
+        if (!json.isObject())
+        {
+            std::cerr << "Invalid JSON configuration" << std::endl;
+            return false;
+        }
+
+        return parseConfiguration(json);
+    }
+
+    bool processAudio()
+    {
+        if (processIsolation)
+            return processIsolated();
+
+        auto workerCount = static_cast<size_t>(getWorkerCount());
+
+        while (engines.size() < workerCount)
+        {
+            engines.push_back(std::make_unique<RenderEngine>(scanCache.get(), &scheduleCache, &bankCache));
+            engines.back()->setReportProfile(serverMode);
+        }
+
+        // Set on every run: pooled engines may have been created under another configuration
+        for (auto& engine : engines)
+        {
+            engine->setRenderCache(renderCache.get());
+            engine->setSnapshotStore(snapshotStore.get());
+            engine->setParameterIndexCache(parameterCache.get());
+            engine->setMidiIngestCache(midiIngestCache.get());
+        }
+
+        if (!tuneBlockSchedules())
+            return false;
+
+        auto batchStart = juce::Time::getMillisecondCounterHiRes();
+
+        // One slot per job, written only by the worker that rendered it
+        std::vector<RenderStats> jobStats(getNumJobs());
+
+        if (jobStats.size() == 1)
+        {
+            renderBatchJob(*engines.front(), 0);
+            jobStats.front() = engines.front()->getLastStats();
+
+            writeRenderSummary(jobStats, 1, (juce::Time::getMillisecondCounterHiRes() - batchStart) / 1000.0);
+            return jobStats.front().success;
+        }
+
+        std::cout << "=== BATCH RENDER: " << jobStats.size() << " jobs on "
+                  << workerCount << " worker(s) ===" << std::endl;
+
+        if (workerCount == 1)
+        {
+            for (size_t jobIndex = 0; jobIndex < jobStats.size(); ++jobIndex)
+            {
+                printJobHeader(jobIndex, 0);
+                renderBatchJob(*engines.front(), jobIndex);
+                jobStats[jobIndex] = engines.front()->getLastStats();
+            }
+        }
+        else
+        {
+            // Workers never instantiate plugins: the jobs are rendered one chain
+            // format at a time, and every engine is loaded for a format here on
+            // the main thread before the workers render its jobs
+            for (const auto& group : getFormatGroups())
+            {
+                for (size_t engineIndex = 0; engineIndex < engines.size(); ++engineIndex)
+                {
+                    std::cout << "=== Loading instance set " << (engineIndex + 1) << "/" << engines.size() << " ===" << std::endl;
+
+                    if (!engines[engineIndex]->loadPlugins(getJob(group.front())))
+                    {
+                        std::cerr << "Failed to load plugin chain for worker " << engineIndex << std::endl;
+                        return false;
+                    }
+                }
+
+                for (auto& engine : engines)
+                    engine->setChainLoadAllowed(false);
+
+                std::atomic<size_t> nextJob { 0 };
+                std::vector<std::thread> workers;
+
+                for (size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+                {
+                    workers.emplace_back([this, workerIndex, &group, &nextJob, &jobStats]()
+                    {
+                        for (auto groupIndex = nextJob++; groupIndex < group.size(); groupIndex = nextJob++)
+                        {
+                            auto jobIndex = group[groupIndex];
+                            printJobHeader(jobIndex, workerIndex);
+                            renderBatchJob(*engines[workerIndex], jobIndex);
+                            jobStats[jobIndex] = engines[workerIndex]->getLastStats();
+                        }
+                    });
+                }
+
+                for (auto& worker : workers)
+                    worker.join();
+
+                for (auto& engine : engines)
+                    engine->setChainLoadAllowed(true);
+            }
+        }
+
+        auto batchSeconds = (juce::Time::getMillisecondCounterHiRes() - batchStart) / 1000.0;
+        return reportBatch(jobStats, static_cast<int>(workerCount), batchSeconds);
+    }
+
+    // Probe jobs differ only in their sequence and file names, so jobs holds
+    // the first one as a template and each worker builds its probe job from it
+    size_t getNumJobs() const
+    {
+        return probeSet ? probeSet->size() : jobs.size();
+    }
+
+    void renderBatchJob(RenderEngine& engine, size_t jobIndex)
+    {
+        if (probeSet)
+            engine.renderJob(createProbeJob(jobIndex));
+        else
+            engine.renderJob(jobs[jobIndex]);
+    }
+
+    // Job indexes grouped by chain format, in order of each format's first job.
+    // Probe jobs all share the template's format. Jobs whose input can't be
+    // read join the first group and fail when they render.
+    std::vector<std::vector<size_t>> getFormatGroups() const
+    {
+        std::vector<std::vector<size_t>> groups;
+
+        if (probeSet)
+        {
+            groups.emplace_back(getNumJobs());
+            std::iota(groups.front().begin(), groups.front().end(), static_cast<size_t>(0));
+            return groups;
+        }
+
+        juce::StringArray formatKeys;
+        std::vector<size_t> unreadable;
+
+        for (size_t jobIndex = 0; jobIndex < jobs.size(); ++jobIndex)
+        {
+            auto formatKey = RenderEngine::getChainFormatKey(jobs[jobIndex]);
+            if (formatKey.isEmpty())
+            {
+                unreadable.push_back(jobIndex);
+                continue;
+            }
+
+            auto groupIndex = formatKeys.indexOf(formatKey);
+            if (groupIndex < 0)
+            {
+                groupIndex = formatKeys.size();
+                formatKeys.add(formatKey);
+                groups.emplace_back();
+            }
+
+            groups[static_cast<size_t>(groupIndex)].push_back(jobIndex);
+        }
+
+        if (groups.empty())
+            groups.emplace_back();
+
+        groups.front().insert(groups.front().end(), unreadable.begin(), unreadable.end());
+        return groups;
+    }
+
+    ProcessingConfig getJob(size_t jobIndex) const
+    {
+        return probeSet ? createProbeJob(jobIndex) : jobs[jobIndex];
+    }
+
+    juce::String getJobOutputFile(size_t jobIndex) const
+    {
+        return probeSet ? expandOutputPattern(jobs.front().outputFile, "probe", static_cast<int>(jobIndex), probeDigits)
+                        : jobs[jobIndex].outputFile;
+    }
+
+    // "max_block_size": "auto" is tuned once per batch, here on the main thread
+    // before any worker starts, and the size goes into every job. Engines timing
+    // the chain themselves while other workers load the machine could settle on
+    // different sizes, and the render cache keys the size actually used.
+    bool tuneBlockSchedules()
+    {
+        auto first = std::find_if(jobs.begin(), jobs.end(),
+                                  [](const ProcessingConfig& job) { return job.blockSchedule.needsTuning(); });
+        if (first == jobs.end())
+            return true;
+
+        auto& engine = *engines.front();
+        if (!engine.loadPlugins(*first))
+        {
+            std::cerr << "Failed to load plugin chain for block size tuning" << std::endl;
+            return false;
+        }
+
+        juce::var tuning;
+        auto blockSize = engine.tuneBlockSize(tuning);
+        std::cout << "Adaptive blocks: tuned to " << blockSize << " samples for " << getNumJobs() << " job(s)" << std::endl;
+
+        setTunedBlockSize(blockSize, tuning);
+        return true;
+    }
+
+    void setTunedBlockSize(int blockSize, const juce::var& tuning)
+    {
+        for (auto& job : jobs)
+        {
+            if (job.blockSchedule.needsTuning())
+            {
+                job.blockSchedule.tunedBlockSize = blockSize;
+                job.blockSchedule.tuning = tuning;
+            }
+        }
+    }
+
+    // Server mode: each request is a whole configuration. Engines for its
+    // chain are taken from the warm pool and returned to it afterwards, and
+    // the response carries the run summary with every job's profile.
+    juce::var processRequest(const juce::var& json)
+    {
+        serverMode = true;
+        lastSummary = juce::var();
+
+        juce::var response(new juce::DynamicObject());
+        auto* object = response.getDynamicObject();
+
+        if (!parseConfiguration(json))
+        {
+            object->setProperty("status", "error");
+            object->setProperty("error", "Invalid configuration");
+            return response;
+        }
+
+        auto chainKey = RenderEnginePool::getChainKey(jobs.front());
+        engines = enginePool.checkOut(chainKey);
+
+        auto warmEngines = static_cast<int>(engines.size());
+        for (auto& engine : engines)
+            engine->setReportProfile(true);
+
+        bool success = processAudio();
+
+        enginePool.checkIn(chainKey, std::move(engines));
+        engines.clear();
+
+        object->setProperty("status", success ? "ok" : "failed");
+        object->setProperty("warm_engines", warmEngines);
+        object->setProperty("summary", lastSummary);
+        return response;
+    }
+
+    void setEnginePoolSize(int maxEngines)
+    {
+        enginePool.setMaxEngines(static_cast<size_t>(juce::jmax(1, maxEngines)));
+    }
+
+    juce::var getEnginePoolInfo() const
+    {
+        return enginePool.toVar();
+    }
+
+    void cleanup()
+    {
+        safeLog("Emergency cleanup - minimal operations only");
+
+        for (auto& engine : engines)
+            engine->releasePlugins();
+
+        enginePool.clear();
+    }
+
+private:
+    std::vector<ProcessingConfig> jobs;
+    std::vector<juce::var> jobSources;     // the merged JSON each job was parsed from
+    std::vector<std::unique_ptr<RenderEngine>> engines;
+
+    // Batch worker pool settings
+    int parallelJobs = 1;
+    juce::StringArray singleInstancePlugins;
+
+    std::unique_ptr<PluginScanCache> scanCache;
+    std::unique_ptr<ParameterIndexCache> parameterCache;
+    MidiScheduleCache scheduleCache;
+    std::unique_ptr<MidiIngestCache> midiIngestCache;
+    SysExBankCache bankCache;
+    std::unique_ptr<RenderCache> renderCache;
+    std::unique_ptr<StateSnapshotStore> snapshotStore;
+    bool forceRescan = false;
+
+    // process_isolation: render in child worker processes
+    bool processIsolation = false;
+    int isolationRetries = 1;
+    double isolationJobTimeout = 600.0;
+    int isolationBasePort = 7900;
+
+    // --serve: loaded chains outlive a request and summaries go back to the client
+    RenderEnginePool enginePool;
+    bool serverMode = false;
+
+    // Structured end-of-run report; printed to stdout in quiet mode when no file is given
+    juce::String summaryFile;
+    juce::var lastSummary;
+
+    // "sweep": one job per point, listed with its parameter vector in the manifest
+    std::unique_ptr<ParameterSweep> sweep;
+    std::vector<std::vector<double>> sweepPoints;
+
+    // "probes": one job per generated sequence, listed with its notes in the manifest;
+    // jobs and jobSources hold only the template the probe jobs are built from
+    std::unique_ptr<MidiProbeSet> probeSet;
+    int probeDigits = 2;
+
+    // "multisample": zones rendered as jobs (or one continuous job), mapped in an .sfz afterwards
+    std::unique_ptr<MultisampleCapture> multisample;
+    juce::File multisampleBaseFile;
+
+    void writeRenderSummary(const std::vector<RenderStats>& jobStats, int workers, double totalSeconds)
+    {
+        auto summary = RenderSummary::create(jobStats, workers, totalSeconds, HostLog::getLevelName(HostLog::getLevel()));
+        lastSummary = summary;
+
+        if (sweep && sweep->writeManifest(juce::File(sweep->manifestFile), sweepPoints, jobStats))
+            std::cout << "Sweep manifest written to: " << sweep->manifestFile << std::endl;
+
+        if (probeSet)
+        {
+            juce::StringArray outputFiles;
+            for (size_t jobIndex = 0; jobIndex < jobStats.size(); ++jobIndex)
+                outputFiles.add(getJobOutputFile(jobIndex));
+
+            if (probeSet->writeManifest(juce::File(probeSet->manifestFile), outputFiles, jobStats))
+                std::cout << "Probe manifest written to: " << probeSet->manifestFile << std::endl;
+        }
+
+        if (multisample)
+            writeMultisampleMetadata(jobStats);
+
+        if (serverMode && summaryFile.isEmpty())
+            return;
+
+        if (summaryFile.isNotEmpty())
+        {
+            if (RenderSummary::writeToFile(summary, juce::File(summaryFile)))
+                std::cout << "Render summary written to: " << summaryFile << std::endl;
+        }
+        else if (!HostLog::isEnabled(LogLevel::normal))
+        {
+            HostLog::writeToStdout(juce::JSON::toString(summary, true));
+        }
+    }
+
+    // Prints the batch summary, writes the run summary, and returns true when every job succeeded
+    bool reportBatch(const std::vector<RenderStats>& jobStats, int workerCount, double batchSeconds)
+    {
+        int failedJobs = 0;
+
+        std::cout << "\n=== BATCH SUMMARY ===" << std::endl;
+        for (size_t jobIndex = 0; jobIndex < jobStats.size(); ++jobIndex)
+        {
+            if (!jobStats[jobIndex].success)
+            {
+                std::cerr << "Batch job " << (jobIndex + 1) << (jobStats[jobIndex].quarantined ? " quarantined: " : " failed: ")
+                          << getJobOutputFile(jobIndex) << std::endl;
+                failedJobs++;
+            }
+        }
+
+        std::cout << "Jobs rendered: " << (static_cast<int>(jobStats.size()) - failedJobs) << "/" << jobStats.size() << std::endl;
+        std::cout << "Jobs failed: " << failedJobs << std::endl;
+        std::cout << "Workers: " << workerCount << std::endl;
+        std::cout << "Total time: " << std::fixed << std::setprecision(2) << batchSeconds << " seconds" << std::endl;
+        std::cout << "=====================" << std::endl;
+
+        writeRenderSummary(jobStats, workerCount, batchSeconds);
+
+        return failedJobs == 0;
+    }
+
+    //==============================================================================
+    // Process isolation: plugins run in child --serve workers. The coordinator
+    // hands out jobs, restarts a worker that crashes or hangs, retries the job
+    // on the fresh worker and quarantines it when it keeps failing that way.
+    // Workers render to a temporary file next to the output, which is only
+    // moved into place once the job succeeded.
+    bool processIsolated()
+    {
+        auto workerCount = static_cast<size_t>(getWorkerCount());
+        auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+        auto batchStart = juce::Time::getMillisecondCounterHiRes();
+
+        std::cout << "=== ISOLATED RENDER: " << getNumJobs() << " job(s) on "
+                  << workerCount << " worker process(es) ===" << std::endl;
+
+        std::vector<RenderStats> jobStats(getNumJobs());
+
+        // Worker processes can't share a tuned size, so the first job that needs
+        // one renders alone and the size its worker picked is pinned in every
+        // later request, as tuneBlockSchedules() does for in-process workers
+        auto tuned = std::find_if(jobs.begin(), jobs.end(),
+                                  [](const ProcessingConfig& job) { return job.blockSchedule.needsTuning(); });
+        auto tunedJob = tuned != jobs.end() ? static_cast<size_t>(std::distance(jobs.begin(), tuned)) : jobStats.size();
+
+        if (tunedJob < jobStats.size())
+        {
+            WorkerProcess tuningWorker(executable, isolationBasePort);
+            printJobHeader(tunedJob, 0);
+            jobStats[tunedJob] = renderIsolatedJob(tuningWorker, tunedJob);
+            tuningWorker.stop();
+
+            if (jobStats[tunedJob].tunedBlockSize > 0)
+                setTunedBlockSize(jobStats[tunedJob].tunedBlockSize, {});
+        }
+
+        std::atomic<size_t> nextJob { 0 };
+        std::vector<std::thread> workers;
+
+        for (size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+        {
+            workers.emplace_back([this, workerIndex, tunedJob, &executable, &nextJob, &jobStats]()
+            {
+                WorkerProcess worker(executable, isolationBasePort + static_cast<int>(workerIndex));
+
+                for (auto jobIndex = nextJob++; jobIndex < jobStats.size(); jobIndex = nextJob++)
+                {
+                    if (jobIndex == tunedJob)
+                        continue;
+
+                    printJobHeader(jobIndex, workerIndex);
+                    jobStats[jobIndex] = renderIsolatedJob(worker, jobIndex);
+                }
+
+                worker.stop();
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        auto batchSeconds = (juce::Time::getMillisecondCounterHiRes() - batchStart) / 1000.0;
+        return reportBatch(jobStats, static_cast<int>(workerCount), batchSeconds);
+    }
+
+    RenderStats renderIsolatedJob(WorkerProcess& worker, size_t jobIndex) const
+    {
+        auto job = getJob(jobIndex);
+        auto jobSource = getJobSource(jobIndex);
+        juce::File outputFile(job.outputFile);
+
+        // A job with an "outputs" list writes its files in place; a single
+        // output is rendered under a temporary name and renamed when complete
+        auto partialFile = jobSource.hasProperty("outputs")
+                               ? outputFile
+                               : outputFile.getSiblingFile(outputFile.getFileNameWithoutExtension() + ".rendering"
+                                                           + outputFile.getFileExtension());
+
+        auto request = createWorkerRequest(jobSource, partialFile);
+
+        if (job.blockSchedule.isTuned() && job.blockSchedule.tunedBlockSize > 0)
+        {
+            auto blocks = request["adaptive_blocks"].isObject() ? request["adaptive_blocks"] : juce::var(new juce::DynamicObject());
+            blocks.getDynamicObject()->setProperty("tuned_block_size", job.blockSchedule.tunedBlockSize);
+            request.getDynamicObject()->setProperty("adaptive_blocks", blocks);
+        }
+
+        RenderStats stats;
+        stats.outputFile = job.outputFile;
+        stats.attempts = 0;
+
+        for (int attempt = 0; attempt <= isolationRetries; ++attempt)
+        {
+            if (!worker.isRunning() && !worker.start())
+                break;
+
+            stats.attempts++;
+
+            juce::var response;
+            auto result = worker.render(request, isolationJobTimeout, response);
+
+            if (result == WorkerProcess::Result::crashed)
+            {
+                std::cerr << "[ISOLATION] Worker on port " << worker.getPort() << " crashed during "
+                          << job.outputFile << " (attempt " << stats.attempts << ")" << std::endl;
+                continue;
+            }
+
+            if (auto* jobsArray = response["summary"]["jobs"].getArray())
+            {
+                if (!jobsArray->isEmpty())
+                {
+                    auto attempts = stats.attempts;
+                    stats = RenderStats::fromVar(jobsArray->getFirst());
+                    stats.attempts = attempts;
+                }
+            }
+
+            stats.outputFile = job.outputFile;
+            stats.success = (result == WorkerProcess::Result::ok)
+                            && (partialFile == outputFile || partialFile.moveFileTo(outputFile));
+
+            if (stats.success && job.writeProfile && !stats.profile.isVoid())
+                RenderProfiler::getProfileFileFor(outputFile).replaceWithText(juce::JSON::toString(stats.profile));
+
+            if (stats.success && job.analyze && partialFile != outputFile)
+                AudioAnalyzer::getAnalysisFileFor(partialFile).moveFileTo(AudioAnalyzer::getAnalysisFileFor(outputFile));
+
+            if (!stats.success)
+                partialFile.deleteFile();
+
+            // An answered failure is the job's own fault and would fail the same way again
+            return stats;
+        }
+
+        partialFile.deleteFile();
+        stats.success = false;
+
+        if (stats.attempts == 0)
+        {
+            std::cerr << "[ISOLATION] No worker process available for " << job.outputFile << std::endl;
+            return stats;
+        }
+
+        stats.quarantined = true;
+
+        auto quarantineFile = outputFile.getSiblingFile(outputFile.getFileNameWithoutExtension() + ".quarantine.json");
+        quarantineFile.replaceWithText(juce::JSON::toString(jobSource));
+
+        std::cerr << "[ISOLATION] Quarantined " << job.outputFile << " after " << stats.attempts
+                  << " crashed attempt(s); job written to " << quarantineFile.getFullPathName() << std::endl;
+        return stats;
+    }
+
+    // One job as a standalone configuration for a worker
+    static juce::var createWorkerRequest(const juce::var& jobJson, const juce::File& partialFile)
+    {
+        auto request = jobJson.clone();
+        auto* object = request.getDynamicObject();
+
+        for (auto* name : { "process_isolation", "parallel_jobs", "summary_file", "jobs", "sysex_patch_range", "sysex_patches", "sweep", "probes", "multisample" })
+            object->removeProperty(name);
+
+        object->setProperty("output_file", partialFile.getFullPathName());
+        object->setProperty("profile", false);
+        return request;
+    }
+
+    void printJobHeader(size_t jobIndex, size_t workerIndex) const
+    {
+        std::cout << "\n=== BATCH JOB " << (jobIndex + 1) << "/" << getNumJobs()
+                  << " [worker " << workerIndex << "]: " << getJobOutputFile(jobIndex) << " ===" << std::endl;
+    }
+
+    // Number of independent plugin-chain instances to render with. Plugins
+    // listed in single_instance_plugins force a serial batch.
+    int getWorkerCount() const
+    {
+        if (getNumJobs() <= 1)
+            return 1;
+
+        int requested = (parallelJobs > 0) ? parallelJobs : juce::SystemStats::getNumCpus();
+        if (requested <= 1)
+            return 1;
+
+        for (const auto& pluginConfig : jobs.front().plugins)
+        {
+            for (const auto& entry : singleInstancePlugins)
+            {
+                if (pluginConfig.pluginPath.containsIgnoreCase(entry) || pluginConfig.pluginName.containsIgnoreCase(entry))
+                {
+                    std::cout << "Plugin '" << pluginConfig.pluginPath << "' matches single_instance_plugins entry '"
+                              << entry << "' - rendering batch serially" << std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        return juce::jmin(requested, static_cast<int>(getNumJobs()));
+    }
+
+    bool addJob(const juce::var& jobJson)
+    {
+        ProcessingConfig jobConfig;
+        if (!parseProcessingConfig(jobJson, jobConfig))
+            return false;
+
+        jobs.push_back(std::move(jobConfig));
+        jobSources.push_back(jobJson);
+        return true;
+    }
+
+    bool parseConfiguration(const juce::var& json)
+    {
+        jobs.clear();
+        jobSources.clear();
+        sweep.reset();
+        sweepPoints.clear();
+        probeSet.reset();
+        multisample.reset();
+
+        juce::String logLevelName = json.getProperty("log_level", "normal");
+        LogLevel logLevel = LogLevel::normal;
+        if (!HostLog::parseLevel(logLevelName, logLevel))
+        {
+            std::cerr << "Unknown log_level '" << logLevelName << "' - using normal" << std::endl;
+        }
+        HostLog::setLevel(logLevel);
+
+        summaryFile = json.getProperty("summary_file", "");
+        parallelJobs = json.getProperty("parallel_jobs", 1);
+
+        if (json.getProperty("plugin_cache", true))
+        {
+            juce::String cachePath = json.getProperty("plugin_cache_file", "");
+            auto cacheFile = cachePath.isNotEmpty() ? juce::File(cachePath) : PluginScanCache::getDefaultCacheFile();
+
+            // Pooled engines point at the current cache, so it is only replaced along with them
+            if (!scanCache || scanCache->getFile() != cacheFile)
+            {
+                enginePool.clear();
+                scanCache = std::make_unique<PluginScanCache>(cacheFile);
+                scanCache->setForceRescan(forceRescan);
+            }
+        }
+        else
+        {
+            // Pooled engines would go on scanning through the old cache
+            enginePool.clear();
+            scanCache.reset();
+        }
+
+        if (json.getProperty("parameter_cache", true))
+        {
+            juce::String cachePath = json.getProperty("parameter_cache_file", "");
+            auto cacheFile = cachePath.isNotEmpty() ? juce::File(cachePath) : ParameterIndexCache::getDefaultCacheFile();
+
+            if (!parameterCache || parameterCache->getFile() != cacheFile)
+                parameterCache = std::make_unique<ParameterIndexCache>(cacheFile);
+        }
+        else
+        {
+            parameterCache.reset();
+        }
+
+        // Shared in memory either way; the directory keeps parsed files across runs
+        {
+            juce::String cachePath = json.getProperty("midi_cache_dir", "");
+            auto cacheDirectory = !static_cast<bool>(json.getProperty("midi_cache", true)) ? juce::File()
+                                : cachePath.isNotEmpty() ? juce::File(cachePath)
+                                : MidiIngestCache::getDefaultDirectory();
+
+            if (!midiIngestCache || midiIngestCache->getDirectory() != cacheDirectory)
+                midiIngestCache = std::make_unique<MidiIngestCache>(cacheDirectory);
+        }
+
+        auto renderCacheSetting = json["render_cache"];
+        if (renderCacheSetting.isString() || (renderCacheSetting.isBool() && static_cast<bool>(renderCacheSetting)))
+        {
+            auto cacheDirectory = renderCacheSetting.isString() ? juce::File(renderCacheSetting.toString())
+                                                                : RenderCache::getDefaultDirectory();
+
+            if (!renderCache || renderCache->getDirectory() != cacheDirectory)
+                renderCache = std::make_unique<RenderCache>(cacheDirectory);
+        }
+        else
+        {
+            renderCache.reset();
+        }
+
+        auto snapshotSetting = json["state_snapshots"];
+        if (snapshotSetting.isString() || (snapshotSetting.isBool() && static_cast<bool>(snapshotSetting)))
+        {
+            auto storeFile = snapshotSetting.isString() ? juce::File(snapshotSetting.toString())
+                                                        : StateSnapshotStore::getDefaultFile();
+
+            if (!snapshotStore || snapshotStore->getFile() != storeFile)
+                snapshotStore = std::make_unique<StateSnapshotStore>(storeFile);
+        }
+        else
+        {
+            snapshotStore.reset();
+        }
+
+        singleInstancePlugins.clear();
+        if (auto* singleInstanceArray = json["single_instance_plugins"].getArray())
+        {
+            for (const auto& entry : *singleInstanceArray)
+                singleInstancePlugins.add(entry.toString());
+        }
+
+        auto jobsArray = json["jobs"];
+        auto patchRange = json["sysex_patch_range"];
+        auto patchList = json["sysex_patches"];
+
+        auto isolation = json["process_isolation"];
+        processIsolation = isolation.isObject() || (!isolation.isVoid() && static_cast<bool>(isolation));
+        isolationRetries = juce::jmax(0, static_cast<int>(isolation.getProperty("retries", 1)));
+        isolationJobTimeout = isolation.getProperty("job_timeout_seconds", 600.0);
+        isolationBasePort = isolation.getProperty("base_port", 7900);
+
+        if (jobsArray.isArray())
+        {
+            for (int i = 0; i < jobsArray.size(); ++i)
+            {
+                if (!addJob(mergeJobOverrides(json, jobsArray[i])))
+                {
+                    std::cerr << "Invalid configuration for job " << i << std::endl;
+                    return false;
+                }
+            }
+        }
+        else if (json.hasProperty("sweep"))
+        {
+            if (!expandSweep(json))
+                return false;
+        }
+        else if (json.hasProperty("probes"))
+        {
+            if (!expandProbes(json))
+                return false;
+        }
+        else if (json.hasProperty("multisample"))
+        {
+            if (!expandMultisample(json))
+                return false;
+        }
+        else if (!patchRange.isVoid() || !patchList.isVoid())
+        {
+            if (!expandSysExPatches(json, patchRange, patchList))
+                return false;
+        }
+        else
+        {
+            if (!addJob(json))
+                return false;
+        }
+
+        if (jobs.empty())
+        {
+            std::cerr << "Configuration defines no jobs" << std::endl;
+            return false;
+        }
+
+        return validateBatchCompatibility();
+    }
+
+    // Applies one entry of the "jobs" array on top of the base configuration.
+    // Top-level keys replace the base value; entries of a "plugins" array are
+    // merged key-by-key into the base plugin at the same index.
+    static juce::var mergeJobOverrides(const juce::var& baseJson, const juce::var& jobJson)
+    {
+        auto merged = baseJson.clone();
+        auto* mergedObject = merged.getDynamicObject();
+        mergedObject->removeProperty("jobs");
+        mergedObject->removeProperty("sysex_patch_range");
+        mergedObject->removeProperty("sysex_patches");
+        mergedObject->removeProperty("sweep");
+        mergedObject->removeProperty("probes");
+        mergedObject->removeProperty("multisample");
+
+        auto* jobObject = jobJson.getDynamicObject();
+        if (!jobObject)
+            return merged;
+
+        for (auto& prop : jobObject->getProperties())
+        {
+            if (prop.name.toString() == "plugins" && prop.value.isArray() && merged["plugins"].isArray())
+            {
+                auto* basePlugins = merged["plugins"].getArray();
+
+                for (int i = 0; i < prop.value.size() && i < basePlugins->size(); ++i)
+                {
+                    auto* overrideObject = prop.value[i].getDynamicObject();
+                    auto* basePlugin = basePlugins->getReference(i).getDynamicObject();
+
+                    if (overrideObject && basePlugin)
+                    {
+                        for (auto& pluginProp : overrideObject->getProperties())
+                            basePlugin->setProperty(pluginProp.name, pluginProp.value);
+                    }
+                }
+            }
+            else
+            {
+                mergedObject->setProperty(prop.name, prop.value);
+            }
+        }
+
+        return merged;
+    }
+
+    // Expands "sysex_patch_range": [first, last] or "sysex_patches": [n, ...]
+    // or "all" into one job per patch of the first plugin that has a
+    // sysex_file. The output path may contain {patch}, otherwise "_patchNN"
+    // is appended to the file name.
+    bool expandSysExPatches(const juce::var& json, const juce::var& range, const juce::var& patchList)
+    {
+        auto pluginsArray = json["plugins"];
+        int sysexPluginIndex = -1;
+
+        for (int i = 0; pluginsArray.isArray() && i < pluginsArray.size(); ++i)
+        {
+            if (pluginsArray[i].getProperty("sysex_file", "").toString().isNotEmpty())
+            {
+                sysexPluginIndex = i;
+                break;
+            }
+        }
+
+        if (sysexPluginIndex < 0)
+        {
+            std::cerr << "sysex_patch_range and sysex_patches require a plugin with sysex_file" << std::endl;
+            return false;
+        }
+
+        std::vector<int> patchNumbers;
+
+        if (!patchList.isVoid())
+        {
+            if (patchList.toString() == "all")
+            {
+                // The bank is parsed here once; the engines reuse the cached copy
+                auto bank = bankCache.getBank(juce::File(pluginsArray[sysexPluginIndex]["sysex_file"].toString()));
+                if (!bank)
+                    return false;
+
+                for (int patch = 0; patch < bank->size(); ++patch)
+                    patchNumbers.push_back(patch);
+            }
+            else if (auto* numbers = patchList.getArray())
+            {
+                for (const auto& number : *numbers)
+                    patchNumbers.push_back(static_cast<int>(number));
+            }
+            else
+            {
+                std::cerr << "sysex_patches must be an array of patch numbers or \"all\"" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            int firstPatch = 0;
+            int lastPatch = 31;
+
+            if (range.isArray() && range.size() == 2)
+            {
+                firstPatch = range[0];
+                lastPatch = range[1];
+            }
+            else if (range.isObject())
+            {
+                firstPatch = range.getProperty("first", 0);
+                lastPatch = range.getProperty("last", 31);
+            }
+            else
+            {
+                std::cerr << "sysex_patch_range must be [first, last] or {\"first\": n, \"last\": n}" << std::endl;
+                return false;
+            }
+
+            for (int patch = firstPatch; patch <= lastPatch; ++patch)
+                patchNumbers.push_back(patch);
+        }
+
+        for (auto patch : patchNumbers)
+        {
+            juce::Array<juce::var> pluginOverrides;
+            for (int i = 0; i <= sysexPluginIndex; ++i)
+                pluginOverrides.add(juce::var(new juce::DynamicObject()));
+
+            pluginOverrides.getReference(sysexPluginIndex).getDynamicObject()->setProperty("sysex_patch_number", patch);
+
+            juce::var jobJson(new juce::DynamicObject());
+            jobJson.getDynamicObject()->setProperty("plugins", pluginOverrides);
+            setExpandedOutputs(json, jobJson, "patch", patch, 2);
+
+            if (!addJob(mergeJobOverrides(json, jobJson)))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Expands "sweep" into one job per point. Each job sets the point's values
+    // on top of the swept plugin's own "parameters"; the output path may
+    // contain {point}, otherwise "_pointNN" is appended to the file name.
+    bool expandSweep(const juce::var& json)
+    {
+        auto parsedSweep = std::make_unique<ParameterSweep>();
+        juce::String error;
+
+        if (!ParameterSweep::fromVar(json["sweep"], *parsedSweep, error))
+        {
+            std::cerr << "Invalid sweep: " << error << std::endl;
+            return false;
+        }
+
+        auto pluginsArray = json["plugins"];
+        auto pluginIndex = parsedSweep->pluginIndex;
+
+        if (!pluginsArray.isArray() || pluginIndex < 0 || pluginIndex >= pluginsArray.size())
+        {
+            std::cerr << "Invalid sweep: plugin " << pluginIndex << " is not in the chain" << std::endl;
+            return false;
+        }
+
+        auto points = parsedSweep->generatePoints();
+        auto digits = juce::jmax(2, juce::String(static_cast<int>(points.size()) - 1).length());
+        auto baseParameters = pluginsArray[pluginIndex]["parameters"];
+
+        std::cout << "Parameter sweep: " << points.size() << " points over " << parsedSweep->dimensions.size()
+                  << " parameter(s) of plugin " << pluginIndex << std::endl;
+
+        for (size_t pointIndex = 0; pointIndex < points.size(); ++pointIndex)
+        {
+            auto parameters = baseParameters.isObject() ? baseParameters.clone() : juce::var(new juce::DynamicObject());
+
+            for (size_t d = 0; d < parsedSweep->dimensions.size(); ++d)
+                parameters.getDynamicObject()->setProperty(parsedSweep->dimensions[d].getParameterKey(), points[pointIndex][d]);
+
+            juce::Array<juce::var> pluginOverrides;
+            for (int i = 0; i <= pluginIndex; ++i)
+                pluginOverrides.add(juce::var(new juce::DynamicObject()));
+
+            pluginOverrides.getReference(pluginIndex).getDynamicObject()->setProperty("parameters", parameters);
+
+            juce::var jobJson(new juce::DynamicObject());
+            jobJson.getDynamicObject()->setProperty("plugins", pluginOverrides);
+            setExpandedOutputs(json, jobJson, "point", static_cast<int>(pointIndex), digits);
+
+            if (!addJob(mergeJobOverrides(json, jobJson)))
+                return false;
+        }
+
+        if (parsedSweep->manifestFile.isEmpty())
+            parsedSweep->manifestFile = juce::File(jobs.front().outputFile).getSiblingFile("sweep_manifest.csv").getFullPathName();
+
+        sweep = std::move(parsedSweep);
+        sweepPoints = std::move(points);
+        return true;
+    }
+
+    // Expands "probes" into one job per generated sequence. The probed
+    // instrument gets the set and the sequence index as "midi_probe" and
+    // plays it from memory; the output path may contain {probe}.
+    bool expandProbes(const juce::var& json)
+    {
+        auto parsedSet = std::make_unique<MidiProbeSet>();
+        juce::String error;
+
+        if (!MidiProbeSet::fromVar(json["probes"], *parsedSet, error))
+        {
+            std::cerr << "Invalid probes: " << error << std::endl;
+            return false;
+        }
+
+        auto pluginsArray = json["plugins"];
+        auto pluginIndex = parsedSet->pluginIndex;
+
+        if (!pluginsArray.isArray() || pluginIndex < 0 || pluginIndex >= pluginsArray.size()
+            || !static_cast<bool>(pluginsArray[pluginIndex].getProperty("is_instrument", false)))
+        {
+            std::cerr << "Invalid probes: plugin " << pluginIndex << " is not an instrument in the chain" << std::endl;
+            return false;
+        }
+
+        auto numProbes = parsedSet->size();
+        auto digits = juce::jmax(2, juce::String(static_cast<juce::int64>(numProbes) - 1).length());
+
+        std::cout << "MIDI probes: " << numProbes << " sequences (" << parsedSet->notes.size() << " notes, "
+                  << parsedSet->velocities.size() << " velocities, " << parsedSet->chords.size()
+                  << " chords) on plugin " << pluginIndex << std::endl;
+
+        // The template is sequence 0 with the output patterns left unexpanded
+        auto probeJson = json["probes"].clone();
+        probeJson.getDynamicObject()->setProperty("sequence", 0);
+
+        juce::Array<juce::var> pluginOverrides;
+        for (int i = 0; i <= pluginIndex; ++i)
+            pluginOverrides.add(juce::var(new juce::DynamicObject()));
+
+        pluginOverrides.getReference(pluginIndex).getDynamicObject()->setProperty("midi_probe", probeJson);
+
+        juce::var jobJson(new juce::DynamicObject());
+        jobJson.getDynamicObject()->setProperty("plugins", pluginOverrides);
+
+        if (!addJob(mergeJobOverrides(json, jobJson)))
+            return false;
+
+        probeDigits = digits;
+
+        if (parsedSet->manifestFile.isEmpty())
+            parsedSet->manifestFile = juce::File(expandOutputPattern(jobs.front().outputFile, "probe", 0, digits))
+                                          .getSiblingFile("probe_manifest.csv").getFullPathName();
+
+        probeSet = std::move(parsedSet);
+        return true;
+    }
+
+    // One probe job from the template: the probed instrument (and any later
+    // instrument sharing its sequence) plays probeIndex, written to the
+    // template's files with {probe} expanded
+    ProcessingConfig createProbeJob(size_t probeIndex) const
+    {
+        auto job = jobs.front();
+        auto templateProbe = job.plugins[static_cast<size_t>(probeSet->pluginIndex)].midiProbe;
+        auto probe = std::make_shared<const MidiProbe>(probeSet->get(probeIndex));
+
+        for (auto& plugin : job.plugins)
+        {
+            if (plugin.midiProbe == templateProbe)
+                plugin.midiProbe = probe;
+        }
+
+        job.outputFile = expandOutputPattern(job.outputFile, "probe", static_cast<int>(probeIndex), probeDigits);
+        for (auto& output : job.outputs)
+            output.file = expandOutputPattern(output.file, "probe", static_cast<int>(probeIndex), probeDigits);
+
+        return job;
+    }
+
+    // The JSON of one job, as sent to a worker process and written on quarantine
+    juce::var getJobSource(size_t jobIndex) const
+    {
+        if (!probeSet)
+            return jobSources[jobIndex];
+
+        const auto& templateJson = jobSources.front();
+        auto source = templateJson.clone();
+        source["plugins"][probeSet->pluginIndex]["midi_probe"].getDynamicObject()
+            ->setProperty("sequence", static_cast<juce::int64>(jobIndex));
+
+        setExpandedOutputs(templateJson, source, "probe", static_cast<int>(jobIndex), probeDigits);
+        return source;
+    }
+
+    // Expands "multisample". The zones layout becomes one job per zone, with the
+    // zone's note as the instrument's "midi_probe" and auto tail trimming the
+    // release; the continuous layout is a single job playing every zone from
+    // "midi_capture".
+    bool expandMultisample(const juce::var& json)
+    {
+        auto capture = std::make_unique<MultisampleCapture>();
+        juce::String error;
+
+        if (!MultisampleCapture::fromVar(json["multisample"], *capture, error))
+        {
+            std::cerr << "Invalid multisample: " << error << std::endl;
+            return false;
+        }
+
+        auto pluginsArray = json["plugins"];
+        auto pluginIndex = capture->pluginIndex;
+
+        if (!pluginsArray.isArray() || pluginIndex < 0 || pluginIndex >= pluginsArray.size()
+            || !static_cast<bool>(pluginsArray[pluginIndex].getProperty("is_instrument", false)))
+        {
+            std::cerr << "Invalid multisample: plugin " << pluginIndex << " is not an instrument in the chain" << std::endl;
+            return false;
+        }
+
+        auto baseFile = juce::File::getCurrentWorkingDirectory().getChildFile(json["output_file"].toString());
+        if (json["output_file"].toString().isEmpty() || json.hasProperty("outputs"))
+        {
+            std::cerr << "Invalid multisample: needs output_file (\"outputs\" is not supported)" << std::endl;
+            return false;
+        }
+
+        auto zones = capture->getZones();
+
+        std::cout << "Multisample capture: " << zones.size() << " zones (" << capture->notes.size() << " notes x "
+                  << capture->velocities.size() << " velocities x " << capture->roundRobins << " round robins), "
+                  << (capture->layout == MultisampleCapture::Layout::zones ? "one file per zone" : "one continuous render")
+                  << std::endl;
+
+        auto createPluginOverrides = [pluginIndex](const juce::String& property, const juce::var& value)
+        {
+            juce::Array<juce::var> pluginOverrides;
+            for (int i = 0; i <= pluginIndex; ++i)
+                pluginOverrides.add(juce::var(new juce::DynamicObject()));
+
+            pluginOverrides.getReference(pluginIndex).getDynamicObject()->setProperty(property, value);
+            return pluginOverrides;
+        };
+
+        if (capture->layout == MultisampleCapture::Layout::continuous)
+        {
+            juce::var jobJson(new juce::DynamicObject());
+            jobJson.getDynamicObject()->setProperty("plugins", createPluginOverrides("midi_capture", json["multisample"]));
+            jobJson.getDynamicObject()->setProperty("render_length", static_cast<double>(zones.size()) * capture->getSlotLength());
+            jobJson.getDynamicObject()->setProperty("auto_tail", false);
+
+            if (!addJob(mergeJobOverrides(json, jobJson)))
+                return false;
+        }
+        else
+        {
+            // The release tail is an upper bound; each zone stops once it is below the threshold
+            juce::var autoTail(new juce::DynamicObject());
+            autoTail.getDynamicObject()->setProperty("threshold_db", capture->tailThresholdDb);
+            autoTail.getDynamicObject()->setProperty("hold_blocks", json["auto_tail"].getProperty("hold_blocks", 8));
+            autoTail.getDynamicObject()->setProperty("max_tail_seconds", capture->tailSeconds);
+
+            jobs.reserve(jobs.size() + zones.size());
+            jobSources.reserve(jobSources.size() + zones.size());
+
+            for (const auto& zone : zones)
+            {
+                juce::var jobJson(new juce::DynamicObject());
+                jobJson.getDynamicObject()->setProperty("plugins", createPluginOverrides("midi_probe", capture->createProbeJson(zone)));
+                jobJson.getDynamicObject()->setProperty("output_file", capture->getZoneFile(baseFile, zone).getFullPathName());
+                jobJson.getDynamicObject()->setProperty("render_length", 0.0);
+                jobJson.getDynamicObject()->setProperty("auto_tail", autoTail);
+
+                if (!addJob(mergeJobOverrides(json, jobJson)))
+                    return false;
+            }
+        }
+
+        multisample = std::move(capture);
+        multisampleBaseFile = baseFile;
+        return true;
+    }
+
+    void writeMultisampleMetadata(const std::vector<RenderStats>& jobStats) const
+    {
+        std::vector<MultisampleCapture::Region> regions;
+        double sampleRate = 0.0;
+
+        if (multisample->layout == MultisampleCapture::Layout::continuous)
+        {
+            if (jobStats.empty() || !jobStats.front().success)
+            {
+                std::cerr << "Multisample render failed - no SFZ written" << std::endl;
+                return;
+            }
+
+            sampleRate = jobStats.front().sampleRate;
+            regions = multisample->sliceContinuous(juce::File::getCurrentWorkingDirectory().getChildFile(jobStats.front().outputFile));
+        }
+        else
+        {
+            for (const auto& stats : jobStats)
+            {
+                MultisampleCapture::Region region;
+                region.sampleFile = juce::File::getCurrentWorkingDirectory().getChildFile(stats.outputFile);
+                region.rendered = stats.success;
+                regions.push_back(region);
+
+                if (stats.success)
+                    sampleRate = stats.sampleRate;
+            }
+        }
+
+        multisample->writeMetadata(multisampleBaseFile, regions, sampleRate);
+    }
+
+    // output_file and every "outputs" file of an expanded job, with {token} replaced
+    static void setExpandedOutputs(const juce::var& json, juce::var& jobJson, const juce::String& token, int value, int digits)
+    {
+        auto outputPattern = json["output_file"].toString();
+        if (outputPattern.isNotEmpty())
+            jobJson.getDynamicObject()->setProperty("output_file", expandOutputPattern(outputPattern, token, value, digits));
+
+        if (auto* outputsArray = json["outputs"].getArray())
+        {
+            juce::Array<juce::var> expandedOutputs;
+
+            for (const auto& output : *outputsArray)
+            {
+                auto expandedOutput = output.clone();
+                if (auto* outputObject = expandedOutput.getDynamicObject())
+                    outputObject->setProperty("file", expandOutputPattern(output["file"].toString(), token, value, digits));
+
+                expandedOutputs.add(expandedOutput);
+            }
+
+            jobJson.getDynamicObject()->setProperty("outputs", expandedOutputs);
+        }
+    }
+
+    static juce::String expandOutputPattern(const juce::String& pattern, const juce::String& token, int value, int digits = 2)
+    {
+        auto valueText = juce::String(value).paddedLeft('0', digits);
+        auto placeholder = "{" + token + "}";
+
+        if (pattern.contains(placeholder))
+            return pattern.replace(placeholder, valueText);
+
+        auto separatorIndex = juce::jmax(pattern.lastIndexOfChar('/'), pattern.lastIndexOfChar('\\'));
+        auto extensionIndex = pattern.lastIndexOfChar('.');
+
+        if (extensionIndex <= separatorIndex)
+            return pattern + "_" + token + valueText;
+
+        return pattern.substring(0, extensionIndex) + "_" + token + valueText + pattern.substring(extensionIndex);
+    }
+
+    // Plugins are instantiated once for the whole batch, so every job has to
+    // describe the same chain running at the same rate and block size.
+    bool validateBatchCompatibility() const
+    {
+        const auto& first = jobs.front();
+
+        for (size_t jobIndex = 1; jobIndex < jobs.size(); ++jobIndex)
+        {
+            const auto& job = jobs[jobIndex];
+
+            bool compatible = job.plugins.size() == first.plugins.size()
+                           && job.sampleRate == first.sampleRate
+                           && job.pluginSampleRate == first.pluginSampleRate
+                           && job.bufferSize == first.bufferSize
+                           && job.blockSchedule.getPreparedBlockSize(job.bufferSize)
+                                  == first.blockSchedule.getPreparedBlockSize(first.bufferSize)
+                           && job.instrumentChannels == first.instrumentChannels;
+
+            for (size_t i = 0; compatible && i < job.plugins.size(); ++i)
+            {
+                compatible = job.plugins[i].pluginPath == first.plugins[i].pluginPath
+                          && job.plugins[i].pluginName == first.plugins[i].pluginName
+                          && job.plugins[i].isInstrument == first.plugins[i].isInstrument;
+            }
+
+            if (!compatible)
+            {
+                std::cerr << "Job " << jobIndex << " changes the plugin chain, sample rate, buffer size or channel count;"
+                          << " all jobs in a batch must share them" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool parseProcessingConfig(const juce::var& json, ProcessingConfig& jobConfig)
+    {
+        jobConfig.inputFile = json.getProperty("input_file", "");
+        jobConfig.outputFile = json["output_file"].toString();
+        jobConfig.sampleRate = json.getProperty("sample_rate", 0.0);     // 0: the input file's rate, or 44100 for instruments
+        jobConfig.bitDepth = json.getProperty("bit_depth", 24);
+        jobConfig.bufferSize = json.getProperty("buffer_size", 2048);
+        jobConfig.pluginSampleRate = json.getProperty("plugin_sample_rate", 0.0);
+        jobConfig.renderLength = json.getProperty("render_length", 0.0);
+        jobConfig.instrumentChannels = json.getProperty("instrument_channels", 2);
+        jobConfig.writeProfile = json.getProperty("profile", false);
+
+        auto analysis = json["analysis"];
+        if (analysis.isObject())
+        {
+            jobConfig.analyze = true;
+            jobConfig.analysisFftSize = analysis.getProperty("fft_size", 2048);
+        }
+        else
+        {
+            jobConfig.analyze = analysis.isVoid() ? false : static_cast<bool>(analysis);
+        }
+        jobConfig.splitAutomationBlocks = json.getProperty("automation_split_blocks", false);
+
+        {
+            juce::String error;
+            if (!BlockSchedule::fromVar(json, jobConfig.bufferSize, jobConfig.blockSchedule, error))
+            {
+                std::cerr << "Invalid adaptive_blocks: " << error << std::endl;
+                return false;
+            }
+        }
+
+        auto autoTail = json["auto_tail"];
+        if (autoTail.isObject())
+        {
+            jobConfig.autoTail = true;
+            jobConfig.tailThresholdDb = static_cast<float>(autoTail.getProperty("threshold_db", -80.0));
+            jobConfig.tailHoldBlocks = juce::jmax(1, static_cast<int>(autoTail.getProperty("hold_blocks", 8)));
+            jobConfig.maxTailSeconds = autoTail.getProperty("max_tail_seconds", 30.0);
+        }
+        else
+        {
+            jobConfig.autoTail = autoTail.isVoid() ? false : static_cast<bool>(autoTail);
+        }
+
+        // Job-level gain, normalisation and dither; "outputs" entries override them per file
+        OutputProcessing processing;
+        {
+            juce::String error;
+            if (!OutputProcessing::fromVar(json, {}, processing, error))
+            {
+                std::cerr << "Invalid output processing: " << error << std::endl;
+                return false;
+            }
+        }
+
+        if (auto* outputsArray = json["outputs"].getArray())
+        {
+            for (int i = 0; i < outputsArray->size(); ++i)
+            {
+                OutputSpec spec;
+                juce::String error;
+
+                if (!OutputSpec::fromVar(outputsArray->getReference(i), processing, spec, error))
+                {
+                    std::cerr << "Invalid output " << i << ": " << error << std::endl;
+                    return false;
+                }
+
+                jobConfig.outputs.push_back(spec);
+            }
+
+            // output_file names the job in logs, summaries and the render cache
+            if (jobConfig.outputFile.isEmpty() && !jobConfig.outputs.empty())
+                jobConfig.outputFile = jobConfig.outputs.front().file;
+        }
+
+        if (jobConfig.outputFile.isEmpty())
+        {
+            std::cerr << "Output file path is required" << std::endl;
+            return false;
+        }
+
+        if (jobConfig.outputs.empty())
+        {
+            OutputSpec master;
+            master.file = jobConfig.outputFile;
+            master.processing = processing;
+            jobConfig.outputs.push_back(master);
+        }
+
+        auto pluginsArray = json["plugins"];
+        if (!pluginsArray.isArray())
+        {
+            std::cerr << "Plugins array is required" << std::endl;
+            return false;
+        }
+
+        for (int i = 0; i < pluginsArray.size(); ++i)
+        {
+            auto pluginJson = pluginsArray[i];
+            PluginConfig pluginConfig;
+
+            pluginConfig.pluginPath = pluginJson["path"].toString();
+            pluginConfig.pluginName = pluginJson.getProperty("plugin_name", "");
+            pluginConfig.presetPath = pluginJson.getProperty("preset", "");
+            pluginConfig.parametersBefore = pluginJson.getProperty("export_parameters_before", "");
+            pluginConfig.parametersAfter = pluginJson.getProperty("export_parameters_after", "");
+            pluginConfig.parameters = pluginJson.getProperty("parameters", juce::var());
+
+            // VSTi-specific settings
+            pluginConfig.isInstrument = pluginJson.getProperty("is_instrument", false);
+            pluginConfig.midiFile = pluginJson.getProperty("midi_file", "");
+
+            if (pluginJson.hasProperty("midi_probe"))
+            {
+                MidiProbeSet probes;
+                juce::String probeError;
+                auto sequence = static_cast<juce::int64>(pluginJson["midi_probe"].getProperty("sequence", 0));
+
+                if (!MidiProbeSet::fromVar(pluginJson["midi_probe"], probes, probeError)
+                    || sequence < 0 || static_cast<size_t>(sequence) >= probes.size())
+                {
+                    std::cerr << "Invalid midi_probe for plugin " << i << ": "
+                              << (probeError.isNotEmpty() ? probeError : "sequence " + juce::String(sequence) + " out of range")
+                              << std::endl;
+                    return false;
+                }
+
+                pluginConfig.midiProbe = std::make_shared<MidiProbe>(probes.get(static_cast<size_t>(sequence)));
+            }
+
+            if (pluginJson.hasProperty("midi_capture"))
+            {
+                auto capture = std::make_shared<MultisampleCapture>();
+                juce::String captureError;
+
+                if (!MultisampleCapture::fromVar(pluginJson["midi_capture"], *capture, captureError))
+                {
+                    std::cerr << "Invalid midi_capture for plugin " << i << ": " << captureError << std::endl;
+                    return false;
+                }
+
+                pluginConfig.midiCapture = std::move(capture);
+            }
+
+            juce::String routingError;
+            if (!MidiRouting::fromVar(pluginJson, pluginConfig.midiRouting, routingError))
+            {
+                std::cerr << "Invalid MIDI routing for plugin " << i << ": " << routingError << std::endl;
+                return false;
+            }
+            pluginConfig.instrumentLength = pluginJson.getProperty("instrument_length", 0.0);
+            pluginConfig.programNumber = pluginJson.getProperty("program_number", -1);
+            pluginConfig.sysexFile = pluginJson.getProperty("sysex_file", "");
+            pluginConfig.sysexPatchNumber = pluginJson.getProperty("sysex_patch_number", -1);
+            pluginConfig.saveStateTo = pluginJson.getProperty("save_state_to", "");
+            pluginConfig.saveStateDumps = pluginJson.getProperty("save_state_dumps", false);
+            pluginConfig.loadStateFrom = pluginJson.getProperty("load_state_from", "");
+            pluginConfig.saveDefaultState = pluginJson.getProperty("save_default_state", false);
+
+            if (auto* automationArray = pluginJson["automation"].getArray())
+            {
+                for (int laneIndex = 0; laneIndex < automationArray->size(); ++laneIndex)
+                {
+                    AutomationLane lane;
+                    juce::String error;
+
+                    if (!AutomationLane::fromVar(automationArray->getReference(laneIndex), lane, error))
+                    {
+                        std::cerr << "Invalid automation lane " << laneIndex << " for plugin " << i << ": " << error << std::endl;
+                        return false;
+                    }
+
+                    pluginConfig.automation.push_back(std::move(lane));
+                }
+            }
+
+            if (pluginConfig.pluginPath.isEmpty())
+            {
+                std::cerr << "Plugin path is required for plugin " << i << std::endl;
+                return false;
+            }
+
+            if (pluginConfig.isInstrument)
+            {
+                // Later instruments default to the first one's file, so one
+                // arrangement can be split across them by track or channel
+                if (pluginConfig.midiFile.isEmpty() && !pluginConfig.midiProbe && !pluginConfig.midiCapture && jobConfig.hasInstrument)
+                {
+                    for (const auto& earlier : jobConfig.plugins)
+                    {
+                        if (earlier.isInstrument)
+                        {
+                            pluginConfig.midiFile = earlier.midiFile;
+                            pluginConfig.midiProbe = earlier.midiProbe;
+                            pluginConfig.midiCapture = earlier.midiCapture;
+                            break;
+                        }
+                    }
+                }
+
+                jobConfig.hasInstrument = true;
+                if (pluginConfig.midiFile.isEmpty() && !pluginConfig.midiProbe && !pluginConfig.midiCapture)
+                {
+                    std::cerr << "MIDI file is required for instrument plugin " << i << std::endl;
+                    return false;
+                }
+            }
+
+            jobConfig.plugins.push_back(std::move(pluginConfig));
+        }
+
+        if (!jobConfig.hasInstrument && jobConfig.inputFile.isEmpty())
+        {
+            std::cerr << "Either input_file or an instrument plugin is required" << std::endl;
+            return false;
+        }
+
+        if (json.hasProperty("graph"))
+        {
+            juce::String error;
+            if (!GraphConfig::fromVar(json["graph"], jobConfig.plugins.size(), jobConfig.graph, error))
+            {
+                std::cerr << "Invalid graph: " << error << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            // Several instruments play side by side instead of feeding each other
+            std::vector<bool> instrumentNodes;
+            for (const auto& plugin : jobConfig.plugins)
+                instrumentNodes.push_back(plugin.isInstrument);
+
+            jobConfig.graph = GraphConfig::createInstrumentBuses(instrumentNodes);
+        }
+
+        for (const auto& output : jobConfig.outputs)
+        {
+            if (output.tap >= static_cast<int>(jobConfig.plugins.size()))
+            {
+                std::cerr << "Output " << output.file << " taps plugin " << output.tap
+                          << " but the chain has " << jobConfig.plugins.size() << " plugins" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_cryptography/juce_cryptography.h>
+#include <iostream>
+
+#if ! JUCE_WINDOWS
+ #include <unistd.h>
+#endif
+
+#include "RenderSummary.h"
+
+//==============================================================================
+/**
+ * Content-addressed store of finished renders.
+ *
+ * The key is a SHA-256 over everything that decides the output: plugin binary
+ * identity, each plugin's state after its settings were applied, the compiled
+ * MIDI or input file, automation and the render settings. Output paths are
+ * not part of it, so the same render under a new name is a hit.
+ *
+ * Entries are "<key>.<ext>" plus "<key>.json" holding the RenderStats of the
+ * original render. A hit hard-links the entry to the output path, falling
+ * back to a copy across volumes and on Windows.
+ */
+class RenderCache
+{
+public:
+    explicit RenderCache(const juce::File& directoryToUse)
+        : directory(directoryToUse)
+    {
+        directory.createDirectory();
+    }
+
+    static juce::File getDefaultDirectory()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("VSTPluginHost")
+                   .getChildFile("render_cache");
+    }
+
+    const juce::File& getDirectory() const  { return directory; }
+
+    /** Path, size and modification time: a rebuilt or updated plugin changes the key. */
+    static void writeFileIdentity(juce::OutputStream& key, const juce::File& file)
+    {
+        key.writeString(file.getFullPathName());
+        key.writeInt64(file.getSize());
+        key.writeInt64(file.getLastModificationTime().toMilliseconds());
+    }
+
+    static juce::String createKey(const juce::MemoryOutputStream& keyData)
+    {
+        return juce::SHA256(keyData.getData(), keyData.getDataSize()).toHexString();
+    }
+
+    /** Put the cached render at outputFile. Returns false on a miss. */
+    bool fetch(const juce::String& key, const juce::File& outputFile, RenderStats& stats) const
+    {
+        auto entry = getEntryFile(key, outputFile);
+        auto metadata = juce::JSON::parse(getMetadataFile(key).loadFileAsString());
+
+        if (!entry.existsAsFile() || !metadata.isObject())
+            return false;
+
+        outputFile.getParentDirectory().createDirectory();
+        outputFile.deleteFile();
+
+        if (!linkOrCopy(entry, outputFile))
+        {
+            std::cerr << "Render cache: could not place " << entry.getFullPathName()
+                      << " at " << outputFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        stats = RenderStats::fromVar(metadata);
+        return true;
+    }
+
+    /** Add a finished render. Written under a temporary name first so readers never see a partial entry. */
+    bool store(const juce::String& key, const juce::File& outputFile, const RenderStats& stats) const
+    {
+        auto entry = getEntryFile(key, outputFile);
+        auto temporary = directory.getChildFile(key + "_" + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64()) + ".tmp");
+
+        auto metadata = stats.toVar();
+        metadata.getDynamicObject()->removeProperty("profile");
+
+        if (!outputFile.copyFileTo(temporary)
+            || !getMetadataFile(key).replaceWithText(juce::JSON::toString(metadata))
+            || !temporary.moveFileTo(entry))
+        {
+            temporary.deleteFile();
+            std::cerr << "Render cache: could not store " << outputFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    juce::File directory;
+
+    juce::File getEntryFile(const juce::String& key, const juce::File& outputFile) const
+    {
+        return directory.getChildFile(key + outputFile.getFileExtension());
+    }
+
+    juce::File getMetadataFile(const juce::String& key) const
+    {
+        return directory.getChildFile(key + ".json");
+    }
+
+    static bool linkOrCopy(const juce::File& source, const juce::File& destination)
+    {
+       #if ! JUCE_WINDOWS
+        if (::link(source.getFullPathName().toRawUTF8(), destination.getFullPathName().toRawUTF8()) == 0)
+            return true;
+       #endif
+
+        return source.copyFileTo(destination);
+    }
+};
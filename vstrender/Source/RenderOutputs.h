@@ -0,0 +1,203 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "AudioStreamWriter.h"
+#include "OutputProcessing.h"
+#include "Resampler.h"
+
+//==============================================================================
+/**
+ * One deliverable of a job, from an "outputs" entry:
+ *
+ *   { "file": "preview.wav", "bit_depth": 16, "sample_rate": 22050, "tap": 0 }
+ *
+ * bit_depth and sample_rate default to the job's; tap is the index of the
+ * plugin whose output is written (a stem), or -1 for the end of the chain.
+ * "gain_db", "normalize" and "dither" (see OutputProcessing) override the
+ * job's for this file only.
+ */
+struct OutputSpec
+{
+    juce::String file;
+    int bitDepth = 0;
+    double sampleRate = 0.0;
+    int tap = -1;
+    OutputProcessing processing;
+
+    static bool fromVar(const juce::var& json, const OutputProcessing& defaultProcessing, OutputSpec& spec,
+                        juce::String& error)
+    {
+        spec.file = json["file"].toString();
+        if (spec.file.isEmpty())
+        {
+            error = "missing \"file\"";
+            return false;
+        }
+
+        spec.bitDepth = json.getProperty("bit_depth", 0);
+        spec.sampleRate = json.getProperty("sample_rate", 0.0);
+        spec.tap = json.getProperty("tap", -1);
+        return OutputProcessing::fromVar(json, defaultProcessing, spec.processing, error);
+    }
+
+    bool isPlainMaster() const      { return tap < 0 && sampleRate <= 0.0; }
+};
+
+//==============================================================================
+/**
+ * Every file a job writes, fed from one block stream. The stream holds the
+ * end of the chain in its first group of channels, then one group per tapped
+ * plugin, so held-back blocks (auto tail) stay aligned across all outputs.
+ * Each file has its own background writer thread, which also applies the
+ * file's gain, normalisation and dither.
+ */
+class RenderOutputs
+{
+public:
+    /** renderRate is the rate of the block stream, outputRate the default rate of the files. */
+    bool open(const std::vector<OutputSpec>& specs, double renderRate, double outputRate, int numChannelsToUse,
+              int defaultBitDepth, int fifoSamples)
+    {
+        close();
+        outputs.clear();
+        tappedPlugins.clear();
+        numChannels = numChannelsToUse;
+
+        for (const auto& spec : specs)
+        {
+            if (spec.tap >= 0 && getTapGroup(static_cast<size_t>(spec.tap)) < 0)
+                tappedPlugins.push_back(spec.tap);
+        }
+
+        for (const auto& spec : specs)
+        {
+            auto output = std::make_unique<Output>();
+            output->spec = spec;
+            output->group = spec.tap >= 0 ? getTapGroup(static_cast<size_t>(spec.tap)) : 0;
+
+            auto rate = spec.sampleRate > 0.0 ? spec.sampleRate : outputRate;
+            if (rate != renderRate)
+                output->resampler = std::make_unique<Resampler>(numChannels, renderRate, rate);
+
+            if (!output->writer.open(juce::File(spec.file), rate, numChannels,
+                                     spec.bitDepth > 0 ? spec.bitDepth : defaultBitDepth, fifoSamples,
+                                     spec.processing))
+            {
+                close();
+                return false;
+            }
+
+            outputs.push_back(std::move(output));
+        }
+
+        return !outputs.empty();
+    }
+
+    /** Channels in the block stream passed to write(). */
+    int getNumStreamChannels() const    { return numChannels * (1 + static_cast<int>(tappedPlugins.size())); }
+    bool hasTaps() const                { return !tappedPlugins.empty(); }
+
+    /** Channel group holding the output of this plugin, or -1 when nobody taps it. */
+    int getTapGroup(size_t pluginIndex) const
+    {
+        for (size_t i = 0; i < tappedPlugins.size(); ++i)
+        {
+            if (static_cast<size_t>(tappedPlugins[i]) == pluginIndex)
+                return static_cast<int>(i) + 1;
+        }
+
+        return -1;
+    }
+
+    void write(const juce::AudioBuffer<float>& stream, int numSamples)
+    {
+        for (auto& output : outputs)
+        {
+            auto* channels = stream.getArrayOfReadPointers() + output->group * numChannels;
+
+            if (output->resampler)
+            {
+                auto produced = output->resampler->process(channels, numSamples);
+                output->writer.write(output->resampler->getOutput(), produced);
+            }
+            else
+                output->writer.write(channels, numSamples);
+        }
+    }
+
+    /** Finalise every file. Returns true when all of them were written in full. */
+    bool close()
+    {
+        bool allWritten = !outputs.empty();
+
+        // Every writer thread finalises (and normalises) its file at once; then wait for them all
+        for (auto& output : outputs)
+        {
+            if (output->resampler && output->writer.isOpen())
+            {
+                auto produced = output->resampler->flush();
+                output->writer.write(output->resampler->getOutput(), produced);
+            }
+
+            output->writer.finish();
+        }
+
+        for (auto& output : outputs)
+        {
+            auto written = output->writer.close();
+            allWritten = allWritten && written && output->writer.getFile().existsAsFile();
+        }
+
+        return allWritten;
+    }
+
+    /** Gain the end-of-chain output written to file applied, or 1 for any other file. Valid after close(). */
+    float getAppliedGain(const juce::File& file) const
+    {
+        for (const auto& output : outputs)
+        {
+            if (output->spec.tap < 0 && output->writer.getFile() == file)
+                return output->writer.getAppliedGain();
+        }
+
+        return 1.0f;
+    }
+
+    void printSummary() const
+    {
+        for (const auto& output : outputs)
+        {
+            std::cout << "Output written to: " << output->writer.getFile().getFullPathName() << std::endl;
+            std::cout << "  Sample rate: " << output->writer.getSampleRate() << " Hz" << std::endl;
+            std::cout << "  Bit depth: " << output->writer.getBitDepth() << " bits" << std::endl;
+            std::cout << "  Channels: " << output->writer.getNumChannels() << std::endl;
+            std::cout << "  Samples: " << output->writer.getSamplesWritten() << std::endl;
+
+            if (output->spec.tap >= 0)
+                std::cout << "  Tap: after plugin " << output->spec.tap << std::endl;
+
+            if (output->spec.processing.isActive())
+                std::cout << "  Processing: " << output->spec.processing.getDescription() << " ("
+                          << juce::String(juce::Decibels::gainToDecibels(output->writer.getAppliedGain()), 2)
+                          << " dB applied)" << std::endl;
+        }
+    }
+
+private:
+    struct Output
+    {
+        OutputSpec spec;
+        int group = 0;
+        AudioStreamWriter writer;
+        std::unique_ptr<Resampler> resampler;
+    };
+
+    std::vector<std::unique_ptr<Output>> outputs;
+    std::vector<int> tappedPlugins;
+    int numChannels = 0;
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+//==============================================================================
+/**
+ * Timing for one render job: every processBlock call per plugin in the chain,
+ * plus the setup phases around it (scan, instantiate, preset/sysex/state load,
+ * file finalise).
+ *
+ * Block times are stored in vectors reserved up front, so the render loop only
+ * reads the high resolution tick counter and appends. Statistics are computed
+ * when the report is built.
+ */
+class RenderProfiler
+{
+public:
+    struct Phase
+    {
+        juce::String name;
+        double seconds = 0.0;
+        int count = 0;
+    };
+
+    /** Times a setup phase for the lifetime of the object. */
+    class ScopedPhase
+    {
+    public:
+        ScopedPhase(std::vector<Phase>& phasesToUse, const char* phaseName)
+            : phases(phasesToUse), name(phaseName), startTicks(now())
+        {
+        }
+
+        ScopedPhase(RenderProfiler& profiler, const char* phaseName)
+            : ScopedPhase(profiler.phases, phaseName)
+        {
+        }
+
+        ~ScopedPhase()
+        {
+            addPhase(phases, name, secondsSince(startTicks));
+        }
+
+    private:
+        std::vector<Phase>& phases;
+        const char* name;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedPhase)
+    };
+
+    void reset(size_t numPlugins, size_t expectedBlocks, double sampleRateToUse)
+    {
+        sampleRate = sampleRateToUse;
+        plugins.assign(numPlugins, PluginTiming());
+
+        for (auto& plugin : plugins)
+            plugin.blockSeconds.reserve(expectedBlocks);
+    }
+
+    void clear()
+    {
+        plugins.clear();
+        phases.clear();
+        chainLoadPhases.clear();
+        chainLoadedForJob = false;
+        blockTuning = {};
+        sampleRate = 0.0;
+    }
+
+    void setPluginName(size_t pluginIndex, const juce::String& name)
+    {
+        if (pluginIndex < plugins.size())
+            plugins[pluginIndex].name = name;
+    }
+
+    static juce::int64 now()     { return juce::Time::getHighResolutionTicks(); }
+
+    static double secondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(now() - startTicks);
+    }
+
+    /** Add the time elapsed since startTicks (taken from now()) to a job phase. */
+    void addPhaseSince(const juce::String& name, juce::int64 startTicks)
+    {
+        addPhase(phases, name, secondsSince(startTicks));
+    }
+
+    /** Record one processBlock call. Called from the render loop. */
+    void addBlock(size_t pluginIndex, juce::int64 startTicks, juce::int64 endTicks, int numSamples)
+    {
+        if (pluginIndex >= plugins.size())
+            return;
+
+        auto& plugin = plugins[pluginIndex];
+        plugin.blockSeconds.push_back(static_cast<float>(juce::Time::highResolutionTicksToSeconds(endTicks - startTicks)));
+        plugin.samplesProcessed += numSamples;
+    }
+
+    /** Phases from the most recent plugin scan/instantiation, reported with each job. */
+    void setChainLoad(const std::vector<Phase>& loadPhases, bool loadedForThisJob)
+    {
+        chainLoadPhases = loadPhases;
+        chainLoadedForJob = loadedForThisJob;
+    }
+
+    /** Per-plugin block size timings behind an adaptive job's block size. */
+    void setBlockTuning(const juce::var& tuning)
+    {
+        blockTuning = tuning;
+    }
+
+    static void addPhase(std::vector<Phase>& phaseList, const juce::String& name, double seconds)
+    {
+        for (auto& phase : phaseList)
+        {
+            if (phase.name == name)
+            {
+                phase.seconds += seconds;
+                phase.count++;
+                return;
+            }
+        }
+
+        phaseList.push_back({ name, seconds, 1 });
+    }
+
+    juce::var toVar(const juce::String& outputFile) const
+    {
+        juce::var result(new juce::DynamicObject());
+        auto* object = result.getDynamicObject();
+
+        object->setProperty("output_file", outputFile);
+        object->setProperty("sample_rate", sampleRate);
+
+        juce::Array<juce::var> pluginArray;
+        double chainSeconds = 0.0;
+        juce::int64 chainSamples = 0;
+
+        for (size_t i = 0; i < plugins.size(); ++i)
+        {
+            auto stats = plugins[i].getStatistics(sampleRate);
+            chainSeconds += stats.totalSeconds;
+            chainSamples = juce::jmax(chainSamples, plugins[i].samplesProcessed);
+
+            juce::var pluginVar(new juce::DynamicObject());
+            auto* pluginObject = pluginVar.getDynamicObject();
+            pluginObject->setProperty("index", static_cast<int>(i));
+            pluginObject->setProperty("name", plugins[i].name);
+            pluginObject->setProperty("blocks", static_cast<int>(plugins[i].blockSeconds.size()));
+            pluginObject->setProperty("total_seconds", stats.totalSeconds);
+            pluginObject->setProperty("min_block_us", stats.minSeconds * 1.0e6);
+            pluginObject->setProperty("mean_block_us", stats.meanSeconds * 1.0e6);
+            pluginObject->setProperty("p99_block_us", stats.p99Seconds * 1.0e6);
+            pluginObject->setProperty("max_block_us", stats.maxSeconds * 1.0e6);
+            pluginObject->setProperty("realtime_factor", stats.realtimeFactor);
+            pluginArray.add(pluginVar);
+        }
+
+        object->setProperty("plugins", pluginArray);
+        object->setProperty("chain_seconds", chainSeconds);
+        object->setProperty("chain_realtime_factor",
+                            (chainSeconds > 0.0 && sampleRate > 0.0) ? (chainSamples / sampleRate) / chainSeconds : 0.0);
+
+        object->setProperty("phases", phasesToVar(phases));
+
+        juce::var chainLoad(new juce::DynamicObject());
+        chainLoad.getDynamicObject()->setProperty("loaded_for_this_job", chainLoadedForJob);
+        chainLoad.getDynamicObject()->setProperty("phases", phasesToVar(chainLoadPhases));
+        object->setProperty("plugin_load", chainLoad);
+
+        if (!blockTuning.isVoid())
+            object->setProperty("block_tuning", blockTuning);
+
+        return result;
+    }
+
+    bool writeToFile(const juce::File& file, const juce::String& outputFile) const
+    {
+        if (!file.replaceWithText(juce::JSON::toString(toVar(outputFile))))
+        {
+            std::cerr << "Could not write render profile: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    /** "renders/bass.wav" -> "renders/bass.profile.json" */
+    static juce::File getProfileFileFor(const juce::File& outputFile)
+    {
+        return outputFile.getSiblingFile(outputFile.getFileNameWithoutExtension() + ".profile.json");
+    }
+
+private:
+    struct Statistics
+    {
+        double totalSeconds = 0.0;
+        double minSeconds = 0.0;
+        double meanSeconds = 0.0;
+        double p99Seconds = 0.0;
+        double maxSeconds = 0.0;
+        double realtimeFactor = 0.0;
+    };
+
+    struct PluginTiming
+    {
+        juce::String name;
+        std::vector<float> blockSeconds;
+        juce::int64 samplesProcessed = 0;
+
+        Statistics getStatistics(double sampleRate) const
+        {
+            Statistics stats;
+
+            if (blockSeconds.empty())
+                return stats;
+
+            auto sorted = blockSeconds;
+            std::sort(sorted.begin(), sorted.end());
+
+            for (auto seconds : sorted)
+                stats.totalSeconds += seconds;
+
+            auto p99Index = juce::jmin(sorted.size() - 1, static_cast<size_t>(0.99 * static_cast<double>(sorted.size())));
+
+            stats.minSeconds = sorted.front();
+            stats.maxSeconds = sorted.back();
+            stats.p99Seconds = sorted[p99Index];
+            stats.meanSeconds = stats.totalSeconds / static_cast<double>(sorted.size());
+
+            if (stats.totalSeconds > 0.0 && sampleRate > 0.0)
+                stats.realtimeFactor = (samplesProcessed / sampleRate) / stats.totalSeconds;
+
+            return stats;
+        }
+    };
+
+    static juce::var phasesToVar(const std::vector<Phase>& phaseList)
+    {
+        juce::var result(new juce::DynamicObject());
+
+        for (const auto& phase : phaseList)
+            result.getDynamicObject()->setProperty(phase.name, phase.seconds);
+
+        return result;
+    }
+
+    std::vector<PluginTiming> plugins;
+    std::vector<Phase> phases;
+    std::vector<Phase> chainLoadPhases;
+    bool chainLoadedForJob = false;
+    juce::var blockTuning;
+    double sampleRate = 0.0;
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include <string>
+
+#include "PluginHost.h"
+
+//==============================================================================
+/**
+ * --serve: keeps one AudioPluginHost and its loaded plugins alive and takes
+ * render requests over a TCP socket bound to 127.0.0.1.
+ *
+ * The protocol is one JSON document per line in each direction. A request is
+ * either a full configuration (the same JSON as a config file), or one of:
+ *
+ *   { "config_file": "renders/bass.json" }
+ *   { "command": "ping" }
+ *   { "command": "pool" }        engine pool contents and hit/miss counts
+ *   { "command": "shutdown" }
+ *
+ * An "id" member is echoed back in the response. Render responses carry
+ * "status" ("ok", "failed" or "error") and the run summary, which includes the
+ * profile of every job. Requests are handled one at a time, in arrival order.
+ */
+class RenderServer
+{
+public:
+    RenderServer(AudioPluginHost& hostToUse, int portToUse)
+        : host(hostToUse), port(portToUse)
+    {
+    }
+
+    bool run()
+    {
+        juce::StreamingSocket listener;
+
+        if (!listener.createListener(port, "127.0.0.1"))
+        {
+            std::cerr << "[SERVE] Could not listen on 127.0.0.1:" << port << std::endl;
+            return false;
+        }
+
+        std::cout << "[SERVE] Listening on 127.0.0.1:" << listener.getBoundPort() << std::endl;
+
+        while (!shutdownRequested)
+        {
+            std::unique_ptr<juce::StreamingSocket> client(listener.waitForNextConnection());
+
+            if (client)
+                serveClient(*client);
+        }
+
+        listener.close();
+        std::cout << "[SERVE] Shut down after " << requestsHandled << " request(s)" << std::endl;
+        return true;
+    }
+
+private:
+    AudioPluginHost& host;
+    int port;
+    bool shutdownRequested = false;
+    int requestsHandled = 0;
+
+    static constexpr size_t maxRequestBytes = 16 * 1024 * 1024;
+
+    void serveClient(juce::StreamingSocket& client)
+    {
+        std::string pending;
+        char buffer[8192];
+
+        while (!shutdownRequested && client.isConnected())
+        {
+            auto newline = pending.find('\n');
+
+            if (newline == std::string::npos)
+            {
+                auto ready = client.waitUntilReady(true, 500);
+                if (ready < 0)
+                    break;
+                if (ready == 0)
+                    continue;
+
+                auto bytesRead = client.read(buffer, static_cast<int>(sizeof(buffer)), false);
+                if (bytesRead <= 0)
+                    break;
+
+                pending.append(buffer, static_cast<size_t>(bytesRead));
+
+                if (pending.size() > maxRequestBytes)
+                {
+                    sendLine(client, createError({}, "Request exceeds " + juce::String(static_cast<juce::int64>(maxRequestBytes)) + " bytes"));
+                    break;
+                }
+
+                continue;
+            }
+
+            auto line = juce::String::fromUTF8(pending.data(), static_cast<int>(newline)).trim();
+            pending.erase(0, newline + 1);
+
+            if (line.isEmpty())
+                continue;
+
+            if (!sendLine(client, handleRequest(line)))
+                break;
+        }
+    }
+
+    juce::var handleRequest(const juce::String& line)
+    {
+        auto request = juce::JSON::parse(line);
+        if (!request.isObject())
+            return createError({}, "Request is not a JSON object");
+
+        auto requestId = request["id"];
+        juce::String command = request.getProperty("command", "");
+
+        juce::var response;
+
+        if (command == "ping")
+        {
+            response = createStatus("ok");
+        }
+        else if (command == "pool")
+        {
+            response = createStatus("ok");
+            response.getDynamicObject()->setProperty("pool", host.getEnginePoolInfo());
+        }
+        else if (command == "shutdown")
+        {
+            shutdownRequested = true;
+            response = createStatus("ok");
+        }
+        else if (command.isNotEmpty())
+        {
+            response = createError(requestId, "Unknown command '" + command + "'");
+        }
+        else
+        {
+            response = render(request);
+        }
+
+        if (!requestId.isVoid())
+            response.getDynamicObject()->setProperty("id", requestId);
+
+        return response;
+    }
+
+    juce::var render(const juce::var& request)
+    {
+        auto config = request;
+        juce::String configPath = request.getProperty("config_file", "");
+
+        if (configPath.isNotEmpty())
+        {
+            juce::File configFile(configPath);
+            if (!configFile.existsAsFile())
+                return createError({}, "Configuration file not found: " + configPath);
+
+            config = juce::JSON::parse(configFile.loadFileAsString());
+            if (!config.isObject())
+                return createError({}, "Invalid JSON configuration: " + configPath);
+        }
+
+        requestsHandled++;
+        std::cout << "[SERVE] Request " << requestsHandled << std::endl;
+
+        try
+        {
+            return host.processRequest(config);
+        }
+        catch (...)
+        {
+            return createError({}, "Exception during render");
+        }
+    }
+
+    static juce::var createStatus(const juce::String& status)
+    {
+        juce::var result(new juce::DynamicObject());
+        result.getDynamicObject()->setProperty("status", status);
+        return result;
+    }
+
+    static juce::var createError(const juce::var& requestId, const juce::String& message)
+    {
+        auto result = createStatus("error");
+        result.getDynamicObject()->setProperty("error", message);
+
+        if (!requestId.isVoid())
+            result.getDynamicObject()->setProperty("id", requestId);
+
+        return result;
+    }
+
+    static bool sendLine(juce::StreamingSocket& client, const juce::var& response)
+    {
+        auto text = (juce::JSON::toString(response, true) + "\n").toStdString();
+        size_t written = 0;
+
+        while (written < text.size())
+        {
+            auto result = client.write(text.data() + written, static_cast<int>(text.size() - written));
+            if (result <= 0)
+                return false;
+
+            written += static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(RenderServer)
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include <vector>
+
+//==============================================================================
+/**
+ * Diagnostics gathered while a job renders. These used to be printed block by
+ * block; they are now collected and reported once in the run summary.
+ */
+struct RenderStats
+{
+    juce::String outputFile;
+    bool success = false;
+    double sampleRate = 0.0;
+    juce::int64 samplesRendered = 0;
+    double renderSeconds = 0.0;
+
+    int totalBlocks = 0;
+    int blockSize = 0;          // largest block of the render; varies with "adaptive_blocks"
+    int tunedBlockSize = 0;     // size "max_block_size": "auto" was tuned to for the batch
+    int blocksWithAudio = 0;    // blocks where the instrument output was above -60 dB RMS
+    int midiEvents = 0;
+    int noteOns = 0;
+    int noteOffs = 0;
+    std::vector<float> channelRms;
+    bool autoTailStopped = false;   // the render ended early on silence and the file was trimmed
+    juce::var profile;              // RenderProfiler report, when the engine was asked to return it
+    juce::var analysis;             // AudioAnalyzer features, when the job asked for them
+    bool cacheHit = false;          // the output was taken from the render cache
+
+    // Process isolation: how often the job was started, and whether it was given up on after crashes
+    int attempts = 1;
+    bool quarantined = false;
+
+    bool hasAudio() const
+    {
+        float total = 0.0f;
+        for (auto rms : channelRms)
+            total += rms;
+
+        return total > 0.0001f;
+    }
+
+    juce::var toVar() const
+    {
+        juce::var result(new juce::DynamicObject());
+        auto* object = result.getDynamicObject();
+
+        object->setProperty("output_file", outputFile);
+        object->setProperty("success", success);
+        object->setProperty("sample_rate", sampleRate);
+        object->setProperty("samples", samplesRendered);
+        object->setProperty("duration_seconds", sampleRate > 0.0 ? samplesRendered / sampleRate : 0.0);
+        object->setProperty("render_seconds", renderSeconds);
+        object->setProperty("blocks", totalBlocks);
+        object->setProperty("block_size", blockSize);
+
+        if (tunedBlockSize > 0)
+            object->setProperty("tuned_block_size", tunedBlockSize);
+
+        object->setProperty("blocks_with_audio", blocksWithAudio);
+        object->setProperty("midi_events", midiEvents);
+        object->setProperty("note_ons", noteOns);
+        object->setProperty("note_offs", noteOffs);
+
+        juce::Array<juce::var> rmsArray;
+        for (auto rms : channelRms)
+            rmsArray.add(rms);
+
+        object->setProperty("channel_rms", rmsArray);
+        object->setProperty("audio_detected", hasAudio());
+        object->setProperty("auto_tail_stopped", autoTailStopped);
+        object->setProperty("render_cache_hit", cacheHit);
+
+        if (!profile.isVoid())
+            object->setProperty("profile", profile);
+
+        if (!analysis.isVoid())
+            object->setProperty("analysis", analysis);
+
+        if (attempts != 1 || quarantined)
+        {
+            object->setProperty("attempts", attempts);
+            object->setProperty("quarantined", quarantined);
+        }
+
+        return result;
+    }
+
+    /** Read back the toVar() form, as returned by a worker process. */
+    static RenderStats fromVar(const juce::var& json)
+    {
+        RenderStats stats;
+        stats.outputFile = json["output_file"].toString();
+        stats.success = json.getProperty("success", false);
+        stats.sampleRate = json.getProperty("sample_rate", 0.0);
+        stats.samplesRendered = static_cast<juce::int64>(json.getProperty("samples", 0));
+        stats.renderSeconds = json.getProperty("render_seconds", 0.0);
+        stats.totalBlocks = json.getProperty("blocks", 0);
+        stats.blockSize = json.getProperty("block_size", 0);
+        stats.tunedBlockSize = json.getProperty("tuned_block_size", 0);
+        stats.blocksWithAudio = json.getProperty("blocks_with_audio", 0);
+        stats.midiEvents = json.getProperty("midi_events", 0);
+        stats.noteOns = json.getProperty("note_ons", 0);
+        stats.noteOffs = json.getProperty("note_offs", 0);
+        stats.autoTailStopped = json.getProperty("auto_tail_stopped", false);
+        stats.cacheHit = json.getProperty("render_cache_hit", false);
+        stats.profile = json["profile"];
+        stats.analysis = json["analysis"];
+
+        if (auto* rmsArray = json["channel_rms"].getArray())
+        {
+            for (const auto& rms : *rmsArray)
+                stats.channelRms.push_back(static_cast<float>(rms));
+        }
+
+        return stats;
+    }
+};
+
+//==============================================================================
+/**
+ * One JSON document describing a whole run, written when the run finishes.
+ */
+class RenderSummary
+{
+public:
+    static juce::var create(const std::vector<RenderStats>& jobStats, int workers, double totalSeconds,
+                            const juce::String& logLevel)
+    {
+        juce::var summary(new juce::DynamicObject());
+        auto* object = summary.getDynamicObject();
+
+        int failed = 0;
+        juce::Array<juce::var> jobsArray;
+
+        for (const auto& stats : jobStats)
+        {
+            if (!stats.success)
+                failed++;
+
+            jobsArray.add(stats.toVar());
+        }
+
+        object->setProperty("log_level", logLevel);
+        object->setProperty("jobs_total", static_cast<int>(jobStats.size()));
+        object->setProperty("jobs_failed", failed);
+        object->setProperty("workers", workers);
+        object->setProperty("total_seconds", totalSeconds);
+        object->setProperty("jobs", jobsArray);
+        return summary;
+    }
+
+    static bool writeToFile(const juce::var& summary, const juce::File& file)
+    {
+        file.getParentDirectory().createDirectory();
+
+        if (!file.replaceWithText(juce::JSON::toString(summary)))
+        {
+            std::cerr << "Could not write render summary: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    // Shared by the sweep and probe manifests, so their result columns stay the same
+
+    /** Quote a CSV field when it holds a comma, quote or newline. */
+    static juce::String quoteCsv(const juce::String& text)
+    {
+        if (!text.containsAnyOf(",\"\n"))
+            return text;
+
+        return "\"" + text.replace("\"", "\"\"") + "\"";
+    }
+
+    static void addCsvStatsHeader(juce::StringArray& header)
+    {
+        header.addArray(juce::StringArray { "success", "duration_seconds", "rms", "render_seconds", "render_cache_hit" });
+    }
+
+    /** The columns named by addCsvStatsHeader; rms is the mean over channels. */
+    static void addCsvStats(juce::StringArray& row, const RenderStats& stats)
+    {
+        float rms = 0.0f;
+        for (auto channelRms : stats.channelRms)
+            rms += channelRms / static_cast<float>(stats.channelRms.size());
+
+        row.add(stats.success ? "1" : "0");
+        row.add(juce::String(stats.sampleRate > 0.0 ? stats.samplesRendered / stats.sampleRate : 0.0, 6));
+        row.add(juce::String(rms, 6));
+        row.add(juce::String(stats.renderSeconds, 4));
+        row.add(stats.cacheHit ? "1" : "0");
+    }
+};
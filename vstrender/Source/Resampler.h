@@ -0,0 +1,324 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+//==============================================================================
+/**
+ * Streaming polyphase sample rate converter.
+ *
+ * The two rates are reduced to up/down factors L/M and the output position is
+ * kept as an integer phase, so the timing never drifts over long renders.
+ * Each phase is a Kaiser-windowed sinc cut off just below the lower of the
+ * two Nyquist frequencies: converting down widens the filter, so content
+ * above the new Nyquist is removed instead of folding back.
+ *
+ * Blocks of any size produce the same output as one call with the whole
+ * signal. The filter delay is compensated and flush() pads the end, so the
+ * output is aligned with the input and exactly getOutputLength() long.
+ */
+class Resampler
+{
+public:
+    Resampler(int numChannelsToUse, double inputRate, double outputRate, int zeroCrossings = 16)
+        : numChannels(numChannelsToUse)
+    {
+        auto inputHz = static_cast<juce::int64>(std::llround(inputRate));
+        auto outputHz = static_cast<juce::int64>(std::llround(outputRate));
+        auto divisor = std::gcd(inputHz, outputHz);
+
+        up = outputHz / divisor;
+        down = inputHz / divisor;
+        numPhases = static_cast<int>(std::min<juce::int64>(up, maxPhases));
+
+        // Cutoff as a fraction of the input Nyquist, with room for the transition band
+        auto cutoff = std::min(1.0, static_cast<double>(up) / static_cast<double>(down)) * 0.94;
+        halfTaps = static_cast<int>(std::ceil(zeroCrossings / cutoff));
+        numTaps = (2 * halfTaps + 3) & ~3;     // padded with zeros for the 4-way dot product
+
+        buildFilters(cutoff);
+
+        numBuffered = halfTaps - 1;
+        buffers.assign(static_cast<size_t>(numChannels), std::vector<float>(static_cast<size_t>(numBuffered), 0.0f));
+        bufferStart = -numBuffered;
+    }
+
+    bool isIdentity() const                 { return up == down; }
+
+    /** Output samples for numInput input samples once flushed. */
+    juce::int64 getOutputLength(juce::int64 numInput) const
+    {
+        return (numInput * up + down - 1) / down;
+    }
+
+    /** Convert one block; the result is valid until the next call. Returns the number of output samples. */
+    int process(const float* const* input, int numInput)
+    {
+        reserveSamples(buffers, numBuffered + numInput);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* destination = buffers[static_cast<size_t>(ch)].data() + numBuffered;
+
+            if (input != nullptr)
+                std::copy(input[ch], input[ch] + numInput, destination);
+            else
+                std::fill(destination, destination + numInput, 0.0f);
+        }
+
+        numBuffered += numInput;
+
+        if (input != nullptr)
+            inputReceived += numInput;
+
+        return render(flushed ? getOutputLength(inputReceived) : std::numeric_limits<juce::int64>::max());
+    }
+
+    /** Push the last input samples through the filter. */
+    int flush()
+    {
+        flushed = true;
+        return process(nullptr, halfTaps + 1);
+    }
+
+    const float* const* getOutput() const   { return output.getArrayOfReadPointers(); }
+
+    /**
+     * Grow every channel to hold at least numSamples. Only a larger block than
+     * any before reallocates, so steady streaming never touches the heap.
+     */
+    static void reserveSamples(std::vector<std::vector<float>>& channels, int numSamples)
+    {
+        for (auto& channel : channels)
+            if (channel.size() < static_cast<size_t>(numSamples))
+                channel.resize(std::max(static_cast<size_t>(numSamples), channel.size() * 2));
+    }
+
+    /** Drop the first numSamples of the numValid held in each channel, keeping the rest at the front. */
+    static void discardSamples(std::vector<std::vector<float>>& channels, int numSamples, int numValid)
+    {
+        for (auto& channel : channels)
+            std::copy(channel.begin() + numSamples, channel.begin() + numValid, channel.begin());
+    }
+
+private:
+    static constexpr juce::int64 maxPhases = 4096;
+
+    int render(juce::int64 outputLimit)
+    {
+        auto available = bufferStart + numBuffered;
+
+        // Upper bound for this call, so the output buffer is sized once
+        auto maxOutput = static_cast<int>(std::max<juce::int64>(0, ((available - inputPosition) * up) / down + 2));
+        output.setSize(numChannels, std::max(1, maxOutput), false, false, true);
+
+        int produced = 0;
+
+        while (inputPosition + halfTaps < available && outputPosition < outputLimit && produced < maxOutput)
+        {
+            auto phaseIndex = static_cast<size_t>((phase * numPhases) / up);
+            const auto* filter = filters.data() + phaseIndex * static_cast<size_t>(numTaps);
+            auto firstTap = inputPosition - (halfTaps - 1);
+            auto offset = static_cast<size_t>(firstTap - bufferStart);
+
+            // The zero padding at the end of the filter may reach past the buffered input
+            auto length = static_cast<int>(std::min<juce::int64>(numTaps, available - firstTap));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* samples = buffers[static_cast<size_t>(ch)].data() + offset;
+                output.getWritePointer(ch)[produced] = dotProduct(samples, filter, length);
+            }
+
+            ++produced;
+            ++outputPosition;
+
+            phase += down;
+            inputPosition += phase / up;
+            phase %= up;
+        }
+
+        // Keep only the history the next output still needs; it is a filter's length, so the move is short
+        auto firstNeeded = std::min(inputPosition - (halfTaps - 1), available);
+        auto consumed = static_cast<int>(std::max<juce::int64>(0, firstNeeded - bufferStart));
+
+        discardSamples(buffers, consumed, numBuffered);
+        numBuffered -= consumed;
+        bufferStart += consumed;
+        return produced;
+    }
+
+    // Four independent sums so the compiler can vectorise the loop without reassociating
+    static float dotProduct(const float* samples, const float* filter, int length)
+    {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        int i = 0;
+
+        for (; i + 4 <= length; i += 4)
+        {
+            sum0 += samples[i] * filter[i];
+            sum1 += samples[i + 1] * filter[i + 1];
+            sum2 += samples[i + 2] * filter[i + 2];
+            sum3 += samples[i + 3] * filter[i + 3];
+        }
+
+        for (; i < length; ++i)
+            sum0 += samples[i] * filter[i];
+
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    void buildFilters(double cutoff)
+    {
+        const double beta = 8.6;    // about 90 dB stopband
+        auto besselBeta = bessel0(beta);
+
+        filters.assign(static_cast<size_t>(numPhases) * static_cast<size_t>(numTaps), 0.0f);
+
+        for (int p = 0; p < numPhases; ++p)
+        {
+            auto fraction = static_cast<double>(p) / numPhases;
+            auto* filter = filters.data() + static_cast<size_t>(p) * static_cast<size_t>(numTaps);
+            double sum = 0.0;
+
+            for (int k = 0; k < 2 * halfTaps; ++k)
+            {
+                // Distance in input samples from the output position to tap k
+                auto t = static_cast<double>(k - (halfTaps - 1)) - fraction;
+                auto x = t / halfTaps;
+
+                if (std::abs(x) >= 1.0)
+                    continue;
+
+                auto arg = juce::MathConstants<double>::pi * cutoff * t;
+                auto sinc = std::abs(arg) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+                auto window = bessel0(beta * std::sqrt(1.0 - x * x)) / besselBeta;
+
+                filter[k] = static_cast<float>(cutoff * sinc * window);
+                sum += filter[k];
+            }
+
+            // Unity gain at DC for every phase
+            for (int k = 0; k < numTaps; ++k)
+                filter[k] = static_cast<float>(filter[k] / sum);
+        }
+    }
+
+    static double bessel0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+
+    int numChannels;
+    juce::int64 up = 1, down = 1;
+    int numPhases = 1;
+    int halfTaps = 1;
+    int numTaps = 4;
+    std::vector<float> filters;
+
+    std::vector<std::vector<float>> buffers;    // input from bufferStart on, per channel; numBuffered are valid
+    int numBuffered = 0;
+    juce::int64 bufferStart = 0;
+    juce::int64 inputPosition = 0;              // input sample at or before the next output
+    juce::int64 phase = 0;                      // next output's offset from inputPosition, in 1/up samples
+    juce::int64 inputReceived = 0;
+    juce::int64 outputPosition = 0;
+    bool flushed = false;
+
+    juce::AudioBuffer<float> output;
+};
+
+//==============================================================================
+/**
+ * An AudioFormatReader seen at another sample rate: blocks are pulled from
+ * the file as needed and converted on the way, so the input stays streamed.
+ */
+class ResamplingReader
+{
+public:
+    ResamplingReader(juce::AudioFormatReader& readerToUse, double outputRate, int blockSize)
+        : reader(readerToUse),
+          numChannels(static_cast<int>(readerToUse.numChannels)),
+          resampler(numChannels, readerToUse.sampleRate, outputRate),
+          inputBlock(numChannels, blockSize),
+          fifo(static_cast<size_t>(numChannels))
+    {
+    }
+
+    juce::int64 getLengthInSamples() const  { return resampler.getOutputLength(reader.lengthInSamples); }
+
+    /** Fill the first numSamples of destination; past the end of the file it is silence. */
+    void read(juce::AudioBuffer<float>& destination, int numSamples)
+    {
+        while (fifoSamples < numSamples && !finished)
+        {
+            auto chunk = static_cast<int>(juce::jmin(static_cast<juce::int64>(inputBlock.getNumSamples()),
+                                                     reader.lengthInSamples - readPosition));
+            int produced;
+
+            if (chunk > 0)
+            {
+                reader.read(&inputBlock, 0, chunk, readPosition, true, true);
+                readPosition += chunk;
+                produced = resampler.process(inputBlock.getArrayOfReadPointers(), chunk);
+            }
+            else
+            {
+                produced = resampler.flush();
+                finished = true;
+            }
+
+            Resampler::reserveSamples(fifo, fifoSamples + produced);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* converted = resampler.getOutput()[ch];
+                std::copy(converted, converted + produced, fifo[static_cast<size_t>(ch)].begin() + fifoSamples);
+            }
+
+            fifoSamples += produced;
+        }
+
+        auto available = juce::jmin(numSamples, fifoSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            destination.copyFrom(ch, 0, fifo[static_cast<size_t>(ch)].data(), available);
+
+            if (available < numSamples)
+                destination.clear(ch, available, numSamples - available);
+        }
+
+        Resampler::discardSamples(fifo, available, fifoSamples);
+        fifoSamples -= available;
+    }
+
+private:
+    juce::AudioFormatReader& reader;
+    int numChannels;
+    Resampler resampler;
+    juce::AudioBuffer<float> inputBlock;
+    std::vector<std::vector<float>> fifo;       // converted samples not yet read; fifoSamples are valid
+    int fifoSamples = 0;
+    juce::int64 readPosition = 0;
+    bool finished = false;
+
+    JUCE_DECLARE_NON_COPYABLE(ResamplingReader)
+};
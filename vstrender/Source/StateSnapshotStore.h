@@ -0,0 +1,208 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_cryptography/juce_cryptography.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+//==============================================================================
+/**
+ * Plugin states recorded after a preset loaded, so later runs restore them
+ * with one setStateInformation() call instead of probing loading strategies.
+ *
+ * Everything lives in one append-only file of records:
+ *
+ *   uint32 magic, uint32 key length, key, int32 strategy, int64 size, state
+ *
+ * The file is memory-mapped and scanned once to build the key -> record
+ * index; restores hand the plugin a pointer into the mapping. A truncated or
+ * damaged record ends the scan, and the next append truncates the file back
+ * to the last good record, so an interrupted append only loses itself.
+ *
+ * Appends take an inter-process lock on the file (process isolation workers
+ * share it) and first pick up whatever other processes appended since the
+ * last scan.
+ */
+class StateSnapshotStore
+{
+public:
+    explicit StateSnapshotStore(const juce::File& fileToUse)
+        : file(fileToUse),
+          fileLock("VSTPluginHostSnapshots_" + juce::String::toHexString(fileToUse.getFullPathName().hashCode64()))
+    {
+        file.getParentDirectory().createDirectory();
+        scanFrom(0);
+    }
+
+    static juce::File getDefaultFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("VSTPluginHost")
+                   .getChildFile("state_snapshots.bin");
+    }
+
+    const juce::File& getFile() const   { return file; }
+
+    /**
+     * Key for a (plugin, preset) pair. The state before the preset is part of
+     * it, so programs or sysex voices applied earlier in the job can't be
+     * mixed up with each other.
+     */
+    static juce::String createKey(juce::AudioPluginInstance& plugin, const juce::File& presetFile,
+                                  const juce::MemoryBlock& stateBefore)
+    {
+        juce::MemoryOutputStream keyData;
+        keyData.writeString(plugin.getPluginDescription().createIdentifierString());
+        keyData.writeString(plugin.getPluginDescription().version);
+        keyData.writeString(presetFile.getFullPathName());
+        keyData.writeInt64(presetFile.getSize());
+        keyData.writeInt64(presetFile.getLastModificationTime().toMilliseconds());
+        keyData << stateBefore;
+
+        return juce::SHA256(keyData.getData(), keyData.getDataSize()).toHexString();
+    }
+
+    /** Restore a recorded state. Returns the strategy that produced it, or 0 on a miss. */
+    int restore(const juce::String& key, juce::AudioPluginInstance& plugin)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto entry = index.find(key);
+        if (entry == index.end())
+            return 0;
+
+        // Records appended since the mapping was made need a new one
+        if (!mapping || entry->second.offset + entry->second.size > static_cast<juce::int64>(mapping->getSize()))
+            mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+        if (mapping->getData() == nullptr
+            || entry->second.offset + entry->second.size > static_cast<juce::int64>(mapping->getSize()))
+            return 0;
+
+        auto* state = static_cast<const char*>(mapping->getData()) + entry->second.offset;
+        plugin.setStateInformation(state, static_cast<int>(entry->second.size));
+        return entry->second.strategy;
+    }
+
+    /** Append the state a preset produced. */
+    bool add(const juce::String& key, int strategy, const juce::MemoryBlock& state)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (state.getSize() == 0 || index.find(key) != index.end())
+            return false;
+
+        juce::InterProcessLock::ScopedLockType fileScope(fileLock);
+        if (!fileScope.isLocked())
+        {
+            std::cerr << "Could not lock state snapshots: " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        // Another process may have recorded the same state meanwhile
+        scanFrom(endOfRecords);
+        if (index.find(key) != index.end())
+            return false;
+
+        // Anything after the last good record is an interrupted append; the mapping has to go before the file changes
+        mapping.reset();
+
+        if (file.existsAsFile() && file.getSize() > endOfRecords)
+        {
+            std::cout << "State snapshots have a damaged tail after " << endOfRecords << " bytes; it will be overwritten" << std::endl;
+
+            if (!file.truncate(endOfRecords))
+            {
+                std::cerr << "Could not truncate state snapshots: " << file.getFullPathName() << std::endl;
+                return false;
+            }
+        }
+
+        juce::MemoryOutputStream record;
+        auto keyUtf8 = key.toStdString();
+        record.writeInt(static_cast<int>(recordMagic));
+        record.writeInt(static_cast<int>(keyUtf8.size()));
+        record.write(keyUtf8.data(), keyUtf8.size());
+        record.writeInt(strategy);
+        record.writeInt64(static_cast<juce::int64>(state.getSize()));
+
+        auto stateOffset = endOfRecords + static_cast<juce::int64>(record.getDataSize());
+        record << state;
+
+        {
+            juce::FileOutputStream out(file);
+            if (!out.openedOk() || out.getPosition() != endOfRecords || !out.write(record.getData(), record.getDataSize()))
+            {
+                std::cerr << "Could not write state snapshot: " << file.getFullPathName() << std::endl;
+                return false;
+            }
+
+            out.flush();
+        }
+
+        index[key] = { stateOffset, static_cast<juce::int64>(state.getSize()), strategy };
+        endOfRecords = stateOffset + static_cast<juce::int64>(state.getSize());
+        return true;
+    }
+
+    int getNumSnapshots() const     { return static_cast<int>(index.size()); }
+
+private:
+    static constexpr juce::uint32 recordMagic = 0x31504e53;    // "SNP1"
+
+    struct Entry
+    {
+        juce::int64 offset = 0;
+        juce::int64 size = 0;
+        int strategy = 0;
+    };
+
+    // Index the records from start (the end of the last good record seen) on
+    void scanFrom(juce::int64 start)
+    {
+        if (!file.existsAsFile())
+            return;
+
+        mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (mapping->getData() == nullptr || static_cast<juce::int64>(mapping->getSize()) <= start)
+            return;
+
+        juce::MemoryInputStream in(mapping->getData(), mapping->getSize(), false);
+        in.setPosition(start);
+
+        while (!in.isExhausted())
+        {
+            if (static_cast<juce::uint32>(in.readInt()) != recordMagic)
+                break;
+
+            auto keyLength = in.readInt();
+            if (keyLength <= 0 || keyLength > 256 || in.getNumBytesRemaining() < keyLength)
+                break;
+
+            juce::MemoryBlock keyBytes;
+            in.readIntoMemoryBlock(keyBytes, keyLength);
+
+            Entry entry;
+            entry.strategy = in.readInt();
+            entry.size = in.readInt64();
+            entry.offset = in.getPosition();
+
+            if (entry.size <= 0 || entry.size > in.getNumBytesRemaining())
+                break;
+
+            index[keyBytes.toString()] = entry;
+            in.skipNextBytes(entry.size);
+            endOfRecords = in.getPosition();
+        }
+    }
+
+    juce::File file;
+    juce::InterProcessLock fileLock;
+    juce::int64 endOfRecords = 0;
+    std::mutex mutex;
+    std::map<juce::String, Entry> index;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+//==============================================================================
+/**
+ * Voices of a DX7 sysex file: a 32-voice bank (packed VMEM) or a single voice.
+ * Parsed once and immutable afterwards, so one bank can serve every job of a
+ * sweep on every render thread. Patches point into the sysex data rather
+ * than copying it; a bank from load() keeps the file mapped for its lifetime.
+ */
+class SysExBank
+{
+public:
+    struct Patch
+    {
+        juce::String name;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    /** Map a .syx file and parse it in place. Null if the file can't be mapped. */
+    static std::shared_ptr<SysExBank> load(const juce::File& sysexFile)
+    {
+        auto mapping = std::make_unique<juce::MemoryMappedFile>(sysexFile, juce::MemoryMappedFile::readOnly);
+        if (mapping->getData() == nullptr)
+            return nullptr;
+
+        auto bank = parse(static_cast<const uint8_t*>(mapping->getData()), mapping->getSize());
+        bank->mapping = std::move(mapping);
+        return bank;
+    }
+
+    /** Parse sysex data that outlives the bank. */
+    static std::shared_ptr<SysExBank> parse(const uint8_t* data, size_t dataSize)
+    {
+        auto bank = std::make_shared<SysExBank>();
+
+        if (dataSize >= 4104 && data[0] == 0xF0 && data[1] == 0x43 &&
+            data[3] == 0x09 && data[4] == 0x20 && data[5] == 0x00)
+        {
+            std::cout << "Detected DX7 32-voice bank format" << std::endl;
+
+            for (int voice = 0; voice < 32; ++voice)
+            {
+                size_t voiceOffset = 6 + (voice * 128);
+
+                if (voiceOffset + 128 > dataSize)
+                    break;
+
+                Patch patch;
+                patch.data = data + voiceOffset;
+                patch.size = 128;
+
+                for (int i = 118; i < 128; ++i)
+                {
+                    char c = static_cast<char>(patch.data[i]);
+                    patch.name += (c >= 32 && c <= 126) ? c : ' ';
+                }
+                patch.name = patch.name.trim();
+
+                if (patch.name.isEmpty())
+                    patch.name = "Patch " + juce::String(voice + 1);
+
+                bank->patches.push_back(std::move(patch));
+            }
+        }
+        else if (dataSize >= 140 && data[0] == 0xF0 && data[1] == 0x43 &&
+                 data[4] == 0x01 && data[5] == 0x1B)
+        {
+            std::cout << "Detected DX7 single voice format" << std::endl;
+
+            Patch patch;
+            patch.data = data + 6;
+            patch.size = 128;
+            patch.name = "Single Voice";
+            bank->patches.push_back(std::move(patch));
+        }
+        else
+        {
+            std::cout << "Unknown SysEx format (size: " << dataSize << " bytes)" << std::endl;
+        }
+
+        return bank;
+    }
+
+    const std::vector<Patch>& getPatches() const    { return patches; }
+    int size() const                                { return static_cast<int>(patches.size()); }
+
+private:
+    std::vector<Patch> patches;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+};
+
+//==============================================================================
+/**
+ * Parsed sysex banks keyed by file and modification time, shared by all
+ * render engines. A bank sweep maps and parses its .syx file once.
+ */
+class SysExBankCache
+{
+public:
+    /** The parsed bank, or nullptr when the file is missing or holds no voices. */
+    std::shared_ptr<const SysExBank> getBank(const juce::File& sysexFile)
+    {
+        if (!sysexFile.existsAsFile())
+        {
+            std::cerr << "SysEx file not found: " << sysexFile.getFullPathName() << std::endl;
+            return nullptr;
+        }
+
+        Key key { sysexFile.getFullPathName(), sysexFile.getLastModificationTime().toMilliseconds() };
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto existing = banks.find(key);
+        if (existing != banks.end())
+            return existing->second;
+
+        std::cout << "SysEx file: " << sysexFile.getFullPathName() << " (" << sysexFile.getSize() << " bytes)" << std::endl;
+
+        std::shared_ptr<const SysExBank> bank = SysExBank::load(sysexFile);
+        if (!bank)
+        {
+            std::cerr << "Could not load SysEx file data" << std::endl;
+            return nullptr;
+        }
+
+        if (bank->size() == 0)
+        {
+            std::cout << "No valid patches found in SysEx file" << std::endl;
+            return nullptr;
+        }
+
+        std::cout << "Found " << bank->size() << " patches in SysEx bank" << std::endl;
+        banks[key] = bank;
+        return bank;
+    }
+
+private:
+    struct Key
+    {
+        juce::String path;
+        juce::int64 modificationTime;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(path, modificationTime) < std::tie(other.path, other.modificationTime);
+        }
+    };
+
+    std::mutex mutex;
+    std::map<Key, std::shared_ptr<const SysExBank>> banks;
+};
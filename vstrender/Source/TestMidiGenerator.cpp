@@ -3,6 +3,10 @@
 #include <juce_core/juce_core.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "MidiUtilities.h"
+#include "MidiCorpus.h"
+#include "MidiProbeSet.h"
+#include <atomic>
+#include <thread>
 
 //==============================================================================
 /**
@@ -39,6 +43,20 @@ public:
         std::cout << "  transpose <input.mid> <output.mid> <semitones>" << std::endl;
         std::cout << "    Transpose MIDI file by semitones (-48 to +48)" << std::endl;
         std::cout << std::endl;
+        std::cout << "  batch <input_dir> <output_dir> [options]" << std::endl;
+        std::cout << "    Analyze, transpose and extract every MIDI file in a directory tree" << std::endl;
+        std::cout << "    on all cores, parsing each file once; writes one report" << std::endl;
+        std::cout << "    --transpose <min> <max>  Write a variant per semitone (0 skipped)" << std::endl;
+        std::cout << "    --channels <1,2,10>      Write a channel extraction per file" << std::endl;
+        std::cout << "    --threads <n>            Worker threads (default: one per CPU)" << std::endl;
+        std::cout << "    --report <file.json>     Report file (default: <output_dir>/corpus_report.json)" << std::endl;
+        std::cout << "    --no-recursive           Only the top level of input_dir" << std::endl;
+        std::cout << std::endl;
+        std::cout << "  generate <probes.json> <output_dir> [--threads <n>]" << std::endl;
+        std::cout << "    Write every sequence of a seeded probe set (chords, velocity layers," << std::endl;
+        std::cout << "    note ranges) as MIDI files on all cores, with a probes.csv manifest." << std::endl;
+        std::cout << "    Render hosts take the same \"probes\" object and skip the files." << std::endl;
+        std::cout << std::endl;
         std::cout << "  drums <output.mid> [duration] [tempo]" << std::endl;
         std::cout << "    Create a test drum pattern on channel 10" << std::endl;
         std::cout << std::endl;
@@ -50,10 +68,157 @@ public:
         std::cout << "  TestMidi analyze my_song.mid" << std::endl;
         std::cout << "  TestMidi extract full_song.mid bass_only.mid 2" << std::endl;
         std::cout << "  TestMidi transpose melody.mid melody_up.mid 12" << std::endl;
+        std::cout << "  TestMidi batch corpus augmented --transpose -12 12" << std::endl;
+        std::cout << "  TestMidi generate key_splits.json probes --threads 8" << std::endl;
         std::cout << "  TestMidi drums drum_test.mid 16" << std::endl;
         std::cout << "  TestMidi scale c_major.mid major 60 20" << std::endl;
     }
 
+    static bool runBatch(int argc, char* argv[])
+    {
+        MidiCorpus::Options options;
+        options.inputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[2]);
+        options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[3]);
+        juce::File reportFile = options.outputDirectory.getChildFile("corpus_report.json");
+
+        for (int i = 4; i < argc; ++i)
+        {
+            juce::String arg(argv[i]);
+
+            if (arg == "--transpose" && i + 2 < argc)
+            {
+                options.transpose = true;
+                options.transposeMin = juce::String(argv[++i]).getIntValue();
+                options.transposeMax = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--channels" && i + 1 < argc)
+            {
+                for (const auto& token : juce::StringArray::fromTokens(argv[++i], ",", ""))
+                {
+                    int channel = token.getIntValue();
+                    if (channel >= 1 && channel <= 16)
+                        options.channels.push_back(channel);
+                    else
+                        std::cerr << "Invalid MIDI channel: " << token << " (must be 1-16)" << std::endl;
+                }
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+                options.numThreads = juce::String(argv[++i]).getIntValue();
+            else if (arg == "--report" && i + 1 < argc)
+                reportFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            else if (arg == "--no-recursive")
+                options.recursive = false;
+            else
+                std::cerr << "Ignoring unknown option: " << arg << std::endl;
+        }
+
+        if (!options.inputDirectory.isDirectory())
+        {
+            std::cerr << "Input directory not found: " << options.inputDirectory.getFullPathName() << std::endl;
+            return false;
+        }
+
+        if (options.transpose && (options.transposeMin < -48 || options.transposeMax > 48
+                                  || options.transposeMin > options.transposeMax))
+        {
+            std::cerr << "Transpose range must be within -48 to +48 with min <= max" << std::endl;
+            return false;
+        }
+
+        auto report = MidiCorpus::run(options);
+        report.print();
+
+        if (!report.writeTo(reportFile))
+            return false;
+
+        std::cout << "Report: " << reportFile.getFullPathName() << std::endl;
+        return !report.files.empty() && !report.hasFailures();
+    }
+
+    static bool runGenerate(int argc, char* argv[])
+    {
+        auto specFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[2]);
+        auto outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[3]);
+        int numThreads = 0;
+
+        for (int i = 4; i < argc; ++i)
+        {
+            juce::String arg(argv[i]);
+
+            if (arg == "--threads" && i + 1 < argc)
+                numThreads = juce::String(argv[++i]).getIntValue();
+            else
+                std::cerr << "Ignoring unknown option: " << arg << std::endl;
+        }
+
+        // A render configuration works as well as a bare probe set
+        auto json = juce::JSON::parse(specFile);
+        if (json.hasProperty("probes"))
+            json = json["probes"];
+
+        MidiProbeSet probes;
+        juce::String error;
+        if (!MidiProbeSet::fromVar(json, probes, error))
+        {
+            std::cerr << "Invalid probe set in " << specFile.getFullPathName() << ": " << error << std::endl;
+            return false;
+        }
+
+        auto numProbes = probes.size();
+        auto digits = juce::jmax(2, juce::String(static_cast<juce::int64>(numProbes) - 1).length());
+
+        juce::StringArray outputFiles;
+        outputFiles.ensureStorageAllocated(static_cast<int>(numProbes));
+        for (size_t probeIndex = 0; probeIndex < numProbes; ++probeIndex)
+        {
+            auto probe = probes.get(probeIndex);
+            outputFiles.add(outputDirectory.getChildFile(juce::String(static_cast<juce::int64>(probeIndex)).paddedLeft('0', digits)
+                                                         + "_" + probe.getName() + ".mid").getFullPathName());
+        }
+
+        if (!outputDirectory.createDirectory())
+        {
+            std::cerr << "Could not create output directory: " << outputDirectory.getFullPathName() << std::endl;
+            return false;
+        }
+
+        int requested = (numThreads > 0) ? numThreads : juce::SystemStats::getNumCpus();
+        auto workerCount = static_cast<size_t>(juce::jlimit(1, juce::jmax(1, static_cast<int>(numProbes)), requested));
+        auto start = juce::Time::getMillisecondCounterHiRes();
+
+        std::atomic<size_t> nextProbe { 0 };
+        std::atomic<int> failures { 0 };
+        std::vector<std::thread> workers;
+
+        for (size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+        {
+            workers.emplace_back([&probes, &outputFiles, &nextProbe, &failures, numProbes]()
+            {
+                for (auto probeIndex = nextProbe++; probeIndex < numProbes; probeIndex = nextProbe++)
+                {
+                    juce::File outputFile(outputFiles[static_cast<int>(probeIndex)]);
+                    if (!MidiUtilities::writeMidiFile(probes.get(probeIndex).toMidiFile(), outputFile))
+                        failures++;
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        auto manifest = outputDirectory.getChildFile("probes.csv");
+        bool manifestWritten = probes.writeManifest(manifest, outputFiles);
+
+        std::cout << "Generated " << (static_cast<int>(numProbes) - failures.load()) << " of " << numProbes
+                  << " probe sequences in " << seconds << " seconds on " << workerCount << " thread(s)" << std::endl;
+        std::cout << "  Output: " << outputDirectory.getFullPathName() << std::endl;
+        if (manifestWritten)
+            std::cout << "  Manifest: " << manifest.getFullPathName() << std::endl;
+
+        return manifestWritten && failures == 0;
+    }
+
     static bool createDrumPattern(const juce::String& outputPath,
                                  double durationSeconds = 16.0,
                                  double tempo = 120.0)
@@ -330,6 +495,14 @@ int main(int argc, char* argv[])
 
         success = MidiUtilities::transposeMidi(inputPath, outputPath, semitones);
     }
+    else if (command == "batch" && argc >= 4)
+    {
+        success = TestMidiGenerator::runBatch(argc, argv);
+    }
+    else if (command == "generate" && argc >= 4)
+    {
+        success = TestMidiGenerator::runGenerate(argc, argv);
+    }
     else if (command == "drums" && argc >= 3)
     {
         juce::String outputPath = argv[2];
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include <memory>
+#include <string>
+
+//==============================================================================
+/**
+ * One sandboxed render worker: a child VSTPluginHost started with --serve on
+ * its own localhost port. Plugins live only in the child, so a plugin that
+ * crashes or hangs takes down the worker and not the coordinator; the
+ * coordinator notices the closed socket or the timeout and restarts it.
+ *
+ * Requests and responses use the render server protocol, one JSON document
+ * per line.
+ */
+class WorkerProcess
+{
+public:
+    enum class Result
+    {
+        ok,         // the job rendered
+        failed,     // the worker answered, but the job itself failed
+        crashed     // the worker died, hung or stopped answering
+    };
+
+    WorkerProcess(const juce::File& executableToUse, int portToUse)
+        : executable(executableToUse), port(portToUse)
+    {
+    }
+
+    ~WorkerProcess()
+    {
+        stop();
+    }
+
+    bool start(double timeoutSeconds = 30.0)
+    {
+        kill();
+
+        juce::StringArray arguments { executable.getFullPathName(), "--serve",
+                                      "--port", juce::String(port), "--pool-size", "1" };
+
+        process = std::make_unique<juce::ChildProcess>();
+
+        // No stream flags: the worker's console output is discarded instead of
+        // filling a pipe nobody reads
+        if (!process->start(arguments, 0))
+        {
+            std::cerr << "[WORKER " << port << "] Could not start " << executable.getFullPathName() << std::endl;
+            process.reset();
+            return false;
+        }
+
+        auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutSeconds * 1000.0;
+
+        while (juce::Time::getMillisecondCounterHiRes() < deadline)
+        {
+            socket = std::make_unique<juce::StreamingSocket>();
+
+            if (socket->connect("127.0.0.1", port, 500))
+            {
+                starts++;
+                return true;
+            }
+
+            if (!process->isRunning())
+                break;
+
+            juce::Thread::sleep(100);
+        }
+
+        std::cerr << "[WORKER " << port << "] Worker did not accept connections" << std::endl;
+        kill();
+        return false;
+    }
+
+    bool isRunning() const
+    {
+        return process && process->isRunning() && socket && socket->isConnected();
+    }
+
+    /** Send one request and wait for its response line. Anything but an answer counts as a crash. */
+    Result render(const juce::var& request, double timeoutSeconds, juce::var& response)
+    {
+        response = juce::var();
+
+        if (!isRunning() || !sendLine(juce::JSON::toString(request, true)))
+        {
+            kill();
+            return Result::crashed;
+        }
+
+        juce::String line;
+        if (!readLine(line, timeoutSeconds))
+        {
+            kill();
+            return Result::crashed;
+        }
+
+        response = juce::JSON::parse(line);
+        if (!response.isObject())
+        {
+            kill();
+            return Result::crashed;
+        }
+
+        return response["status"].toString() == "ok" ? Result::ok : Result::failed;
+    }
+
+    /** Ask the worker to exit, then make sure it has. */
+    void stop()
+    {
+        if (isRunning())
+        {
+            sendLine("{\"command\": \"shutdown\"}");
+            process->waitForProcessToFinish(2000);
+        }
+
+        kill();
+    }
+
+    int getPort() const         { return port; }
+    int getStartCount() const   { return starts; }
+
+private:
+    juce::File executable;
+    int port;
+    int starts = 0;
+
+    std::unique_ptr<juce::ChildProcess> process;
+    std::unique_ptr<juce::StreamingSocket> socket;
+    std::string pending;
+
+    void kill()
+    {
+        if (socket)
+            socket->close();
+
+        if (process && process->isRunning())
+            process->kill();
+
+        socket.reset();
+        process.reset();
+        pending.clear();
+    }
+
+    bool sendLine(const juce::String& text)
+    {
+        auto data = (text + "\n").toStdString();
+        size_t written = 0;
+
+        while (written < data.size())
+        {
+            auto result = socket->write(data.data() + written, static_cast<int>(data.size() - written));
+            if (result <= 0)
+                return false;
+
+            written += static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+    bool readLine(juce::String& line, double timeoutSeconds)
+    {
+        auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutSeconds * 1000.0;
+        char buffer[8192];
+
+        for (;;)
+        {
+            auto newline = pending.find('\n');
+            if (newline != std::string::npos)
+            {
+                line = juce::String::fromUTF8(pending.data(), static_cast<int>(newline));
+                pending.erase(0, newline + 1);
+                return true;
+            }
+
+            if (juce::Time::getMillisecondCounterHiRes() > deadline)
+            {
+                std::cerr << "[WORKER " << port << "] No response after " << timeoutSeconds << " seconds" << std::endl;
+                return false;
+            }
+
+            auto ready = socket->waitUntilReady(true, 200);
+            if (ready < 0)
+                return false;
+
+            if (ready == 0)
+            {
+                if (!process->isRunning())
+                    return false;
+
+                continue;
+            }
+
+            auto bytesRead = socket->read(buffer, static_cast<int>(sizeof(buffer)), false);
+            if (bytesRead <= 0)
+                return false;
+
+            pending.append(buffer, static_cast<size_t>(bytesRead));
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(WorkerProcess)
+};